@@ -0,0 +1,185 @@
+#include "Clock.h"
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+
+#ifdef WXE_CLOCK_TSC
+    #include <cpuid.h>
+#endif
+
+namespace WXE
+{
+    int32 Clock::clockSource = STEADY;
+    std::atomic<uint32> Clock::sequence = {};
+    std::atomic<int64> Clock::baseNanos = {};
+    std::atomic<uint64> Clock::baseTicks = {};
+    std::atomic<double> Clock::nanosPerTick = {};
+    std::atomic<uint64> Clock::syncTicks = { UINT64_MAX };
+    int64 Clock::syncNanos = {};
+    uint64 Clock::syncedTicks = {};
+    thread_local Clock::time_point Clock::frameNow = {};
+
+    // re-sync period, and how fast the clock may be steered onto steady_clock
+    constexpr double SYNC_NANOS = 1e9;
+    constexpr double MAX_SLEW = 0.001;
+
+    // ---------------------------------------------------
+    // steady_clock is the one reference, for the rate and
+    // the time base alike. Each tick read is bracketed by
+    // two clock reads and paired with their midpoint; the
+    // tightest of a few tries bounds the error.
+    // ---------------------------------------------------
+
+    int64 Clock::Reference(uint64& ticks) noexcept
+    {
+        int64 best = INT64_MAX;
+        int64 nanos = {};
+
+        for (uint32 i = 0; i < 4; ++i)
+        {
+            int64 before = SteadyNanos();
+            uint64 read = Ticks();
+            int64 after = SteadyNanos();
+
+            if (after - before < best)
+            {
+                best = after - before;
+                nanos = before + best / 2;
+                ticks = read;
+            }
+        }
+
+        return nanos;
+    }
+
+    void Clock::Anchor(const int64 nanos, const uint64 ticks, const double rate) noexcept
+    {
+        uint32 seq = sequence.load(memory_order_relaxed);
+        sequence.store(seq + 1, memory_order_relaxed);
+        std::atomic_thread_fence(memory_order_release);
+
+        baseNanos.store(nanos, memory_order_relaxed);
+        baseTicks.store(ticks, memory_order_relaxed);
+        nanosPerTick.store(rate, memory_order_relaxed);
+
+        sequence.store(seq + 2, memory_order_release);
+    }
+
+    bool Clock::Calibrate() noexcept
+    {
+    #ifdef WXE_CLOCK_TSC
+        // --------------------------------------------
+        // Invariant TSC: constant rate across P/C states
+        // --------------------------------------------
+
+        uint32 eax {}, ebx {}, ecx {}, edx {};
+
+        if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007)
+            return false;
+
+        __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+
+        if (!(edx & (1 << 8)))
+            return false;
+
+        // --------------------------------------------
+        // First estimate of the rate over 20 ms, refined
+        // by every re-sync after it
+        // --------------------------------------------
+
+        uint64 ticksStart {}, ticksEnd {};
+        int64 start = Reference(ticksStart);
+        int64 end;
+
+        do
+        {
+            end = Reference(ticksEnd);
+        } while (end - start < 20'000'000);
+
+        if (ticksEnd <= ticksStart)
+            return false;
+
+        nanosPerTick.store(double(end - start) / double(ticksEnd - ticksStart), memory_order_relaxed);
+        return true;
+    #else
+        return false;
+    #endif
+    }
+
+    // ---------------------------------------------------
+    // Moves the anchor to where the clock reads now, so it
+    // never jumps back, and sets the rate measured since
+    // the last sync, plus the slew that closes the gap to
+    // steady_clock by the next one. A clock far behind
+    // (the TSC stopped in a suspend) steps forward instead.
+    // ---------------------------------------------------
+
+    void Clock::Sync() noexcept
+    {
+        // one thread re-syncs, the others keep the current anchor
+        uint64 due = syncTicks.load(memory_order_relaxed);
+
+        if (!syncTicks.compare_exchange_strong(due, UINT64_MAX, memory_order_acquire))
+            return;
+
+        uint64 ticks {};
+        int64 reference = Reference(ticks);
+
+        double rate = nanosPerTick.load(memory_order_relaxed);
+        int64 current = baseNanos.load(memory_order_relaxed)
+            + static_cast<int64>(static_cast<int64>(ticks - baseTicks.load(memory_order_relaxed)) * rate);
+
+        if (ticks > syncedTicks && reference > syncNanos)
+            rate = double(reference - syncNanos) / double(ticks - syncedTicks);
+
+        double offset = double(reference - current);
+        double slew = offset / SYNC_NANOS;
+
+        if (slew > MAX_SLEW)
+        {
+            current = reference;
+            slew = 0.0;
+        }
+        else if (slew < -MAX_SLEW)
+        {
+            slew = -MAX_SLEW;
+        }
+
+        Anchor(current, ticks, rate * (1.0 + slew));
+
+        syncNanos = reference;
+        syncedTicks = ticks;
+        syncTicks.store(ticks + static_cast<uint64>(SYNC_NANOS / rate), memory_order_release);
+    }
+
+    bool Clock::Source(const int32 source) noexcept
+    {
+        if (source == TSC)
+        {
+            if (nanosPerTick.load(memory_order_relaxed) == 0.0 && !Calibrate())
+                return false;
+
+            // start on steady_clock's time, so switching sources never jumps
+            uint64 ticks {};
+            int64 reference = Reference(ticks);
+            double rate = nanosPerTick.load(memory_order_relaxed);
+
+            Anchor(reference, ticks, rate);
+
+            syncNanos = reference;
+            syncedTicks = ticks;
+            syncTicks.store(ticks + static_cast<uint64>(SYNC_NANOS / rate), memory_order_release);
+        }
+
+        clockSource = source;
+        return true;
+    }
+
+    double Clock::Frequency() noexcept
+    {
+        return (clockSource == TSC) ? 1e9 / nanosPerTick.load(memory_order_relaxed) : 1e9;
+    }
+
+    // prefer the TSC from program start when the CPU has an invariant one
+    static const bool tscSelected = Clock::Source(TSC);
+}
@@ -0,0 +1,134 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include "Types.h"
+#include <atomic>
+#include <chrono>
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__i386__))
+	#include <x86intrin.h>
+	#define WXE_CLOCK_TSC
+#endif
+
+namespace WXE
+{
+	enum ClockSources { STEADY, TSC };
+
+	// ---------------------------------------------------
+	// Monotonic clock behind Timer. Time is kept in
+	// nanoseconds on the steady_clock time base; on x86
+	// Linux with an invariant TSC, now() reads the cycle
+	// counter and scales it instead of calling into the
+	// kernel. Frame() is a copy of now() taken once per
+	// frame by the engine, free for game code to read. It
+	// is kept per thread, since engines may tick side by
+	// side: jobs that need it should capture it.
+	//
+	// The TSC is scaled from an anchor: a time, the tick
+	// count it was taken at and the rate. Update() moves
+	// the anchor about once a second, measuring the rate
+	// against steady_clock again and steering the clock
+	// back onto it, so the drift never piles up. The
+	// anchor is published under a sequence count, read
+	// by now() on any thread without a lock.
+	// ---------------------------------------------------
+
+	class Clock final
+	{
+	public:
+		using rep = int64;
+		using period = std::nano;
+		using duration = std::chrono::duration<rep, period>;
+		using time_point = std::chrono::time_point<Clock>;
+		static constexpr bool is_steady = true;
+
+	private:
+		static int32 clockSource;
+		static std::atomic<uint32> sequence;
+		static std::atomic<int64> baseNanos;
+		static std::atomic<uint64> baseTicks;
+		static std::atomic<double> nanosPerTick;
+		static std::atomic<uint64> syncTicks;
+		static int64 syncNanos;
+		static uint64 syncedTicks;
+		static thread_local time_point frameNow;
+
+		static uint64 Ticks() noexcept;
+		static int64 SteadyNanos() noexcept;
+		static int64 Reference(uint64& ticks) noexcept;
+		static bool Calibrate() noexcept;
+		static void Anchor(const int64 nanos, const uint64 ticks, const double rate) noexcept;
+		static void Sync() noexcept;
+
+	public:
+		static time_point now() noexcept;
+
+		static int32 Source() noexcept;
+		static bool Source(const int32 source) noexcept;
+		static double Frequency() noexcept;
+
+		static void Update() noexcept;
+		static void Update(const time_point frame) noexcept;
+		static time_point Frame() noexcept;
+	};
+
+	inline uint64 Clock::Ticks() noexcept
+	{
+	#ifdef WXE_CLOCK_TSC
+		return __rdtsc();
+	#else
+		return 0;
+	#endif
+	}
+
+	inline int64 Clock::SteadyNanos() noexcept
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	inline Clock::time_point Clock::now() noexcept
+	{
+		if (clockSource == TSC)
+		{
+			uint32 seq;
+			int64 nanos;
+			uint64 ticks;
+			double rate;
+
+			// retry while the anchor is being moved
+			do
+			{
+				seq = sequence.load(std::memory_order_acquire);
+				nanos = baseNanos.load(std::memory_order_relaxed);
+				ticks = baseTicks.load(std::memory_order_relaxed);
+				rate = nanosPerTick.load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+			} while ((seq & 1) || seq != sequence.load(std::memory_order_relaxed));
+
+			return time_point(duration(nanos + static_cast<int64>(static_cast<int64>(Ticks() - ticks) * rate)));
+		}
+
+		return time_point(duration(SteadyNanos()));
+	}
+
+	inline int32 Clock::Source() noexcept
+	{ return clockSource; }
+
+	// re-syncs the TSC when it is due, then takes the frame time
+	inline void Clock::Update() noexcept
+	{
+		if (clockSource == TSC && Ticks() >= syncTicks.load(std::memory_order_relaxed))
+			Sync();
+
+		frameNow = now();
+	}
+
+	inline void Clock::Update(const time_point frame) noexcept
+	{ frameNow = frame; }
+
+	inline Clock::time_point Clock::Frame() noexcept
+	{ return frameNow; }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef DOUBLEBUFFER_H
+#define DOUBLEBUFFER_H
+
+#include "Types.h"
+
+namespace WXE
+{
+	// ---------------------------------------------------
+	// Render state handed from Update to Draw: Update fills
+	// Write() while Draw reads the previous frame through
+	// Read(). Swap() only when neither side is running,
+	// which is what Game::Sync is for.
+	// ---------------------------------------------------
+
+	template<typename T>
+	class DoubleBuffer
+	{
+	private:
+		T buffers[2];
+		uint32 current;
+
+	public:
+		DoubleBuffer() noexcept;
+
+		T& Write() noexcept;
+		const T& Read() const noexcept;
+		void Swap() noexcept;
+	};
+
+	template<typename T>
+	inline DoubleBuffer<T>::DoubleBuffer() noexcept : buffers{}, current{}
+	{}
+
+	template<typename T>
+	inline T& DoubleBuffer<T>::Write() noexcept
+	{ return buffers[current]; }
+
+	template<typename T>
+	inline const T& DoubleBuffer<T>::Read() const noexcept
+	{ return buffers[current ^ 1]; }
+
+	template<typename T>
+	inline void DoubleBuffer<T>::Swap() noexcept
+	{ current ^= 1; }
+}
+
+#endif
\ No newline at end of file
@@ -1,47 +1,125 @@
 #include "Engine.h"
+#include "Error.h"
 #include "KeyCodes.h"
+#include "Profiler.h"
 #include <format>
+#include <thread>
 using std::format;
+using std::this_thread::sleep_for;
+using std::chrono::milliseconds;
 
 #ifdef _WIN32
     #include <mmsystem.h>
     #pragma comment(lib, "winmm.lib")
+#else
+    #include <cstdio>
 #endif
 
 namespace WXE
 {
-    Graphics* EngineDesc::graphics = nullptr;
-    Window* EngineDesc::window = nullptr;
-    Input* EngineDesc::input = nullptr;
-    Game* EngineDesc::game = nullptr;
-    double EngineDesc::frameTime = {};
-    bool EngineDesc::paused = false;
-    Timer EngineDesc::timer;
-
-    Engine::Engine() noexcept
+    EngineDesc::EngineDesc() noexcept :
+        paused{ false },
+        running{ false },
+        engineMode{ GRAPHICAL },
+        tickRate{},
+        ticksPerSecond{},
+        fixedStep{},
+        accumulator{},
+        maxSteps{ 5 },
+        pipelined{ false },
+        sharedJobs{ false },
+        graphics{ nullptr },
+        window{ nullptr },
+        input{ nullptr },
+        jobs{ nullptr },
+        scheduler{ nullptr },
+        game{ nullptr },
+        frameTime{},
+        interpolation{}
     {
-        window = new Window();
-        graphics = new Graphics();
+    }
+
+    Engine::Engine(const int32 mode, JobSystem* shared) noexcept :
+        titleTime{},
+        titleFrames{}
+    {
+        engineMode = mode;
+
+        // engines of a group run their jobs on the group workers
+        jobs = shared;
+        sharedJobs = (shared != nullptr);
+
+        // headless runs never touch the display or the GPU
+        if (mode == GRAPHICAL)
+        {
+            window = new Window();
+            graphics = new Graphics();
+        }
     }
 
     Engine::~Engine() noexcept
     {
+        // the last stats line goes out while the job system is still there
+        stats.Flush();
+
         delete game;
+        delete scheduler;
         delete graphics;
         delete input;
+
+        if (!sharedJobs)
+            delete jobs;
+
         delete window;
     }
 
-    int32 Engine::Start(Game * game)
+    void Engine::Attach(Game * game)
     {
         this->game = game;
 
+        if (jobs == nullptr)
+            jobs = new JobSystem();
+
+        scheduler = new TaskScheduler(jobs);
+
+        game->engine = this;
+        game->graphics = graphics;
+        game->window = window;
+        game->input = input;
+        game->jobs = jobs;
+        game->scheduler = scheduler;
+        game->timers = &timers;
+
+        stats.Jobs(jobs);
+    }
+
+    int32 Engine::Start(Game * game)
+    {
+        if (engineMode == HEADLESS)
+        {
+            // replays feed the recorded input back without a window
+            if (recorder.Mode() == REPLAYING)
+                input = new Input();
+
+            Attach(game);
+            return Headless();
+        }
+
         window->Create();
 
+    #ifdef _WIN32
         input = new Input();
+    #else
+        input = new Input(window);
+    #endif
 
-        graphics->Initialize(window);
+        Attach(game);
 
+    #ifdef _WIN32
+        graphics->Initialize(window, jobs);
+
+        // the window procedure finds its engine through the window
+        SetWindowLongPtr(window->Id(), GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
         SetWindowLongPtr(window->Id(), GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(EngineProc));
 
         timeBeginPeriod(1);
@@ -51,39 +129,210 @@ namespace WXE
         timeEndPeriod(1);
 
         return exitCode;
+    #else
+        graphics->Initialize(window, jobs);
+
+        return Loop();
+    #endif
     }
 
     double Engine::FrameTime()
     {
-    #ifdef _DEBUG
-        static double totalTime {};
-        static uint32 frameCount {};
-    #endif
-
         frameTime = timer.Reset();
+        Clock::Update();
+
+        stats.Add(frameTime);
+
+        // the limiter's wait is not work: leave it out of the frame cost
+        if (scaler.Update(frameTime - limiter.Idle()))
+            graphics->Scale(scaler.Scale());
 
     #ifdef _DEBUG
-        totalTime += frameTime;
+        titleTime += frameTime;
 
-        frameCount++;
+        titleFrames++;
 
-        if (totalTime >= 1.0)
+        if (titleTime >= 1.0)
         {
+        #ifdef _WIN32
             SetWindowText(window->Id(), 
-                format("{}    FPS: {}    Frame Time: {:.3f} (ms)",
-                    window->Title().c_str(), frameCount, frameTime * 1000).c_str());
+                format("{}    FPS: {}    Frame Time: {:.3f} (ms)    Pacing Error: {:.3f} (ms)    Scale: {:.2f}",
+                    window->Title().c_str(), titleFrames, frameTime * 1000, limiter.Error() * 1000, graphics->Scale()).c_str());
+        #endif
 
-            frameCount = 0;
-            totalTime -= 1.0;
+            titleFrames = 0;
+            titleTime -= 1.0;
         }
     #endif
 
         return frameTime;
     }
 
+    void Engine::Simulate() noexcept
+    {
+        if (fixedStep <= 0.0)
+        {
+            PROFILE_ZONE("Update");
+            game->Update();
+            return;
+        }
+
+        // -----------------------------------------------
+        // Fixed step: run as many ticks as the elapsed time
+        // asks for, but never more than maxSteps per frame
+        // -----------------------------------------------
+
+        uint32 steps {};
+        while (accumulator >= fixedStep && steps < maxSteps)
+        {
+            PROFILE_ZONE("Update");
+            game->Update();
+            accumulator -= fixedStep;
+            steps++;
+        }
+
+        // too far behind: drop the backlog instead of spiraling
+        if (accumulator >= fixedStep)
+            accumulator -= fixedStep * static_cast<uint32>(accumulator / fixedStep);
+    }
+
+    // ---------------------------------------------------
+    // A task that threw has already been destroyed by the
+    // scheduler; its exception is reported here, the way
+    // main reports an Error, and the engine stops.
+    // ---------------------------------------------------
+
+    void Engine::Failures() noexcept
+    {
+        while (std::exception_ptr failure = scheduler->Failure())
+        {
+            string text;
+
+            try { std::rethrow_exception(failure); }
+            catch (Error& e) { text = e.ToString(); }
+            catch (std::exception& e) { text = e.what(); }
+            catch (...) { text = "unknown exception"; }
+
+            text = format("---> Task failed: {}\n", text);
+
+        #ifdef _WIN32
+            OutputDebugString(text.c_str());
+        #else
+            fputs(text.c_str(), stderr);
+        #endif
+
+            running = false;
+        }
+    }
+
+    void Engine::Frame() noexcept
+    {
+        PROFILE_ZONE("Frame");
+
+        frameTime = FrameTime();
+
+        if (recorder.Mode() == RECORDING)
+            recorder.Write(input, frameTime);
+
+        timers.Advance(frameTime);
+        scheduler->Update(frameTime);
+        Failures();
+
+        if (fixedStep > 0.0)
+        {
+            accumulator += frameTime;
+            frameTime = fixedStep;
+        }
+
+        game->frameTime = frameTime;
+
+        if (pipelined)
+        {
+            // -----------------------------------------------
+            // Frame N+1 simulates on a worker while frame N is
+            // recorded and submitted here, Draw and Display
+            // both; Sync hands the new state to the next Draw
+            // -----------------------------------------------
+
+            // the worker gets this frame's clock, which is kept per thread
+            JobCounter simulated {};
+            jobs->Schedule([this, now = Clock::Frame()] { Clock::Update(now); Simulate(); }, &simulated);
+
+            {
+                PROFILE_ZONE("Draw");
+                game->Draw();
+            }
+
+            {
+                PROFILE_ZONE("Display");
+                game->Display();
+            }
+
+            jobs->Wait(simulated);
+            game->Sync();
+        }
+        else
+        {
+            Simulate();
+
+            PROFILE_ZONE("Draw");
+            game->Draw();
+        }
+
+        if (fixedStep > 0.0)
+        {
+            interpolation = accumulator / fixedStep;
+            game->interpolation = interpolation;
+        }
+    }
+
+    bool Engine::Tick(const double tickTime) noexcept
+    {
+        // replays run back to back with recorded input and frame time
+        if (recorder.Mode() == REPLAYING)
+        {
+            if (!recorder.Read(input, frameTime))
+                return false;
+        }
+        else
+        {
+            frameTime = tickTime;
+
+            // headless input only comes from what was pushed to it
+            if (input)
+                input->Poll();
+        }
+
+        stats.Add(frameTime);
+        timers.Advance(frameTime);
+        scheduler->Update(frameTime);
+        Failures();
+
+        // replayed ticks step the game as Frame() does, so a fixed
+        // step replays the same updates the recording ran
+        if (fixedStep > 0.0)
+        {
+            accumulator += frameTime;
+            frameTime = fixedStep;
+        }
+
+        game->frameTime = frameTime;
+        Simulate();
+
+        if (fixedStep > 0.0)
+        {
+            interpolation = accumulator / fixedStep;
+            game->interpolation = interpolation;
+        }
+
+        return running;
+    }
+
     int32 Engine::Loop() noexcept
     {
+    #ifdef _WIN32
         timer.Start();
+        running = true;
         MSG msg {};
 
         game->Init();
@@ -97,6 +346,8 @@ namespace WXE
             }
             else
             {
+                input->Poll();
+
                 // -----------------------------------------------
                 // Pause/Resume Game
                 // -----------------------------------------------
@@ -106,28 +357,161 @@ namespace WXE
 
                 if (!paused)
                 {
-                    frameTime = FrameTime();
-                    game->Update();
-                    game->Draw();
+                    Frame();
+                    limiter.Wait();
+
+                    // in the background, wake for input or ten times a second
+                    if (GetForegroundWindow() != window->Id())
+                        MsgWaitForMultipleObjects(0, nullptr, FALSE, 100, QS_ALLINPUT);
                 }
                 else
                 {
                     game->OnPause();
+
+                    // nothing runs until a message arrives
+                    WaitMessage();
                 }
             }
 
-        } while (msg.message != WM_QUIT);
+        } while (msg.message != WM_QUIT && running);
 
         game->Finalize();
 
         return static_cast<int32>(msg.wParam);
+    #else
+        timer.Start();
+        running = true;
+
+        game->Init();
+
+        while (running)
+        {
+            // paused, the loop blocks on the X connection until an event
+            // arrives; in the background it also wakes ten times a second
+            int32 timeout = paused ? -1 : (window->Focused() ? 0 : 100);
+
+            if (!window->Pump(timeout, EngineProc, this))
+                break;
+
+            input->Poll();
+
+            if (input->KeyPress(VK_PAUSE))
+            { (paused) ? Resume() : Pause(); }
+
+            if (!paused)
+            {
+                Frame();
+
+                // a pipelined frame has displayed already
+                if (!pipelined)
+                {
+                    PROFILE_ZONE("Display");
+                    game->Display();
+                }
+
+                // the one read of the X connection a running frame makes
+                window->Flush();
+
+                limiter.Wait();
+            }
+            else
+            {
+                game->OnPause();
+            }
+        }
+
+        game->Finalize();
+
+        return 0;
+    #endif
     }
 
+    int32 Engine::Headless() noexcept
+    {
+        double reportTime {};
+        uint32 tickCount {};
+
+        timer.Start();
+        running = true;
+
+        if (tickRate > 0.0)
+            limiter.Target(tickRate);
+
+        game->Init();
+
+        while (running)
+        {
+            // nothing else can wake a headless engine, so check back every 10 ms
+            if (paused)
+            {
+                game->OnPause();
+                sleep_for(milliseconds(10));
+                continue;
+            }
+
+            // replays run as fast as they can be read back
+            if (recorder.Mode() != REPLAYING)
+                limiter.Wait();
+
+            double tickTime = timer.Reset();
+            Clock::Update();
+
+            if (!Tick(tickTime))
+                break;
+
+            // -----------------------------------------------
+            // Report ticks per second once every second
+            // -----------------------------------------------
+
+            reportTime += tickTime;
+            tickCount++;
+
+            if (reportTime >= 1.0)
+            {
+                ticksPerSecond = tickCount / reportTime;
+
+                string text = format("---> Ticks/s: {:.1f}    Tick Time: {:.3f} (ms)    Pacing Error: {:.3f} (ms)\n",
+                    ticksPerSecond, reportTime * 1000 / tickCount, limiter.Error() * 1000);
+
+            #ifdef _WIN32
+                OutputDebugString(text.c_str());
+            #else
+                fputs(text.c_str(), stdout);
+            #endif
+
+                tickCount = 0;
+                reportTime = 0.0;
+            }
+        }
+
+        game->Finalize();
+
+        return 0;
+    }
+
+#ifdef _WIN32
     LRESULT CALLBACK Engine::EngineProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
     {
-        if (msg == WM_PAINT)
-        { game->Display(); }
+        Engine* engine = reinterpret_cast<Engine*>(GetWindowLongPtr(hWnd, GWLP_USERDATA));
+
+        // a pipelined frame displays next to the simulation, paint
+        // messages only redraw the window while the game is paused
+        if (msg == WM_PAINT && engine && (!engine->pipelined || engine->paused))
+        {
+            PROFILE_ZONE("Display");
+            engine->game->Display();
+        }
 
         return CallWindowProc(Input::InputProc, hWnd, msg, wParam, lParam);
     }
+#elif __linux__
+    void Engine::EngineProc(void* context, _XEvent* event) noexcept
+    {
+        Engine* engine = static_cast<Engine*>(context);
+
+        // present completions go back to the framebuffer, the rest is input
+        if (!engine->graphics->Complete(event))
+            engine->input->InputProc(event);
+    }
+#endif
 }
\ No newline at end of file
@@ -5,46 +5,135 @@
 #include "Window.h"
 #include "Input.h"
 #include "Timer.h"
+#include "JobSystem.h"
+#include "TaskScheduler.h"
+#include "TimerWheel.h"
+#include "FrameStats.h"
+#include "FrameLimiter.h"
+#include "ResolutionScaler.h"
+#include "Recorder.h"
 #include "Game.h"
 
 namespace WXE
 {
+    enum EngineModes { GRAPHICAL, HEADLESS };
+
+    // ---------------------------------------------------
+    // Engine state lives in the instance: a process may
+    // run several headless engines side by side (see
+    // EngineGroup), each with its own game, input, timers
+    // and clocks. Only a graphical engine owns a window.
+    // ---------------------------------------------------
+
     class EngineDesc
     {
     protected:
-        static Timer timer;
-        static bool paused;
+        Timer timer;
+        bool paused;
+        bool running;
+        int32 engineMode;
+        double tickRate;
+        double ticksPerSecond;
+        double fixedStep;
+        double accumulator;
+        uint32 maxSteps;
+        bool pipelined;
+        bool sharedJobs;
 
     public:
-        static Graphics* graphics;
-        static Window* window;
-        static Input* input;
-        static Game* game;
-        static double frameTime;
-
-        static void Pause() noexcept;
-        static void Resume() noexcept;
+        Graphics* graphics;
+        Window* window;
+        Input* input;
+        JobSystem* jobs;
+        TaskScheduler* scheduler;
+        Game* game;
+        double frameTime;
+        double interpolation;
+        FrameStats stats;
+        FrameLimiter limiter;
+        ResolutionScaler scaler;
+        Recorder recorder;
+        TimerWheel timers;
+
+        EngineDesc() noexcept;
+
+        void Pause() noexcept;
+        void Resume() noexcept;
+        void Quit() noexcept;
+
+        int32 Mode() const noexcept;
+        bool Running() const noexcept;
+        void TickRate(const double hz) noexcept;
+        double TicksPerSecond() const noexcept;
+        void FixedStep(const double hz, const uint32 maxCatchUp = 5) noexcept;
+        void Pipelined(const bool state) noexcept;
+        void FrameRate(const double hz) noexcept;
+        void DynamicResolution(const double hz, const float minScale = 0.5f) noexcept;
     };
 
     inline void EngineDesc::Pause() noexcept
     { paused = true; timer.Stop(); }
 
     inline void EngineDesc::Resume() noexcept
-    { paused = false; timer.Start(); }
+    { paused = false; timer.Start(); limiter.Reset(); }
+
+    inline void EngineDesc::Quit() noexcept
+    { running = false; }
+
+    inline int32 EngineDesc::Mode() const noexcept
+    { return engineMode; }
+
+    inline bool EngineDesc::Running() const noexcept
+    { return running; }
+
+    inline void EngineDesc::TickRate(const double hz) noexcept
+    { tickRate = hz; }
+
+    inline double EngineDesc::TicksPerSecond() const noexcept
+    { return ticksPerSecond; }
+
+    inline void EngineDesc::FixedStep(const double hz, const uint32 maxCatchUp) noexcept
+    { fixedStep = (hz > 0.0) ? 1.0 / hz : 0.0; maxSteps = maxCatchUp; accumulator = 0.0; }
+
+    inline void EngineDesc::Pipelined(const bool state) noexcept
+    { pipelined = state; }
+
+    inline void EngineDesc::FrameRate(const double hz) noexcept
+    { limiter.Target(hz); }
+
+    // render scale follows the frame cost against a 1/hz budget; 0 turns it off
+    inline void EngineDesc::DynamicResolution(const double hz, const float minScale) noexcept
+    { scaler.Target(hz, minScale); if (graphics) graphics->Scale(1.0f); }
 
 	class Engine final : public EngineDesc
 	{
 	private:
+		// frames counted for the debug title, per engine since engines tick side by side
+		double titleTime;
+		uint32 titleFrames;
+
+		void Attach(Game* game);
 		double FrameTime();
+		void Simulate() noexcept;
+		void Failures() noexcept;
+		void Frame() noexcept;
+		bool Tick(const double tickTime) noexcept;
 		int32 Loop() noexcept;
+		int32 Headless() noexcept;
+
+		friend class EngineGroup;
 
 	public:
-        Engine() noexcept;
+        Engine(const int32 mode = GRAPHICAL, JobSystem* shared = nullptr) noexcept;
         ~Engine() noexcept;
 
         int32 Start(Game* game);
 
+    #ifdef _WIN32
         static LRESULT CALLBACK EngineProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
+    #elif __linux__
+        static void EngineProc(void* engine, _XEvent* event) noexcept;
+    #endif
 	};
 }
 
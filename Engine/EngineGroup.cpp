@@ -0,0 +1,145 @@
+#include "EngineGroup.h"
+#include "Profiler.h"
+#include <format>
+#include <thread>
+using std::format;
+using std::this_thread::sleep_for;
+using std::chrono::milliseconds;
+
+#ifndef _WIN32
+    #include <cstdio>
+#endif
+
+namespace WXE
+{
+    EngineGroup::EngineGroup(const uint32 workers) :
+        jobs{ new JobSystem(workers) },
+        ticksPerSecond{},
+        running{ false }
+    {
+    }
+
+    EngineGroup::~EngineGroup() noexcept
+    {
+        // engines go first, their schedulers still hold the job system
+        for (Engine* engine : engines)
+            delete engine;
+
+        delete jobs;
+    }
+
+    Engine* EngineGroup::Add(Game* game)
+    {
+        Engine* engine = new Engine(HEADLESS, jobs);
+
+        // there is no window to feed it: bots push events or load frames
+        engine->input = new Input();
+        engine->Attach(game);
+
+        engines.push_back(engine);
+        return engine;
+    }
+
+    uint32 EngineGroup::Tick() noexcept
+    {
+        JobCounter ticked {};
+
+        jobs->ParallelFor(Size(), 1, [this, &ticked](uint32 begin, uint32 end)
+        {
+            for (uint32 i = begin; i < end; ++i)
+            {
+                Engine* engine = engines[i];
+
+                if (!engine->running || engine->paused)
+                    continue;
+
+                double tickTime = engine->timer.Reset();
+                Clock::Update();
+
+                if (engine->tickRate > 0.0)
+                    tickTime = 1.0 / engine->tickRate;
+
+                if (!engine->Tick(tickTime))
+                    engine->running = false;
+
+                ticked.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+        return ticked.load(std::memory_order_relaxed);
+    }
+
+    int32 EngineGroup::Run() noexcept
+    {
+        double reportTime {};
+        uint64 tickCount {};
+        uint32 rounds {};
+
+        for (Engine* engine : engines)
+        {
+            engine->running = true;
+            engine->timer.Start();
+            engine->game->Init();
+        }
+
+        timer.Start();
+        running = true;
+
+        while (running)
+        {
+            uint32 ticked;
+
+            {
+                PROFILE_ZONE("Group Tick");
+                ticked = Tick();
+            }
+
+            if (ticked == 0)
+            {
+                bool alive {};
+                for (Engine* engine : engines)
+                    alive |= engine->running;
+
+                if (!alive)
+                    break;
+
+                // everyone is paused, check back every 10 ms
+                sleep_for(milliseconds(10));
+            }
+
+            // -----------------------------------------------
+            // Report group throughput once every second
+            // -----------------------------------------------
+
+            reportTime += timer.Reset();
+            tickCount += ticked;
+            rounds++;
+
+            if (reportTime >= 1.0)
+            {
+                ticksPerSecond = tickCount / reportTime;
+
+                for (Engine* engine : engines)
+                    engine->ticksPerSecond = rounds / reportTime;
+
+                string text = format("---> Engines: {}    Ticks/s: {:.1f}    Group Tick: {:.3f} (ms)\n",
+                    Size(), ticksPerSecond, reportTime * 1000 / rounds);
+
+            #ifdef _WIN32
+                OutputDebugString(text.c_str());
+            #else
+                fputs(text.c_str(), stdout);
+            #endif
+
+                tickCount = 0;
+                rounds = 0;
+                reportTime = 0.0;
+            }
+        }
+
+        for (Engine* engine : engines)
+            engine->game->Finalize();
+
+        return 0;
+    }
+}
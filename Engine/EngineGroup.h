@@ -0,0 +1,59 @@
+#ifndef ENGINEGROUP_H
+#define ENGINEGROUP_H
+
+#include "Engine.h"
+#include <vector>
+
+namespace WXE
+{
+    // ---------------------------------------------------
+    // Many headless engines in one process, for bots and
+    // consolidated servers. The engines share the group
+    // job system: every Tick() runs each of them as one
+    // job and waits for all, so a tick costs the slowest
+    // engine, not the sum. An engine leaves the group run
+    // when it quits or its replay ends. With a tick rate
+    // set, an engine advances by 1/rate per tick instead
+    // of the wall time: groups run as fast as they can.
+    // ---------------------------------------------------
+
+    class EngineGroup final
+    {
+    private:
+        JobSystem* jobs;
+        std::vector<Engine*> engines;
+        Timer timer;
+        double ticksPerSecond;
+        bool running;
+
+        uint32 Tick() noexcept;
+
+    public:
+        EngineGroup(const uint32 workers = 0);
+        ~EngineGroup() noexcept;
+
+        Engine* Add(Game* game);
+        Engine* Get(const uint32 index) const noexcept;
+        uint32 Size() const noexcept;
+
+        int32 Run() noexcept;
+        void Quit() noexcept;
+
+        double TicksPerSecond() const noexcept;
+    };
+
+    inline Engine* EngineGroup::Get(const uint32 index) const noexcept
+    { return engines[index]; }
+
+    inline uint32 EngineGroup::Size() const noexcept
+    { return static_cast<uint32>(engines.size()); }
+
+    inline void EngineGroup::Quit() noexcept
+    { running = false; }
+
+    // engine ticks per second, summed over the group
+    inline double EngineGroup::TicksPerSecond() const noexcept
+    { return ticksPerSecond; }
+}
+
+#endif
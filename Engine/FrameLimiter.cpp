@@ -0,0 +1,110 @@
+#include "FrameLimiter.h"
+#include <cmath>
+#include <thread>
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::this_thread::yield;
+
+#ifdef __linux__
+	#include <cerrno>
+	#include <ctime>
+#endif
+
+namespace WXE
+{
+	FrameLimiter::FrameLimiter(const double hz) noexcept :
+		period{},
+		deadline{ Clock::now() },
+		overshoot{ 0.001 },
+		deviation{ 0.0005 },
+		error{},
+		maxError{},
+		idle{}
+	{
+		Target(hz);
+	}
+
+	void FrameLimiter::Target(const double hz) noexcept
+	{
+		period = (hz > 0.0)
+			? duration_cast<Clock::duration>(duration<double>(1.0 / hz))
+			: Clock::duration{};
+
+		maxError = 0.0;
+		Reset();
+	}
+
+	double FrameLimiter::Target() const noexcept
+	{
+		return (period.count() > 0) ? 1.0 / duration<double>(period).count() : 0.0;
+	}
+
+	void FrameLimiter::Sleep(const Clock::time_point until) noexcept
+	{
+		// the TSC clock drifts from the kernel's clocks, so the deadline
+		// is turned into an interval on the clock that set it
+		Clock::duration interval = until - Clock::now();
+
+		if (interval.count() <= 0)
+			return;
+
+	#ifdef __linux__
+		int64 nanos = interval.count();
+		timespec ts { static_cast<time_t>(nanos / 1000000000), static_cast<long>(nanos % 1000000000) };
+
+		// a signal leaves the remaining time in ts to sleep again
+		while (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR);
+	#else
+		std::this_thread::sleep_for(interval);
+	#endif
+	}
+
+	void FrameLimiter::Wait() noexcept
+	{
+		idle = 0.0;
+
+		if (period.count() == 0)
+			return;
+
+		Clock::time_point now = Clock::now();
+		deadline += period;
+
+		// a frame that ran long starts a new schedule instead of
+		// rushing the following ones to catch up
+		if (deadline <= now)
+		{
+			deadline = now;
+			return;
+		}
+
+		// never spin for more than half a frame, whatever the estimate
+		double seconds = duration<double>(period).count();
+		double margin = (Margin() < seconds / 2) ? Margin() : seconds / 2;
+		Clock::time_point wake = deadline - duration_cast<Clock::duration>(duration<double>(margin));
+
+		if (wake > now)
+		{
+			Sleep(wake);
+
+			// one preempted wake-up should not blow up the estimate
+			double late = duration<double>(Clock::now() - wake).count();
+			if (late > seconds) late = seconds;
+
+			double diff = late - overshoot;
+			overshoot += diff / 16.0;
+			deviation += (std::fabs(diff) - deviation) / 16.0;
+		}
+
+		while (Clock::now() < deadline)
+			yield();
+
+		Clock::time_point end = Clock::now();
+		idle = duration<double>(end - now).count();
+
+		double late = duration<double>(end - deadline).count();
+		error += (late - error) / 16.0;
+
+		if (late > maxError)
+			maxError = late;
+	}
+}
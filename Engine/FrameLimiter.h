@@ -0,0 +1,63 @@
+#ifndef FRAMELIMITER_H
+#define FRAMELIMITER_H
+
+#include "Types.h"
+#include "Clock.h"
+
+namespace WXE
+{
+	// ---------------------------------------------------
+	// Caps the frame rate against absolute deadlines. Each
+	// Wait() sleeps until a margin before the deadline and
+	// spins the rest; the margin follows the measured OS
+	// sleep overshoot, so the spin stays short on a quiet
+	// system and grows only when the scheduler is late.
+	// ---------------------------------------------------
+
+	class FrameLimiter final
+	{
+	private:
+		Clock::duration period;
+		Clock::time_point deadline;
+		double overshoot;
+		double deviation;
+		double error;
+		double maxError;
+		double idle;
+
+		static void Sleep(const Clock::time_point until) noexcept;
+
+	public:
+		FrameLimiter(const double hz = 0.0) noexcept;
+
+		void Target(const double hz) noexcept;
+		double Target() const noexcept;
+		void Reset() noexcept;
+		void Wait() noexcept;
+
+		double Margin() const noexcept;
+		double Error() const noexcept;
+		double MaxError() const noexcept;
+		double Idle() const noexcept;
+	};
+
+	inline void FrameLimiter::Reset() noexcept
+	{ deadline = Clock::now(); }
+
+	// sleep stops this far ahead of the deadline
+	inline double FrameLimiter::Margin() const noexcept
+	{ return (overshoot + 4.0 * deviation > 0.0) ? overshoot + 4.0 * deviation : 0.0; }
+
+	// average time a frame is released past its deadline
+	inline double FrameLimiter::Error() const noexcept
+	{ return error; }
+
+	inline double FrameLimiter::MaxError() const noexcept
+	{ return maxError; }
+
+	// time the last Wait() held the frame back: frame time minus this is what the frame cost
+	inline double FrameLimiter::Idle() const noexcept
+	{ return idle; }
+}
+
+#endif
@@ -0,0 +1,129 @@
+#include "FrameRing.h"
+#include <thread>
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::this_thread::sleep_until;
+
+namespace WXE
+{
+	FrameRing::FrameRing(FenceDevice* device, const uint32 frames) noexcept :
+		device{},
+		fences{},
+		count{},
+		index{},
+		frames{},
+		stalls{}
+	{
+		Initialize(device, frames);
+	}
+
+	void FrameRing::Initialize(FenceDevice* device, const uint32 frames) noexcept
+	{
+		this->device = device;
+		count = (frames < 1) ? 1 : (frames > uint32(MAX_FRAMES) ? uint32(MAX_FRAMES) : frames);
+		index = 0;
+		this->frames = 0;
+		stalls = 0;
+
+		// value 0 is reached before anything is signaled
+		for (uint64& fence : fences)
+			fence = 0;
+	}
+
+	uint32 FrameRing::Begin() noexcept
+	{
+		// the frame that last used this slot must be off the GPU
+		if (device->Completed() < fences[index])
+		{
+			stalls++;
+			device->Wait(fences[index]);
+		}
+
+		frames++;
+		return index;
+	}
+
+	// returns the fence value the frame was closed under
+	uint64 FrameRing::End() noexcept
+	{
+		uint64 fence = device->Signal();
+
+		fences[index] = fence;
+		index = (index + 1) % count;
+
+		return fence;
+	}
+
+	void FrameRing::Flush() noexcept
+	{
+		if (!device)
+			return;
+
+		// the newest slot holds the highest value
+		uint64 last = fences[(index + count - 1) % count];
+
+		if (device->Completed() < last)
+			device->Wait(last);
+	}
+
+	// ---------------------------------------------------
+
+	MockDevice::MockDevice(const double gpuTime) noexcept :
+		pending{},
+		busy{ Clock::now() },
+		work{},
+		signaled{},
+		retired{}
+	{
+		GpuTime(gpuTime);
+	}
+
+	void MockDevice::GpuTime(const double seconds) noexcept
+	{
+		work = duration_cast<Clock::duration>(duration<double>(seconds));
+	}
+
+	void MockDevice::Retire(const Clock::time_point now) noexcept
+	{
+		while (!pending.empty() && pending.front() <= now)
+		{
+			pending.pop_front();
+			retired++;
+		}
+	}
+
+	uint64 MockDevice::Signal() noexcept
+	{
+		Clock::time_point now = Clock::now();
+		Retire(now);
+
+		// an idle queue starts right away, a busy one after its backlog
+		busy = (busy > now ? busy : now) + work;
+		pending.push_back(busy);
+
+		return ++signaled;
+	}
+
+	uint64 MockDevice::Completed() const noexcept
+	{
+		Clock::time_point now = Clock::now();
+		uint64 value = retired;
+
+		for (const Clock::time_point& done : pending)
+		{
+			if (done > now)
+				break;
+			value++;
+		}
+
+		return value;
+	}
+
+	void MockDevice::Wait(const uint64 value) noexcept
+	{
+		if (value > retired && value - retired <= pending.size())
+			sleep_until(pending[value - retired - 1]);
+
+		Retire(Clock::now());
+	}
+}
@@ -0,0 +1,108 @@
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include "Types.h"
+#include "Clock.h"
+#include <deque>
+
+namespace WXE
+{
+	// ---------------------------------------------------
+	// What the frame ring needs from a GPU queue. Signal()
+	// queues a fence value behind the work submitted so
+	// far and returns it, values go up by one per signal;
+	// Completed() is the last value the queue reached and
+	// Wait() blocks until a value is reached.
+	// ---------------------------------------------------
+
+	class FenceDevice
+	{
+	public:
+		virtual ~FenceDevice() = default;
+
+		virtual uint64 Signal() noexcept = 0;
+		virtual uint64 Completed() const noexcept = 0;
+		virtual void Wait(const uint64 value) noexcept = 0;
+	};
+
+	// ---------------------------------------------------
+	// Frames in flight. Every slot owns the resources one
+	// frame records into (e.g. a command allocator) and
+	// the fence value signaled when that frame went to the
+	// queue. Begin() only blocks when the slot it hands
+	// out is still being executed, so the CPU can record
+	// up to Frames() - 1 frames ahead of the GPU.
+	// ---------------------------------------------------
+
+	class FrameRing final
+	{
+	public:
+		enum { MAX_FRAMES = 4 };
+
+	private:
+		FenceDevice* device;
+		uint64 fences[MAX_FRAMES];
+		uint32 count;
+		uint32 index;
+		uint64 frames;
+		uint64 stalls;
+
+	public:
+		FrameRing(FenceDevice* device = nullptr, const uint32 frames = 2) noexcept;
+
+		void Initialize(FenceDevice* device, const uint32 frames) noexcept;
+		uint32 Begin() noexcept;
+		uint64 End() noexcept;
+		void Flush() noexcept;
+
+		uint32 Index() const noexcept;
+		uint32 Frames() const noexcept;
+		uint64 Stalls() const noexcept;
+		double StallRate() const noexcept;
+	};
+
+	// slot of the frame being recorded
+	inline uint32 FrameRing::Index() const noexcept
+	{ return index; }
+
+	inline uint32 FrameRing::Frames() const noexcept
+	{ return count; }
+
+	// times Begin() had to wait for the GPU
+	inline uint64 FrameRing::Stalls() const noexcept
+	{ return stalls; }
+
+	inline double FrameRing::StallRate() const noexcept
+	{ return frames ? double(stalls) / frames : 0.0; }
+
+	// ---------------------------------------------------
+	// A GPU queue played by the CPU, to drive the ring
+	// where there is no device. Work signaled on it takes
+	// gpuTime to run, in order: it starts when signaled
+	// or when the previous signal completed, whichever
+	// comes last.
+	// ---------------------------------------------------
+
+	class MockDevice final : public FenceDevice
+	{
+	private:
+		std::deque<Clock::time_point> pending;
+		Clock::time_point busy;
+		Clock::duration work;
+		uint64 signaled;
+		uint64 retired;
+
+		void Retire(const Clock::time_point now) noexcept;
+
+	public:
+		MockDevice(const double gpuTime = 0.0) noexcept;
+
+		void GpuTime(const double seconds) noexcept;
+
+		uint64 Signal() noexcept override;
+		uint64 Completed() const noexcept override;
+		void Wait(const uint64 value) noexcept override;
+	};
+}
+
+#endif
@@ -0,0 +1,213 @@
+#include "FrameStats.h"
+#include <cstdio>
+#include <cstring>
+
+namespace WXE
+{
+    FrameStats::FrameStats() noexcept :
+        dumpFormat{ CSV },
+        dumpPeriod{},
+        dumpElapsed{},
+        dumpDue{},
+        dumpLine{},
+        jobs{},
+        writing{}
+    {
+        hitchThreshold = 1.0 / 30.0;
+        Reset();
+    }
+
+    void FrameStats::Reset() noexcept
+    {
+        memset(samples, 0, sizeof(samples));
+        memset(histogram, 0, sizeof(histogram));
+        count = 0;
+        next = 0;
+        windowHitches = 0;
+        totalFrames = 0;
+        totalHitches = 0;
+    }
+
+    uint32 FrameStats::Bucket(const double secs) noexcept
+    {
+        double index = secs * 10000.0;
+        return (index >= double(BUCKETS)) ? uint32(BUCKETS) : static_cast<uint32>(index);
+    }
+
+    void FrameStats::Add(const double frameTime) noexcept
+    {
+        // evict the oldest sample once the window is full
+        if (count == WINDOW)
+        {
+            histogram[Bucket(samples[next])]--;
+            if (samples[next] > hitchThreshold)
+                windowHitches--;
+        }
+        else
+        {
+            count++;
+        }
+
+        float sample = static_cast<float>(frameTime);
+
+        samples[next] = sample;
+        histogram[Bucket(sample)]++;
+        next = (next + 1) % WINDOW;
+
+        totalFrames++;
+        if (sample > hitchThreshold)
+        {
+            windowHitches++;
+            totalHitches++;
+        }
+
+        if (dumpPeriod > 0.0)
+        {
+            dumpElapsed += frameTime;
+
+            if (dumpElapsed >= dumpPeriod)
+            {
+                dumpLine = Line();
+                dumpDue = true;
+                dumpElapsed = 0.0;
+            }
+        }
+
+        // while the last line is still being written a newer one replaces
+        // the waiting one, the frame never waits on the file
+        if (dumpDue && writing.load(std::memory_order_acquire) == 0)
+            Post();
+    }
+
+    void FrameStats::Post() noexcept
+    {
+        dumpDue = false;
+
+        if (!jobs)
+        {
+            Append(dumpFile, dumpFormat, dumpLine);
+            return;
+        }
+
+        jobs->Schedule([file = dumpFile, format = dumpFormat, line = dumpLine]
+        {
+            Append(file, format, line);
+        }, &writing);
+    }
+
+    void FrameStats::Flush() noexcept
+    {
+        if (jobs)
+            jobs->Wait(writing);
+
+        // the part of a period since the last line is written too
+        if (dumpPeriod > 0.0 && dumpElapsed > 0.0)
+        {
+            dumpLine = Line();
+            dumpDue = true;
+            dumpElapsed = 0.0;
+        }
+
+        if (dumpDue)
+        {
+            dumpDue = false;
+            Append(dumpFile, dumpFormat, dumpLine);
+        }
+    }
+
+    double FrameStats::Percentile(const double percent) const noexcept
+    {
+        if (count == 0)
+            return 0.0;
+
+        uint32 rank = static_cast<uint32>(percent / 100.0 * count + 0.5);
+        rank = (rank < 1) ? 1 : (rank > count ? count : rank);
+
+        uint32 seen {};
+        for (uint32 i = 0; i < BUCKETS; ++i)
+        {
+            seen += histogram[i];
+            if (seen >= rank)
+                return (i + 1) / 10000.0;
+        }
+
+        // falls in the overflow bucket: the exact maximum is the best answer
+        return Max();
+    }
+
+    double FrameStats::Max() const noexcept
+    {
+        float max {};
+        for (uint32 i = 0; i < count; ++i)
+            max = (samples[i] > max) ? samples[i] : max;
+        return max;
+    }
+
+    double FrameStats::Average() const noexcept
+    {
+        double sum {};
+        for (uint32 i = 0; i < count; ++i)
+            sum += samples[i];
+        return (count > 0) ? sum / count : 0.0;
+    }
+
+    void FrameStats::HitchThreshold(const double secs) noexcept
+    {
+        hitchThreshold = secs;
+
+        windowHitches = 0;
+        for (uint32 i = 0; i < count; ++i)
+            if (samples[i] > hitchThreshold)
+                windowHitches++;
+    }
+
+    void FrameStats::Dump(const string_view fileName, const double period, const int32 format)
+    {
+        dumpFile = fileName;
+        dumpPeriod = period;
+        dumpFormat = format;
+        dumpElapsed = 0.0;
+    }
+
+    StatsLine FrameStats::Line() const noexcept
+    {
+        return { totalFrames, Average(), P50(), P95(), P99(), Max(), windowHitches, totalHitches };
+    }
+
+    bool FrameStats::Write(const string_view fileName, const int32 format) const
+    {
+        return Append(string(fileName), format, Line());
+    }
+
+    bool FrameStats::Append(const string& fileName, const int32 format, const StatsLine& line)
+    {
+        FILE* file = fopen(fileName.c_str(), "a");
+        if (!file)
+            return false;
+
+        // times are written in milliseconds
+        if (format == JSON)
+        {
+            fprintf(file,
+                "{\"frames\":%llu,\"avg\":%.3f,\"p50\":%.3f,\"p95\":%.3f,\"p99\":%.3f,\"max\":%.3f,"
+                "\"hitches\":%u,\"totalHitches\":%llu}\n",
+                static_cast<unsigned long long>(line.frames), line.avg * 1000, line.p50 * 1000,
+                line.p95 * 1000, line.p99 * 1000, line.max * 1000,
+                line.hitches, static_cast<unsigned long long>(line.totalHitches));
+        }
+        else
+        {
+            fseek(file, 0, SEEK_END);
+            if (ftell(file) == 0)
+                fputs("frames,avg,p50,p95,p99,max,hitches,totalHitches\n", file);
+
+            fprintf(file, "%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%u,%llu\n",
+                static_cast<unsigned long long>(line.frames), line.avg * 1000, line.p50 * 1000,
+                line.p95 * 1000, line.p99 * 1000, line.max * 1000,
+                line.hitches, static_cast<unsigned long long>(line.totalHitches));
+        }
+
+        fclose(file);
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#ifndef FRAMESTATS_H
+#define FRAMESTATS_H
+
+#include "Types.h"
+#include "JobSystem.h"
+
+namespace WXE
+{
+	enum StatsFormats { CSV, JSON };
+
+	// one line of a dump, times in seconds
+	struct StatsLine
+	{
+		uint64 frames;
+		double avg;
+		double p50;
+		double p95;
+		double p99;
+		double max;
+		uint32 hitches;
+		uint64 totalHitches;
+	};
+
+	// ---------------------------------------------------
+	// Rolling frame time statistics over the last WINDOW
+	// frames. Add() never allocates: samples live in a ring
+	// and a 0.1 ms histogram (up to 100 ms) is kept in step
+	// with it, so percentiles are a walk over the buckets.
+	// A periodic dump takes a StatsLine on the frame and
+	// appends it to the file on a job, when it has one;
+	// Flush() waits for that write and adds the last line.
+	// ---------------------------------------------------
+
+	class FrameStats final
+	{
+	public:
+		enum { WINDOW = 1024, BUCKETS = 1000 };
+
+	private:
+		float  samples[WINDOW];
+		uint32 histogram[BUCKETS + 1];
+		uint32 count;
+		uint32 next;
+		uint32 windowHitches;
+		uint64 totalFrames;
+		uint64 totalHitches;
+		double hitchThreshold;
+
+		string dumpFile;
+		int32  dumpFormat;
+		double dumpPeriod;
+		double dumpElapsed;
+		bool   dumpDue;
+		StatsLine dumpLine;
+		JobSystem* jobs;
+		JobCounter writing;
+
+		static uint32 Bucket(const double secs) noexcept;
+		static bool Append(const string& fileName, const int32 format, const StatsLine& line);
+		void Post() noexcept;
+
+	public:
+		FrameStats() noexcept;
+
+		void Add(const double frameTime) noexcept;
+		void Reset() noexcept;
+
+		double Percentile(const double percent) const noexcept;
+		double P50() const noexcept;
+		double P95() const noexcept;
+		double P99() const noexcept;
+		double Max() const noexcept;
+		double Average() const noexcept;
+
+		uint32 Hitches() const noexcept;
+		uint64 TotalHitches() const noexcept;
+		uint64 Frames() const noexcept;
+		void HitchThreshold(const double secs) noexcept;
+
+		StatsLine Line() const noexcept;
+		void Dump(const string_view fileName, const double period, const int32 format = CSV);
+		void Jobs(JobSystem* jobSystem) noexcept;
+		void Flush() noexcept;
+		bool Write(const string_view fileName, const int32 format = CSV) const;
+	};
+
+	// periodic dumps are written on this job system, or on the frame without one
+	inline void FrameStats::Jobs(JobSystem* jobSystem) noexcept
+	{ jobs = jobSystem; }
+
+	inline double FrameStats::P50() const noexcept
+	{ return Percentile(50.0); }
+
+	inline double FrameStats::P95() const noexcept
+	{ return Percentile(95.0); }
+
+	inline double FrameStats::P99() const noexcept
+	{ return Percentile(99.0); }
+
+	inline uint32 FrameStats::Hitches() const noexcept
+	{ return windowHitches; }
+
+	inline uint64 FrameStats::TotalHitches() const noexcept
+	{ return totalHitches; }
+
+	inline uint64 FrameStats::Frames() const noexcept
+	{ return totalFrames; }
+}
+
+#endif
\ No newline at end of file
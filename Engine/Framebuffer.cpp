@@ -0,0 +1,270 @@
+#include "Framebuffer.h"
+
+#ifdef __linux__
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <cstdlib>
+
+namespace WXE::Linux
+{
+	struct Framebuffer::Segment
+	{
+		XShmSegmentInfo info;
+	};
+
+	// XShmAttach fails asynchronously (on a remote display,
+	// for one), so its error is caught around a round trip
+	static bool attachFailed = false;
+
+	static int AttachError(Display*, XErrorEvent*)
+	{
+		attachFailed = true;
+		return 0;
+	}
+
+	struct Completion
+	{
+		int32 type;
+		ShmSeg segment;
+	};
+
+	static Bool IsCompletion(Display*, XEvent* event, XPointer arg)
+	{
+		const Completion* wanted = reinterpret_cast<const Completion*>(arg);
+		return event->type == wanted->type
+			&& reinterpret_cast<const XShmCompletionEvent*>(event)->shmseg == wanted->segment;
+	}
+
+	Framebuffer::Framebuffer() noexcept :
+		display{},
+		window{},
+		gc{},
+		buffers{},
+		current{},
+		width{},
+		height{},
+		completionType{ -1 },
+		shared{}
+	{
+	}
+
+	Framebuffer::~Framebuffer() noexcept
+	{
+		for (Buffer& buffer : buffers)
+			Destroy(buffer);
+
+		if (gc)
+			XFreeGC(display, gc);
+	}
+
+	bool Framebuffer::Initialize(const Window* owner, const uint32 width, const uint32 height) noexcept
+	{
+		if (owner == nullptr || owner->XDisplay() == nullptr)
+			return false;
+
+		display = owner->XDisplay();
+		window = owner->Id();
+
+		// pixels are written as 0xAARRGGBB words
+		if (DefaultDepth(display, DefaultScreen(display)) < 24)
+			return false;
+
+		gc = XCreateGC(display, window, 0, nullptr);
+
+		shared = XShmQueryExtension(display);
+		if (shared)
+			completionType = XShmGetEventBase(display) + ShmCompletion;
+
+		return Resize(width, height);
+	}
+
+	bool Framebuffer::Create(Buffer& buffer) noexcept
+	{
+		int32 screen = DefaultScreen(display);
+		Visual* visual = DefaultVisual(display, screen);
+		uint32 depth = DefaultDepth(display, screen);
+
+		if (shared)
+		{
+			Segment* segment = new Segment{};
+			XImage* image = XShmCreateImage(display, visual, depth, ZPixmap, nullptr, &segment->info, width, height);
+
+			if (image)
+			{
+				segment->info.shmid = shmget(IPC_PRIVATE, image->bytes_per_line * image->height, IPC_CREAT | 0600);
+				segment->info.shmaddr = (segment->info.shmid != -1)
+					? static_cast<char*>(shmat(segment->info.shmid, nullptr, 0))
+					: reinterpret_cast<char*>(-1);
+
+				if (segment->info.shmaddr != reinterpret_cast<char*>(-1))
+				{
+					image->data = segment->info.shmaddr;
+					segment->info.readOnly = False;
+
+					XSync(display, False);
+					attachFailed = false;
+					XErrorHandler handler = XSetErrorHandler(AttachError);
+					XShmAttach(display, &segment->info);
+					XSync(display, False);
+					XSetErrorHandler(handler);
+
+					// the segment goes away with the last detach, even on a crash
+					shmctl(segment->info.shmid, IPC_RMID, nullptr);
+
+					if (!attachFailed)
+					{
+						buffer = Buffer{ image, segment, 0, false };
+						return true;
+					}
+
+					shmdt(segment->info.shmaddr);
+				}
+				else if (segment->info.shmid != -1)
+				{
+					shmctl(segment->info.shmid, IPC_RMID, nullptr);
+				}
+
+				image->data = nullptr;
+				XDestroyImage(image);
+			}
+
+			delete segment;
+
+			// no shared memory with this server: fall back for good
+			shared = false;
+		}
+
+		char* data = static_cast<char*>(malloc(size_t(width) * height * 4));
+		if (data == nullptr)
+			return false;
+
+		XImage* image = XCreateImage(display, visual, depth, ZPixmap, 0, data, width, height, 32, 0);
+		if (image == nullptr)
+		{
+			free(data);
+			return false;
+		}
+
+		buffer = Buffer{ image, nullptr, 0, false };
+		return true;
+	}
+
+	void Framebuffer::Destroy(Buffer& buffer) noexcept
+	{
+		if (buffer.image == nullptr)
+			return;
+
+		Acquire(buffer);
+
+		if (buffer.segment)
+		{
+			XShmDetach(display, &buffer.segment->info);
+			XSync(display, False);
+			shmdt(buffer.segment->info.shmaddr);
+			buffer.image->data = nullptr;
+			delete buffer.segment;
+		}
+
+		// frees the pixels of a non shared image too
+		XDestroyImage(buffer.image);
+		buffer = Buffer{};
+	}
+
+	bool Framebuffer::Resize(const uint32 width, const uint32 height) noexcept
+	{
+		if (display == nullptr || width == 0 || height == 0)
+			return false;
+
+		if (width == this->width && height == this->height && buffers[0].image)
+			return true;
+
+		for (Buffer& buffer : buffers)
+			Destroy(buffer);
+
+		this->width = width;
+		this->height = height;
+		current = 0;
+
+		for (Buffer& buffer : buffers)
+			if (!Create(buffer))
+				return false;
+
+		return true;
+	}
+
+	void Framebuffer::Acquire(Buffer& buffer) noexcept
+	{
+		if (!buffer.busy)
+			return;
+
+		// once the server has gone past the put, the segment is free;
+		// this also covers a completion read and dropped by the pump
+		if (LastKnownRequestProcessed(display) >= buffer.serial)
+		{
+			buffer.busy = false;
+			return;
+		}
+
+		Completion wanted { completionType, buffer.segment->info.shmseg };
+		XEvent event;
+		XIfEvent(display, &event, IsCompletion, reinterpret_cast<XPointer>(&wanted));
+		buffer.busy = false;
+	}
+
+	uint32* Framebuffer::Pixels() noexcept
+	{
+		Buffer& buffer = buffers[current];
+		if (buffer.image == nullptr)
+			return nullptr;
+
+		Acquire(buffer);
+		return reinterpret_cast<uint32*>(buffer.image->data);
+	}
+
+	uint32 Framebuffer::Pitch() const noexcept
+	{
+		const Buffer& buffer = buffers[current];
+		return buffer.image ? buffer.image->bytes_per_line / 4 : 0;
+	}
+
+	void Framebuffer::Present() noexcept
+	{
+		Buffer& buffer = buffers[current];
+		if (buffer.image == nullptr)
+			return;
+
+		if (buffer.segment)
+		{
+			buffer.serial = NextRequest(display);
+			buffer.busy = true;
+			XShmPutImage(display, window, gc, buffer.image, 0, 0, 0, 0, width, height, True);
+		}
+		else
+		{
+			XPutImage(display, window, gc, buffer.image, 0, 0, 0, 0, width, height);
+		}
+
+		XFlush(display);
+		current ^= 1;
+	}
+
+	bool Framebuffer::Complete(const _XEvent* event) noexcept
+	{
+		if (!shared || event->type != completionType)
+			return false;
+
+		const XShmCompletionEvent* completion = reinterpret_cast<const XShmCompletionEvent*>(event);
+
+		for (Buffer& buffer : buffers)
+			if (buffer.segment && buffer.segment->info.shmseg == completion->shmseg)
+				buffer.busy = false;
+
+		return true;
+	}
+}
+
+#endif
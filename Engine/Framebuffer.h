@@ -0,0 +1,80 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include "Types.h"
+
+#ifdef __linux__
+
+#include "Window.h"
+
+struct _XGC;
+struct _XImage;
+
+namespace WXE::Linux
+{
+	// ---------------------------------------------------
+	// CPU framebuffer presented to an X11 window. With the
+	// MIT-SHM extension the two buffers live in shared
+	// memory and Present() only sends their id to the
+	// server; a buffer is written again only once its
+	// put is known to be finished. Without it, the frame
+	// is copied over the socket with XPutImage.
+	// ---------------------------------------------------
+
+	class Framebuffer final
+	{
+	private:
+		struct Segment;
+
+		struct Buffer
+		{
+			_XImage* image;
+			Segment* segment;
+			unsigned long serial;
+			bool busy;
+		};
+
+		_XDisplay* display;
+		XWindow window;
+		_XGC* gc;
+		Buffer buffers[2];
+		uint32 current;
+		uint32 width;
+		uint32 height;
+		int32 completionType;
+		bool shared;
+
+		bool Create(Buffer& buffer) noexcept;
+		void Destroy(Buffer& buffer) noexcept;
+		void Acquire(Buffer& buffer) noexcept;
+
+	public:
+		Framebuffer() noexcept;
+		~Framebuffer() noexcept;
+
+		bool Initialize(const Window* owner, const uint32 width, const uint32 height) noexcept;
+		bool Resize(const uint32 width, const uint32 height) noexcept;
+
+		uint32* Pixels() noexcept;
+		uint32 Pitch() const noexcept;
+		uint32 Width() const noexcept;
+		uint32 Height() const noexcept;
+		bool Shared() const noexcept;
+
+		void Present() noexcept;
+		bool Complete(const _XEvent* event) noexcept;
+	};
+
+	inline uint32 Framebuffer::Width() const noexcept
+	{ return width; }
+
+	inline uint32 Framebuffer::Height() const noexcept
+	{ return height; }
+
+	inline bool Framebuffer::Shared() const noexcept
+	{ return shared; }
+}
+
+#endif
+
+#endif
@@ -1,18 +1,18 @@
 #include "Game.h"
 #include "Engine.h"
-#include <chrono>
-#include <thread>
-using std::chrono::milliseconds;
-using std::this_thread::sleep_for;
 
 namespace WXE
 {
-    Graphics*& Game::graphics = Engine::graphics;
-    Window*& Game::window = Engine::window;
-    Input*& Game::input = Engine::input;
-    double& Game::frameTime = Engine::frameTime;
-
-    Game::Game() noexcept 
+    Game::Game() noexcept :
+        engine{ nullptr },
+        graphics{ nullptr },
+        window{ nullptr },
+        input{ nullptr },
+        jobs{ nullptr },
+        scheduler{ nullptr },
+        timers{ nullptr },
+        frameTime{},
+        interpolation{}
     {
     }
 
@@ -27,7 +27,11 @@ namespace WXE
     void Game::Display() 
     {
     }
+
+    void Game::Sync() 
+    {
+    }
     
     void Game::OnPause() 
-    { sleep_for(milliseconds(10)); }
+    {}
 }
\ No newline at end of file
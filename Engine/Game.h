@@ -4,6 +4,11 @@
 #include "Window.h"
 #include "Input.h"
 #include "Graphics.h"
+#include "VulkanGraphics.h"
+#include "JobSystem.h"
+#include "TaskScheduler.h"
+#include "TimerWheel.h"
+#include "DoubleBuffer.h"
 
 #ifdef _WIN32
     using Window = WXE::Windows::Window;
@@ -12,18 +17,40 @@
 #elif __linux__
     using Window = WXE::Linux::Window;
     using Input = WXE::Inputs::Input;
-    //using Graphics = WXE::DX12::Graphics;
+    #ifdef WXE_VULKAN
+        using Graphics = WXE::Vulkan::Graphics;
+    #else
+        using Graphics = WXE::Soft::Graphics;
+    #endif
 #endif
 
 namespace WXE
 {
+    class EngineDesc;
+
+    // ---------------------------------------------------
+    // The engine binds a game to its own state on Start:
+    // frameTime and interpolation are refreshed before
+    // every Update and Draw, the rest is set once.
+    // Pipelined, Update runs on a worker while Draw and
+    // Display run on the main thread, so the two only
+    // read the render state Sync handed over.
+    // ---------------------------------------------------
+
 	class Game
 	{
     protected:
-        static Graphics*& graphics;
-        static Window*& window;
-        static Input*& input;
-        static double& frameTime;
+        EngineDesc* engine;
+        Graphics* graphics;
+        Window* window;
+        Input* input;
+        JobSystem* jobs;
+        TaskScheduler* scheduler;
+        TimerWheel* timers;
+        double frameTime;
+        double interpolation;
+
+        friend class Engine;
 
     public:
         Game() noexcept;
@@ -35,6 +62,7 @@ namespace WXE
 
         virtual void Draw();
         virtual void Display();
+        virtual void Sync();
         virtual void OnPause();
 	};
 }
@@ -1,30 +1,181 @@
 #include "Graphics.h"
 #include "Error.h"
 #include "Utils.h"
+#include "Profiler.h"
+#include "StreamCopy.h"
 #include <format>
 using std::format;
 
+#ifdef _WIN32
+
 namespace WXE::DX12
 {
+    QueueFence::QueueFence() noexcept :
+        queue{ nullptr },
+        fence{ nullptr },
+        event{ nullptr },
+        value{}
+    {
+    }
+
+    QueueFence::~QueueFence()
+    {
+        if (event)
+            CloseHandle(event);
+
+        SafeRelease(fence);
+    }
+
+    void QueueFence::Initialize(ID3D12Device4* device, ID3D12CommandQueue* queue)
+    {
+        this->queue = queue;
+
+        ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)));
+
+        // auto-reset: every wait leaves it ready for the next one
+        event = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+
+        if (!event)
+            ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+    }
+
+    uint64 QueueFence::Signal() noexcept
+    {
+        // a failed signal leaves the last value as the one to wait for
+        if (fence && SUCCEEDED(queue->Signal(fence, value + 1)))
+            value++;
+
+        return value;
+    }
+
+    uint64 QueueFence::Completed() const noexcept
+    {
+        return fence ? fence->GetCompletedValue() : value;
+    }
+
+    void QueueFence::Wait(const uint64 value) noexcept
+    {
+        PROFILE_ZONE("WaitFence");
+
+        if (Completed() >= value)
+            return;
+
+        if (SUCCEEDED(fence->SetEventOnCompletion(value, event)))
+            WaitForSingleObject(event, INFINITE);
+    }
+
+    // ---------------------------------------------------
+
+    CommandBarriers::CommandBarriers() noexcept :
+        list{ nullptr }
+    {
+    }
+
+    void CommandBarriers::Initialize(ID3D12GraphicsCommandList* list) noexcept
+    {
+        this->list = list;
+    }
+
+    void CommandBarriers::Barriers(const Transition* transitions, const uint32 count) noexcept
+    {
+        barriers.resize(count);
+
+        for (uint32 i = 0; i < count; ++i)
+        {
+            barriers[i] = {
+                .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
+                .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
+                .Transition {
+                    .pResource = static_cast<ID3D12Resource*>(transitions[i].resource),
+                    .Subresource = transitions[i].subresource,
+                    .StateBefore = static_cast<D3D12_RESOURCE_STATES>(transitions[i].before),
+                    .StateAfter = static_cast<D3D12_RESOURCE_STATES>(transitions[i].after),
+                },
+            };
+        }
+
+        list->ResourceBarrier(count, barriers.data());
+    }
+
+    // ---------------------------------------------------
+    // Placed buffers give their range back to the heap
+    // pool when they die: D3D12 releases the private data
+    // interfaces of an object together with it.
+    // ---------------------------------------------------
+
+    // {6B3E0C51-6E8A-4C1B-9F4D-2A7B5E9C1D30}
+    static const GUID HeapRangeGuid { 0x6b3e0c51, 0x6e8a, 0x4c1b, { 0x9f, 0x4d, 0x2a, 0x7b, 0x5e, 0x9c, 0x1d, 0x30 } };
+
+    class HeapRelease final : public IUnknown
+    {
+    private:
+        HeapPool* pool;
+        HeapRange range;
+        LONG references;
+
+    public:
+        HeapRelease(HeapPool* pool, const HeapRange& range) noexcept :
+            pool{ pool }, range{ range }, references{ 1 }
+        {}
+
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID id, void** object) override
+        {
+            if (id != __uuidof(IUnknown))
+            {
+                *object = nullptr;
+                return E_NOINTERFACE;
+            }
+
+            AddRef();
+            *object = this;
+            return S_OK;
+        }
+
+        ULONG STDMETHODCALLTYPE AddRef() override
+        { return static_cast<ULONG>(InterlockedIncrement(&references)); }
+
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            ULONG left = static_cast<ULONG>(InterlockedDecrement(&references));
+
+            if (left == 0)
+            {
+                pool->Free(range);
+                delete this;
+            }
+
+            return left;
+        }
+    };
+
 	Graphics::Graphics() noexcept :
+        window { nullptr },
         factory { nullptr },
         device { nullptr },
         swapChain { nullptr },
         commandQueue { nullptr },
         commandList { nullptr },
         commandListAlloc { nullptr },
+        frameAllocs { nullptr },
         depthStencil { nullptr },
         renderTargetHeap { nullptr },
         depthStencilHeap { nullptr },
-        fence { nullptr },
-        currentFence{},
-        rtDescriptorSize{}
+        rtDescriptorSize{},
+        copyQueue { nullptr },
+        copyList { nullptr },
+        copyAllocs { nullptr },
+        staging { nullptr },
+        stagingData { nullptr },
+        copyOpen { false },
+        jobs { nullptr },
+        states { D3D12_RESOURCE_STATE_GENERIC_READ }
 	{
         backBufferCount = 2;
         backBufferIndex = 0;
         antialiasing = 1;
         quality = 0;
         vSync = false;
+        renderScale = 1.0f;
 
         renderTargets = new ID3D12Resource * [backBufferCount] { nullptr };
         
@@ -35,6 +186,8 @@ namespace WXE::DX12
 
     Graphics::~Graphics()
     {
+        SubmitUploads();
+        copyBatches.Flush();
         WaitCommandQueue();
 
         if (renderTargets)
@@ -51,12 +204,32 @@ namespace WXE::DX12
         }
 
         SafeRelease(depthStencil);
-        SafeRelease(fence);
         SafeRelease(depthStencilHeap);
         SafeRelease(renderTargetHeap);
         SafeRelease(commandList);
         SafeRelease(commandListAlloc);
+
+        for (ID3D12CommandAllocator*& alloc : frameAllocs)
+            SafeRelease(alloc);
+
         SafeRelease(commandQueue);
+
+        if (staging)
+        {
+            staging->Unmap(0, nullptr);
+            staging->Release();
+        }
+
+        SafeRelease(copyList);
+
+        for (ID3D12CommandAllocator*& alloc : copyAllocs)
+            SafeRelease(alloc);
+
+        SafeRelease(copyQueue);
+
+        for (HeapPool& pool : heaps)
+            pool.Release();
+
         SafeRelease(device);
         SafeRelease(factory);
     }
@@ -166,8 +339,12 @@ namespace WXE::DX12
         SafeRelease(output);
     }
 
-    void Graphics::Initialize(Window* window)
+    void Graphics::Initialize(Window* window, JobSystem* jobs)
     {
+        // Clear() sizes the render region from the window every frame
+        this->window = window;
+        this->jobs = jobs;
+
         // ---------------------------------------------------
         // DXGI infrastructure and D3D device
         // ---------------------------------------------------
@@ -205,6 +382,35 @@ namespace WXE::DX12
         LogHardwareInfo();
     #endif 
 
+        // ---------------------------------------------------
+        // Buffer heaps, one pool per AllocationType
+        // ---------------------------------------------------
+
+        for (uint32 type : { GPU, UPLOAD })
+        {
+            heaps[type].Initialize(
+                [this, type](uint64 size) -> void*
+                {
+                    D3D12_HEAP_DESC heapDesc {
+                        .SizeInBytes = size,
+                        .Properties {
+                            .Type = (type == UPLOAD) ? D3D12_HEAP_TYPE_UPLOAD : D3D12_HEAP_TYPE_DEFAULT,
+                            .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+                            .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
+                            .CreationNodeMask = 1,
+                            .VisibleNodeMask = 1,
+                        },
+                        .Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
+                        .Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
+                    };
+
+                    ID3D12Heap* heap = nullptr;
+                    ThrowIfFailed(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap)));
+                    return heap;
+                },
+                [](void* heap) { static_cast<ID3D12Heap*>(heap)->Release(); });
+        }
+
         // ---------------------------------------------------
         // Queue, List and Command Allocator
         // ---------------------------------------------------
@@ -219,6 +425,9 @@ namespace WXE::DX12
             D3D12_COMMAND_LIST_TYPE_DIRECT, 
             IID_PPV_ARGS(&commandListAlloc)));
 
+        for (ID3D12CommandAllocator*& alloc : frameAllocs)
+            ThrowIfFailed(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&alloc)));
+
         ThrowIfFailed(device->CreateCommandList(
             0,
             D3D12_COMMAND_LIST_TYPE_DIRECT,
@@ -226,11 +435,45 @@ namespace WXE::DX12
             nullptr,
             IID_PPV_ARGS(&commandList)));
 
+        barriers.Initialize(commandList);
+
         // ---------------------------------------------------
         // CPU/GPU synchronization fence
         // ---------------------------------------------------
 
-        ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)));
+        fence.Initialize(device, commandQueue);
+        frames.Initialize(&fence, FRAMES_IN_FLIGHT);
+
+        // ---------------------------------------------------
+        // Copy queue and staging ring
+        // ---------------------------------------------------
+
+        D3D12_COMMAND_QUEUE_DESC copyQueueDesc {
+            .Type = D3D12_COMMAND_LIST_TYPE_COPY,
+            .Flags = D3D12_COMMAND_QUEUE_FLAG_NONE,
+        };
+        ThrowIfFailed(device->CreateCommandQueue(&copyQueueDesc, IID_PPV_ARGS(&copyQueue)));
+
+        for (ID3D12CommandAllocator*& alloc : copyAllocs)
+            ThrowIfFailed(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&alloc)));
+
+        ThrowIfFailed(device->CreateCommandList(
+            0,
+            D3D12_COMMAND_LIST_TYPE_COPY,
+            copyAllocs[0],
+            nullptr,
+            IID_PPV_ARGS(&copyList)));
+
+        // lists are created open, Upload() opens it when there is something to copy
+        copyList->Close();
+
+        copyFence.Initialize(device, copyQueue);
+        copyBatches.Initialize(&copyFence, COPY_BATCHES);
+
+        // the staging buffer stays mapped for the life of the device
+        Allocate(UPLOAD, STAGING_SIZE, &staging);
+        ThrowIfFailed(staging->Map(0, nullptr, reinterpret_cast<void**>(&stagingData)));
+        uploads.Initialize(&copyFence, STAGING_SIZE);
 
         // ---------------------------------------------------
         // Swap Chain
@@ -278,6 +521,7 @@ namespace WXE::DX12
         {
             swapChain->GetBuffer(i, IID_PPV_ARGS(&renderTargets[i]));
             device->CreateRenderTargetView(renderTargets[i], nullptr, rtHandle);
+            states.Track(renderTargets[i], D3D12_RESOURCE_STATE_PRESENT);
             rtHandle.ptr += rtDescriptorSize;
         }
 
@@ -336,17 +580,9 @@ namespace WXE::DX12
 
         device->CreateDepthStencilView(depthStencil, nullptr, dsHandle);
 
-        D3D12_RESOURCE_BARRIER barrier {
-            .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-            .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-            .Transition {
-                .pResource = depthStencil,
-                .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-                .StateBefore = D3D12_RESOURCE_STATE_COMMON,
-                .StateAfter = D3D12_RESOURCE_STATE_DEPTH_WRITE,
-            },
-        };
-        commandList->ResourceBarrier(1, &barrier);
+        states.Track(depthStencil, D3D12_RESOURCE_STATE_COMMON);
+        states.Require(depthStencil, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+        FlushBarriers();
 
         SubmitCommands();
 
@@ -373,21 +609,45 @@ namespace WXE::DX12
 
     void Graphics::Clear(ID3D12PipelineState* pso)
     {
-        commandListAlloc->Reset();
-
-        commandList->Reset(commandListAlloc, pso);
-
-        D3D12_RESOURCE_BARRIER barrier {
-            .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-            .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-            .Transition {
-                .pResource = renderTargets[backBufferIndex],
-                .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-                .StateBefore = D3D12_RESOURCE_STATE_PRESENT,
-                .StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET,
-            },
-        };
-        commandList->ResourceBarrier(1, &barrier);
+        PROFILE_ZONE("Clear");
+
+        // uploads recorded since the last frame go out ahead of it
+        SubmitUploads();
+        uploads.Reclaim();
+
+        // blocks only if this slot's previous frame is still on the GPU
+        ID3D12CommandAllocator* alloc = frameAllocs[frames.Begin()];
+
+        alloc->Reset();
+
+        commandList->Reset(alloc, pso);
+
+        // -----------------------------------------------
+        // A new render scale only shrinks the region drawn
+        // to; the swap chain stretches that source region
+        // over the window when presenting
+        // -----------------------------------------------
+
+        uint32 renderWidth = Scaled(window->Width());
+        uint32 renderHeight = Scaled(window->Height());
+
+        if (renderWidth != uint32(scissorRect.right) || renderHeight != uint32(scissorRect.bottom))
+        {
+            viewport.Width = static_cast<float>(renderWidth);
+            viewport.Height = static_cast<float>(renderHeight);
+            scissorRect = { 0, 0, static_cast<int32>(renderWidth), static_cast<int32>(renderHeight) };
+
+            IDXGISwapChain2* swapChain2 = nullptr;
+            if (SUCCEEDED(swapChain->QueryInterface(IID_PPV_ARGS(&swapChain2))))
+            {
+                swapChain2->SetSourceSize(renderWidth, renderHeight);
+                swapChain2->Release();
+            }
+        }
+
+        states.Require(renderTargets[backBufferIndex], D3D12_RESOURCE_STATE_RENDER_TARGET);
+        states.Require(depthStencil, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+        FlushBarriers();
 
         commandList->RSSetViewports(1, reinterpret_cast<D3D12_VIEWPORT*>(&viewport));
         commandList->RSSetScissorRects(1, reinterpret_cast<D3D12_RECT*>(&scissorRect));
@@ -401,32 +661,20 @@ namespace WXE::DX12
         commandList->OMSetRenderTargets(1, &rtHandle, true, &dsHandle);
     }
 
-    bool Graphics::WaitCommandQueue() noexcept
+    void Graphics::WaitCommandQueue() noexcept
     {
-        currentFence++;
+        PROFILE_ZONE("WaitCommandQueue");
 
-        if (FAILED(commandQueue->Signal(fence, currentFence)))
-            return false;
-
-        if (fence->GetCompletedValue() < currentFence)
-        {
-            HANDLE eventHandle = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
-
-            if (eventHandle)
-            {
-                if (FAILED(fence->SetEventOnCompletion(currentFence, eventHandle)))
-                    return false;
-
-                WaitForSingleObject(eventHandle, INFINITE);
-                CloseHandle(eventHandle);
-            }
-        }
-
-        return true;
+        // frames in flight are on the same queue, so this drains them too
+        fence.Wait(fence.Signal());
     }
 
     void Graphics::SubmitCommands() noexcept
     {
+        PROFILE_ZONE("SubmitCommands");
+
+        SubmitUploads();
+
         commandList->Close();
         ID3D12CommandList* cmdsLists[] { commandList };
         commandQueue->ExecuteCommandLists(static_cast<uint32>(countof(cmdsLists)), cmdsLists);
@@ -435,16 +683,8 @@ namespace WXE::DX12
 
     void Graphics::Allocate(const uint32 type, 
                             const uint32 sizeInBytes, 
-                            ID3D12Resource** resource) const
+                            ID3D12Resource** resource)
     {
-        D3D12_HEAP_PROPERTIES bufferProp {
-            .Type = (type == UPLOAD) ? D3D12_HEAP_TYPE_UPLOAD : D3D12_HEAP_TYPE_DEFAULT,
-            .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
-            .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
-            .CreationNodeMask = 1,
-            .VisibleNodeMask = 1,
-        };
-
         D3D12_RESOURCE_DESC bufferDesc {
             .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
             .Alignment = 0,
@@ -465,116 +705,323 @@ namespace WXE::DX12
             (type == UPLOAD) ? D3D12_RESOURCE_STATE_GENERIC_READ : D3D12_RESOURCE_STATE_COMMON
         };
 
-        ThrowIfFailed(device->CreateCommittedResource(
-            &bufferProp,
-            D3D12_HEAP_FLAG_NONE,
+        // ---------------------------------------------------
+        // Buffers are placed in pooled heaps, not committed
+        // one by one; D3D12 puts them on 64 KB boundaries
+        // ---------------------------------------------------
+
+        HeapPool& pool = heaps[(type == UPLOAD) ? UPLOAD : GPU];
+        HeapRange range;
+
+        if (!pool.Allocate(sizeInBytes, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, &range))
+            ThrowIfFailed(E_OUTOFMEMORY);
+
+        HRESULT result = device->CreatePlacedResource(
+            static_cast<ID3D12Heap*>(range.heap),
+            range.offset,
             &bufferDesc,
             initState,
             nullptr,
-            IID_PPV_ARGS(resource)));
+            IID_PPV_ARGS(resource));
+
+        if (FAILED(result))
+        {
+            pool.Free(range);
+            ThrowIfFailed(result);
+        }
+
+        HeapRelease* release = new HeapRelease(&pool, range);
+        (*resource)->SetPrivateDataInterface(HeapRangeGuid, release);
+        release->Release();
     }
 
-    void Graphics::Copy(const void* vertices, 
-                        const uint32 sizeInBytes,
-                        ID3D12Resource* bufferUpload, 
-                        ID3D12Resource* bufferGPU) noexcept
+    // ---------------------------------------------------
+    // Copies go through the staging ring, a piece at a time
+    // when the data is larger than the ring. If the space
+    // is held by the batch still being recorded, the batch
+    // is submitted and the ring waits for the copy queue.
+    // ---------------------------------------------------
+
+    void Graphics::Upload(const void* data,
+                          const uint32 sizeInBytes,
+                          ID3D12Resource* bufferGPU,
+                          const uint64 offset) noexcept
     {
-        // ---------------------------------------------------
-        // Copy vertices for the standard buffer (GPU)
-        // ---------------------------------------------------
-
-        D3D12_SUBRESOURCE_DATA vertexSubResourceData {
-            .pData = vertices,
-            .RowPitch = sizeInBytes,
-            .SlicePitch = sizeInBytes,
-        };
+        PROFILE_ZONE("Upload");
 
-        D3D12_PLACED_SUBRESOURCE_FOOTPRINT layouts{};
-        uint32 numRows{};
-        uint64 rowSizesInBytes{};
-        uint64 requiredSize{};
+        const uint8* source = static_cast<const uint8*>(data);
+        uint64 done {};
 
-        D3D12_RESOURCE_DESC bufferGPUDesc = bufferGPU->GetDesc();
+        while (done < sizeInBytes)
+        {
+            uint64 piece = (sizeInBytes - done < uploads.Capacity()) ? sizeInBytes - done : uploads.Capacity();
+            uint64 stagingOffset {};
 
-        device->GetCopyableFootprints(
-            &bufferGPUDesc,
-            0, 1, 0, &layouts, &numRows,
-            &rowSizesInBytes, &requiredSize);
+            if (!uploads.Allocate(piece, 16, &stagingOffset))
+            {
+                SubmitUploads();
+                uploads.Allocate(piece, 16, &stagingOffset);
+            }
 
-        BYTE* pData{};
-        bufferUpload->Map(0, nullptr, reinterpret_cast<void**>(&pData));
+            if (!copyOpen)
+            {
+                // waits only if this allocator's last batch is still copying
+                ID3D12CommandAllocator* alloc = copyAllocs[copyBatches.Begin()];
+                alloc->Reset();
+                copyList->Reset(alloc, nullptr);
+                copyOpen = true;
+            }
 
-        D3D12_MEMCPY_DEST DestData =
-        {
-            pData + layouts.Offset,
-            layouts.Footprint.RowPitch,
-            layouts.Footprint.RowPitch * uint64(numRows)
-        };
+            StreamCopy(stagingData + stagingOffset, source + done, static_cast<size_t>(piece), jobs);
+            copyList->CopyBufferRegion(bufferGPU, offset + done, staging, stagingOffset, piece);
 
-        for (uint32 z = 0; z < layouts.Footprint.Depth; ++z)
-        {
-            BYTE* destSlice = reinterpret_cast<BYTE*>(DestData.pData) + DestData.SlicePitch * z;
+            done += piece;
+        }
+    }
 
-            const BYTE* srcSlice = reinterpret_cast<const BYTE*>(vertexSubResourceData.pData) + vertexSubResourceData.SlicePitch * z;
+    void Graphics::SubmitUploads() noexcept
+    {
+        if (!copyOpen)
+            return;
 
-            for (uint32 y = 0; y < numRows; ++y)
-                memcpy(destSlice + DestData.RowPitch * y,
-                    srcSlice + vertexSubResourceData.RowPitch * y,
-                    static_cast<size_t>(rowSizesInBytes));
-        }
+        PROFILE_ZONE("SubmitUploads");
 
-        bufferUpload->Unmap(0, nullptr);
+        copyList->Close();
+        ID3D12CommandList* cmdsLists[] { copyList };
+        copyQueue->ExecuteCommandLists(static_cast<uint32>(countof(cmdsLists)), cmdsLists);
 
-        D3D12_RESOURCE_BARRIER barrier {
-            .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-            .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-            .Transition {
-                .pResource = bufferGPU,
-                .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-                .StateBefore = D3D12_RESOURCE_STATE_COMMON,
-                .StateAfter = D3D12_RESOURCE_STATE_COPY_DEST,
-            },
-        };
-        commandList->ResourceBarrier(1, &barrier);
+        uint64 batch = copyBatches.End();
+        uploads.Close(batch);
 
-        commandList->CopyBufferRegion(
-            bufferGPU,
-            0,
-            bufferUpload,
-            layouts.Offset,
-            layouts.Footprint.Width);
-
-        barrier = {
-            .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-            .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-            .Transition {
-                .pResource = bufferGPU,
-                .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-                .StateBefore = D3D12_RESOURCE_STATE_COPY_DEST,
-                .StateAfter = D3D12_RESOURCE_STATE_GENERIC_READ,
-            }
-        };
-        commandList->ResourceBarrier(1, &barrier);
+        // work submitted to the direct queue from now on runs after the copies
+        commandQueue->Wait(copyFence.Handle(), batch);
+        copyOpen = false;
     }
 
     void Graphics::Present() noexcept
     {
-        D3D12_RESOURCE_BARRIER barrier {
-            .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-            .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
-            .Transition {
-                .pResource = renderTargets[backBufferIndex],
-                .Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
-                .StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET,
-                .StateAfter = D3D12_RESOURCE_STATE_PRESENT,
-            },
-        };
+        PROFILE_ZONE("Present");
 
-        commandList->ResourceBarrier(1, &barrier);
+        states.Require(renderTargets[backBufferIndex], D3D12_RESOURCE_STATE_PRESENT);
+        FlushBarriers();
 
-        SubmitCommands();
+        commandList->Close();
+        ID3D12CommandList* cmdsLists[] { commandList };
+        commandQueue->ExecuteCommandLists(static_cast<uint32>(countof(cmdsLists)), cmdsLists);
+
+        // the slot's fence value; the next frame starts recording right away
+        frames.End();
 
         swapChain->Present(vSync, 0);
         backBufferIndex = (backBufferIndex + 1) % backBufferCount;
     }
-}
\ No newline at end of file
+}
+
+#elif __linux__
+
+namespace WXE::Soft
+{
+    // blends two 0x00RRGGBB pixels by w/256, red and blue in one multiply
+    static inline uint32 Lerp(const uint32 a, const uint32 b, const uint32 w) noexcept
+    {
+        uint32 rb = ((a & 0xFF00FF) * (256 - w) + (b & 0xFF00FF) * w) >> 8;
+        uint32 g = ((a & 0x00FF00) * (256 - w) + (b & 0x00FF00) * w) >> 8;
+        return (rb & 0xFF00FF) | (g & 0x00FF00);
+    }
+
+    Graphics::Graphics() noexcept :
+        window{ nullptr },
+        jobs{ nullptr },
+        width{},
+        height{},
+        presentable{}
+    {
+        backBufferCount = 2;
+        antialiasing = 1;
+        quality = 0;
+        vSync = false;
+        renderScale = 1.0f;
+
+        ZeroMemory(bgColor, sizeof(bgColor));
+        ZeroMemory(&viewport, sizeof(viewport));
+        ZeroMemory(&scissorRect, sizeof(scissorRect));
+    }
+
+    Graphics::~Graphics()
+    {
+    }
+
+    void Graphics::Initialize(Window* window, JobSystem* jobs)
+    {
+        this->window = window;
+        this->jobs = jobs;
+
+        uint32 color { window->Color() };
+        bgColor[0] = ((color >> 16) & 0xFF) / 255.0f;
+        bgColor[1] = ((color >> 8) & 0xFF) / 255.0f;
+        bgColor[2] = (color & 0xFF) / 255.0f;
+        bgColor[3] = 1.0f;
+
+        // without a display the frames are still rendered, offscreen
+        presentable = framebuffer.Initialize(window, window->Width(), window->Height());
+
+        width = window->Width();
+        height = window->Height();
+        Resize(width, height);
+    }
+
+    void Graphics::Resize(const uint32 width, const uint32 height)
+    {
+        uint32 renderWidth = Scaled(width);
+        uint32 renderHeight = Scaled(height);
+
+        rasterizer.Resize(renderWidth, renderHeight);
+
+        // a scale change leaves the framebuffer alone
+        if (presentable && (width != this->width || height != this->height))
+            presentable = framebuffer.Resize(width, height);
+
+        this->width = width;
+        this->height = height;
+
+        viewport.TopLeftX = {};
+        viewport.TopLeftY = {};
+        viewport.Width = static_cast<float>(renderWidth);
+        viewport.Height = static_cast<float>(renderHeight);
+        viewport.MinDepth = {};
+        viewport.MaxDepth = 1.0f;
+
+        scissorRect = { 0, 0, static_cast<int32>(renderWidth), static_cast<int32>(renderHeight) };
+    }
+
+    void Graphics::Clear()
+    {
+        PROFILE_ZONE("Clear");
+
+        uint32 windowWidth = window->Width();
+        uint32 windowHeight = window->Height();
+
+        // a resized window or a new render scale is picked up at the start of a frame
+        if (windowWidth != width || windowHeight != height
+            || Scaled(windowWidth) != rasterizer.Width() || Scaled(windowHeight) != rasterizer.Height())
+            Resize(windowWidth, windowHeight);
+
+        uint32 rgb = (uint32(bgColor[0] * 255.0f + 0.5f) << 16)
+            | (uint32(bgColor[1] * 255.0f + 0.5f) << 8)
+            | uint32(bgColor[2] * 255.0f + 0.5f);
+
+        rasterizer.Clear(rgb, 1.0f);
+    }
+
+    void Graphics::Allocate(const uint32 sizeInBytes, Buffer** resource) const
+    {
+        *resource = new Buffer(sizeInBytes);
+    }
+
+    void Graphics::Copy(const void* vertices, const uint32 sizeInBytes, Buffer* bufferCPU) const noexcept
+    {
+        memcpy(bufferCPU->Data(), vertices, sizeInBytes < bufferCPU->Size() ? sizeInBytes : bufferCPU->Size());
+    }
+
+    void Graphics::Draw(const Buffer* vertices, const uint32 stride, const uint32 count)
+    {
+        uint32 available = stride ? vertices->Size() / stride : 0;
+        rasterizer.Draw(vertices->Data(), stride, count < available ? count : available, viewport, scissorRect);
+    }
+
+    void Graphics::Upscale(uint32* target, const uint32 targetPitch) noexcept
+    {
+        PROFILE_ZONE("Upscale");
+
+        const uint32* source = rasterizer.Pixels();
+        const uint32 sourcePitch = rasterizer.Pitch();
+        const uint32 sourceWidth = rasterizer.Width();
+        const uint32 sourceHeight = rasterizer.Height();
+
+        // -----------------------------------------------
+        // Pixel centers line up: x maps to (x + 0.5) *
+        // source / target - 0.5. Per column the source
+        // index and the 8-bit weight of its right neighbor
+        // are worked out once and shared by every row.
+        // -----------------------------------------------
+
+        columns.resize(width);
+
+        for (uint32 x = 0; x < width; ++x)
+        {
+            float fx = (x + 0.5f) * sourceWidth / width - 0.5f;
+            uint32 ix = (fx > 0.0f) ? static_cast<uint32>(fx) : 0;
+            uint32 wx = (fx > 0.0f) ? static_cast<uint32>((fx - ix) * 256.0f) : 0;
+
+            if (ix >= sourceWidth - 1)
+            {
+                ix = sourceWidth - 1;
+                wx = 0;
+            }
+
+            columns[x] = (ix << 8) | wx;
+        }
+
+        auto rows = [&](uint32 begin, uint32 end)
+        {
+            for (uint32 y = begin; y < end; ++y)
+            {
+                float fy = (y + 0.5f) * sourceHeight / height - 0.5f;
+                uint32 iy = (fy > 0.0f) ? static_cast<uint32>(fy) : 0;
+                uint32 wy = (fy > 0.0f) ? static_cast<uint32>((fy - iy) * 256.0f) : 0;
+
+                if (iy >= sourceHeight - 1)
+                {
+                    iy = sourceHeight - 1;
+                    wy = 0;
+                }
+
+                const uint32* top = source + size_t(iy) * sourcePitch;
+                const uint32* bottom = wy ? top + sourcePitch : top;
+                uint32* out = target + size_t(y) * targetPitch;
+
+                for (uint32 x = 0; x < width; ++x)
+                {
+                    uint32 ix = columns[x] >> 8;
+                    uint32 wx = columns[x] & 0xFF;
+                    uint32 next = wx ? ix + 1 : ix;
+
+                    out[x] = Lerp(Lerp(top[ix], top[next], wx), Lerp(bottom[ix], bottom[next], wx), wy);
+                }
+            }
+        };
+
+        if (jobs)
+            jobs->ParallelFor(height, 16, rows);
+        else
+            rows(0, height);
+    }
+
+    void Graphics::Present() noexcept
+    {
+        PROFILE_ZONE("Present");
+
+        if (presentable && framebuffer.Width() == width && framebuffer.Height() == height)
+        {
+            if (rasterizer.Width() == width && rasterizer.Height() == height)
+            {
+                // tiles are written straight into the buffer being presented
+                rasterizer.Flush(jobs, framebuffer.Pixels(), framebuffer.Pitch());
+            }
+            else
+            {
+                rasterizer.Flush(jobs);
+                Upscale(framebuffer.Pixels(), framebuffer.Pitch());
+            }
+
+            framebuffer.Present();
+        }
+        else
+        {
+            // offscreen there is no one to upscale for
+            rasterizer.Flush(jobs);
+        }
+    }
+}
+
+#endif
\ No newline at end of file
@@ -2,10 +2,16 @@
 #define GRAPHICS_H
 
 #include "Types.h"
+#include "FrameRing.h"
+#include "HeapAllocator.h"
+#include "UploadRing.h"
+#include "ResourceStates.h"
 
 #ifdef _WIN32
 	#include "Window.h"
+	#include "JobSystem.h"
 	#include <D3DCompiler.h>
+	#include <vector>
 	#include <dxgi1_6.h>
 	#include <d3d12.h>
 	
@@ -14,11 +20,27 @@
 	#pragma comment(lib, "d3d12.lib")
 	using Window = WXE::Windows::Window;
 
+	enum AllocationType { GPU, UPLOAD };
+#elif __linux__
+	#include "Window.h"
+	#include "Framebuffer.h"
+	#include "Rasterizer.h"
+	#include "JobSystem.h"
+	#include <vector>
+	using Window = WXE::Linux::Window;
+
 	enum AllocationType { GPU, UPLOAD };
 #endif
 
 namespace WXE
 {
+	// ---------------------------------------------------
+	// Viewport and scissor cover renderScale of the window
+	// on each axis; the backends upscale that region to
+	// the full back buffer when they present. A new scale
+	// is picked up by the next Clear().
+	// ---------------------------------------------------
+
 	class GraphicsDesc
 	{
 	protected:
@@ -27,13 +49,21 @@ namespace WXE
 		uint32   quality;
 		bool     vSync;
 		float    bgColor[4];
+		float    renderScale;
 		Rect     scissorRect;
 		ViewPort viewport;
 
+		uint32 Scaled(const int32 size) const noexcept;
+
 	public:
 		uint32 Antialiasing() const noexcept;
 		uint32 Quality() const noexcept;
 		void VSync(const bool state) noexcept;
+
+		float Scale() const noexcept;
+		void Scale(const float scale) noexcept;
+		uint32 RenderWidth() const noexcept;
+		uint32 RenderHeight() const noexcept;
 	};
 
 	inline uint32 GraphicsDesc::Antialiasing() const noexcept
@@ -44,13 +74,105 @@ namespace WXE
 
 	inline void GraphicsDesc::VSync(const bool state) noexcept
 	{ vSync = state; }
+
+	inline float GraphicsDesc::Scale() const noexcept
+	{ return renderScale; }
+
+	inline void GraphicsDesc::Scale(const float scale) noexcept
+	{ renderScale = (scale > 1.0f) ? 1.0f : (scale < 0.1f ? 0.1f : scale); }
+
+	// size of the region rendered to this frame
+	inline uint32 GraphicsDesc::RenderWidth() const noexcept
+	{ return static_cast<uint32>(scissorRect.right - scissorRect.left); }
+
+	inline uint32 GraphicsDesc::RenderHeight() const noexcept
+	{ return static_cast<uint32>(scissorRect.bottom - scissorRect.top); }
+
+	inline uint32 GraphicsDesc::Scaled(const int32 size) const noexcept
+	{
+		uint32 scaled = static_cast<uint32>(size * renderScale + 0.5f);
+		return scaled ? scaled : 1;
+	}
 }
 
+#ifdef _WIN32
+
 namespace WXE::DX12
 {
+	// ---------------------------------------------------
+	// Fence on a command queue. The event waited on is
+	// created once and reused, not made per wait.
+	// ---------------------------------------------------
+
+	class QueueFence final : public FenceDevice
+	{
+	private:
+		ID3D12CommandQueue* queue;
+		ID3D12Fence* fence;
+		HANDLE event;
+		uint64 value;
+
+	public:
+		QueueFence() noexcept;
+		~QueueFence();
+
+		void Initialize(ID3D12Device4* device, ID3D12CommandQueue* queue);
+
+		uint64 Signal() noexcept override;
+		uint64 Completed() const noexcept override;
+		void Wait(const uint64 value) noexcept override;
+
+		ID3D12Fence* Handle() const noexcept;
+	};
+
+	inline ID3D12Fence* QueueFence::Handle() const noexcept
+	{ return fence; }
+
+	// ---------------------------------------------------
+	// Where the state tracker flushes to: the transitions
+	// of a batch go to the command list in one call.
+	// ---------------------------------------------------
+
+	class CommandBarriers final : public BarrierList
+	{
+	private:
+		ID3D12GraphicsCommandList* list;
+		std::vector<D3D12_RESOURCE_BARRIER> barriers;
+
+	public:
+		CommandBarriers() noexcept;
+
+		void Initialize(ID3D12GraphicsCommandList* list) noexcept;
+		void Barriers(const Transition* transitions, const uint32 count) noexcept override;
+	};
+
+	// ---------------------------------------------------
+	// Frames are recorded into per-frame allocators and
+	// Present() does not wait: Clear() waits only when the
+	// allocator it is about to reset still belongs to a
+	// frame on the GPU. ResetCommands()/SubmitCommands()
+	// use their own allocator and still wait for the queue.
+	//
+	// Upload() packs data into a mapped staging ring and
+	// records the copies on a copy queue; the batch goes
+	// out with the next Clear() or SubmitCommands(), and
+	// the direct queue waits for it on the GPU, not here.
+	// Buffers written this way start in COMMON state and
+	// need no barriers on either queue.
+	//
+	// Render targets and depth go through a state tracker:
+	// Require() the state a resource is needed in, and
+	// FlushBarriers() before the draw or copy that needs
+	// it. Clear() and Present() flush on their own.
+	// ---------------------------------------------------
+
 	class Graphics : public GraphicsDesc
 	{
+	public:
+		enum { FRAMES_IN_FLIGHT = 2, COPY_BATCHES = 3, STAGING_SIZE = 16 << 20 };
+
 	private:
+		Window* window;
 		ID3D12Device4* device;
 		IDXGIFactory6* factory;
 		IDXGISwapChain1* swapChain;
@@ -59,6 +181,7 @@ namespace WXE::DX12
 		ID3D12CommandQueue* commandQueue;
 		ID3D12GraphicsCommandList* commandList;
 		ID3D12CommandAllocator* commandListAlloc;
+		ID3D12CommandAllocator* frameAllocs[FRAMES_IN_FLIGHT];
 
 		ID3D12Resource** renderTargets;
 		ID3D12Resource* depthStencil;
@@ -66,17 +189,34 @@ namespace WXE::DX12
 		ID3D12DescriptorHeap* depthStencilHeap;
 		uint32					    rtDescriptorSize;
 
-		ID3D12Fence* fence;
-		uint64					    currentFence;
+		QueueFence fence;
+		FrameRing frames;
+
+		HeapPool heaps[2];
+
+		StateTracker states;
+		CommandBarriers barriers;
+
+		ID3D12CommandQueue* copyQueue;
+		ID3D12GraphicsCommandList* copyList;
+		ID3D12CommandAllocator* copyAllocs[COPY_BATCHES];
+		QueueFence copyFence;
+		FrameRing copyBatches;
+		ID3D12Resource* staging;
+		uint8* stagingData;
+		UploadRing uploads;
+		bool copyOpen;
+
+		JobSystem* jobs;
 
 		void LogHardwareInfo();
-		bool WaitCommandQueue() noexcept;
+		void WaitCommandQueue() noexcept;
 
 	public:
 		Graphics() noexcept;
 		~Graphics();
 
-		void Initialize(Window* window);
+		void Initialize(Window* window, JobSystem* jobs = nullptr);
 		void Clear(ID3D12PipelineState* pso);
 		void Present() noexcept;
 
@@ -88,24 +228,68 @@ namespace WXE::DX12
 
 		void Allocate(const uint32 type,
 			const uint32 sizeInBytes,
-			ID3D12Resource** resource) const;
+			ID3D12Resource** resource);
 
 		void Copy(const void* vertices,
 			const uint32 sizeInBytes,
 			ID3DBlob* bufferCPU) const noexcept;
 
-		void Copy(const void* vertices,
-				  const uint32 sizeInBytes,
-				  ID3D12Resource* bufferUpload,
-				  ID3D12Resource* bufferGPU) noexcept;
+		void Upload(const void* data,
+			const uint32 sizeInBytes,
+			ID3D12Resource* bufferGPU,
+			const uint64 offset = 0) noexcept;
+
+		void SubmitUploads() noexcept;
+
+		void Track(ID3D12Resource* resource,
+			const D3D12_RESOURCE_STATES state,
+			const uint32 subresources = 1);
+
+		void Untrack(ID3D12Resource* resource) noexcept;
+
+		void Require(ID3D12Resource* resource,
+			const D3D12_RESOURCE_STATES state,
+			const uint32 subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+
+		void FlushBarriers() noexcept;
 
 		ID3D12Device4* Device() const noexcept;
 		ID3D12GraphicsCommandList* CommandList() const noexcept;
+		const FrameRing& Frames() const noexcept;
+		const HeapPool& Heaps(const uint32 type) const noexcept;
+		const UploadRing& Uploads() const noexcept;
+		const StateTracker& States() const noexcept;
 	};
 
 	inline ID3D12Device4* Graphics::Device() const noexcept
 	{ return device; }
 
+	inline const FrameRing& Graphics::Frames() const noexcept
+	{ return frames; }
+
+	// buffer heaps of an AllocationType, for usage statistics
+	inline const HeapPool& Graphics::Heaps(const uint32 type) const noexcept
+	{ return heaps[type]; }
+
+	inline const UploadRing& Graphics::Uploads() const noexcept
+	{ return uploads; }
+
+	// barriers issued and elided, for statistics
+	inline const StateTracker& Graphics::States() const noexcept
+	{ return states; }
+
+	inline void Graphics::Track(ID3D12Resource* resource, const D3D12_RESOURCE_STATES state, const uint32 subresources)
+	{ states.Track(resource, state, subresources); }
+
+	inline void Graphics::Untrack(ID3D12Resource* resource) noexcept
+	{ states.Untrack(resource); }
+
+	inline void Graphics::Require(ID3D12Resource* resource, const D3D12_RESOURCE_STATES state, const uint32 subresource)
+	{ states.Require(resource, state, subresource); }
+
+	inline void Graphics::FlushBarriers() noexcept
+	{ states.Flush(&barriers); }
+
 	inline ID3D12GraphicsCommandList* Graphics::CommandList() const noexcept
 	{ return commandList; }
 
@@ -119,4 +303,119 @@ namespace WXE::DX12
 	{ CopyMemory(bufferCPU->GetBufferPointer(), vertices, sizeInBytes); }
 }
 
+#elif __linux__
+
+namespace WXE::Soft
+{
+	// ---------------------------------------------------
+	// Vertex memory of the software renderer. There is no
+	// GPU copy to keep, so the CPU blob is drawn from.
+	// ---------------------------------------------------
+
+	class Buffer final
+	{
+	private:
+		std::vector<uint8> data;
+
+	public:
+		Buffer(const uint32 sizeInBytes);
+
+		void* Data() noexcept;
+		const void* Data() const noexcept;
+		uint32 Size() const noexcept;
+		void Release() noexcept;
+	};
+
+	inline Buffer::Buffer(const uint32 sizeInBytes) : data(sizeInBytes)
+	{}
+
+	inline void* Buffer::Data() noexcept
+	{ return data.data(); }
+
+	inline const void* Buffer::Data() const noexcept
+	{ return data.data(); }
+
+	inline uint32 Buffer::Size() const noexcept
+	{ return static_cast<uint32>(data.size()); }
+
+	inline void Buffer::Release() noexcept
+	{ delete this; }
+
+	// ---------------------------------------------------
+	// CPU renderer for machines without a GPU. Draws go
+	// to the tiled rasterizer, which runs on the engine
+	// job system at Present(); the frame is then shown
+	// through the X11 framebuffer, or kept offscreen when
+	// there is no display to show it on. Below full scale
+	// the rasterizer works at the render size and the
+	// frame is stretched to the window, bilinearly.
+	// ---------------------------------------------------
+
+	class Graphics : public GraphicsDesc
+	{
+	private:
+		Window* window;
+		JobSystem* jobs;
+		Linux::Framebuffer framebuffer;
+		Rasterizer rasterizer;
+		std::vector<uint32> columns;
+		uint32 width;
+		uint32 height;
+		bool presentable;
+
+		void Resize(const uint32 width, const uint32 height);
+		void Upscale(uint32* target, const uint32 targetPitch) noexcept;
+
+	public:
+		Graphics() noexcept;
+		~Graphics();
+
+		void Initialize(Window* window, JobSystem* jobs = nullptr);
+		void Clear();
+		void Present() noexcept;
+
+		void ResetCommands() const noexcept;
+		void SubmitCommands() noexcept;
+
+		void Allocate(const uint32 sizeInBytes,
+			Buffer** resource) const;
+
+		void Copy(const void* vertices,
+			const uint32 sizeInBytes,
+			Buffer* bufferCPU) const noexcept;
+
+		void Draw(const Buffer* vertices,
+			const uint32 stride,
+			const uint32 count);
+
+		void Culling(const bool state) noexcept;
+		bool Complete(const _XEvent* event) noexcept;
+
+		const uint32* Pixels() const noexcept;
+		uint32 Pitch() const noexcept;
+	};
+
+	// draws are recorded as they come: nothing to open or close
+	inline void Graphics::ResetCommands() const noexcept
+	{}
+
+	inline void Graphics::SubmitCommands() noexcept
+	{}
+
+	inline void Graphics::Culling(const bool state) noexcept
+	{ rasterizer.Culling(state); }
+
+	inline bool Graphics::Complete(const _XEvent* event) noexcept
+	{ return framebuffer.Complete(event); }
+
+	// last rendered frame at render size, also when there is no display
+	inline const uint32* Graphics::Pixels() const noexcept
+	{ return rasterizer.Pixels(); }
+
+	inline uint32 Graphics::Pitch() const noexcept
+	{ return rasterizer.Pitch(); }
+}
+
+#endif
+
 #endif
\ No newline at end of file
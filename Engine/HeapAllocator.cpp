@@ -0,0 +1,485 @@
+#include "HeapAllocator.h"
+#include <bit>
+
+namespace WXE
+{
+	static inline uint64 AlignUp(const uint64 value, const uint64 alignment) noexcept
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	HeapAllocator::HeapAllocator(const uint64 sizeInBytes)
+	{
+		Initialize(sizeInBytes);
+	}
+
+	void HeapAllocator::Initialize(const uint64 sizeInBytes)
+	{
+		blocks.clear();
+		unused.clear();
+
+		for (auto& row : bins)
+			for (uint32& head : row)
+				head = NONE;
+
+		for (uint32& bitmap : slBitmap)
+			bitmap = 0;
+
+		flBitmap = 0;
+		first = NONE;
+		size = sizeInBytes / GRANULARITY;
+		used = 0;
+		count = 0;
+
+		if (size)
+		{
+			first = NewBlock();
+			blocks[first] = { 0, size, NONE, NONE, NONE, NONE, 1, true };
+			Insert(first);
+		}
+	}
+
+	// ---------------------------------------------------
+	// Size class of a free range: fl is the power of two,
+	// sl one of SL_COUNT linear steps inside it. Sizes
+	// below SL_COUNT units all land in the first row.
+	// ---------------------------------------------------
+
+	void HeapAllocator::Mapping(const uint64 size, uint32& fl, uint32& sl) noexcept
+	{
+		if (size < SL_COUNT)
+		{
+			fl = 0;
+			sl = static_cast<uint32>(size);
+		}
+		else
+		{
+			uint32 msb = static_cast<uint32>(std::bit_width(size)) - 1;
+			sl = static_cast<uint32>(size >> (msb - SL_BITS)) ^ SL_COUNT;
+			fl = msb - SL_BITS + 1;
+		}
+	}
+
+	uint32 HeapAllocator::NewBlock()
+	{
+		if (!unused.empty())
+		{
+			uint32 block = unused.back();
+			unused.pop_back();
+			return block;
+		}
+
+		blocks.push_back({});
+		return static_cast<uint32>(blocks.size() - 1);
+	}
+
+	void HeapAllocator::Recycle(const uint32 block)
+	{
+		unused.push_back(block);
+	}
+
+	void HeapAllocator::Insert(const uint32 block) noexcept
+	{
+		uint32 fl, sl;
+		Mapping(blocks[block].size, fl, sl);
+
+		uint32 head = bins[fl][sl];
+
+		blocks[block].free = true;
+		blocks[block].prevFree = NONE;
+		blocks[block].nextFree = head;
+
+		if (head != NONE)
+			blocks[head].prevFree = block;
+
+		bins[fl][sl] = block;
+		slBitmap[fl] |= 1u << sl;
+		flBitmap |= 1ull << fl;
+	}
+
+	void HeapAllocator::Remove(const uint32 block) noexcept
+	{
+		uint32 fl, sl;
+		Mapping(blocks[block].size, fl, sl);
+
+		uint32 prev = blocks[block].prevFree;
+		uint32 next = blocks[block].nextFree;
+
+		if (prev != NONE)
+			blocks[prev].nextFree = next;
+		else
+			bins[fl][sl] = next;
+
+		if (next != NONE)
+			blocks[next].prevFree = prev;
+
+		if (bins[fl][sl] == NONE)
+		{
+			slBitmap[fl] &= ~(1u << sl);
+
+			if (!slBitmap[fl])
+				flBitmap &= ~(1ull << fl);
+		}
+
+		blocks[block].free = false;
+	}
+
+	// first free block of a class that holds size, whatever its place in the bin
+	uint32 HeapAllocator::Find(uint64 size) const noexcept
+	{
+		// round up to the next class, so any block found is big enough
+		if (size >= SL_COUNT)
+			size += (1ull << (std::bit_width(size) - 1 - SL_BITS)) - 1;
+
+		uint32 fl, sl;
+		Mapping(size, fl, sl);
+
+		uint32 slMap = slBitmap[fl] & (~0u << sl);
+
+		if (!slMap)
+		{
+			uint64 flMap = (fl + 1 < FL_COUNT) ? flBitmap & (~0ull << (fl + 1)) : 0;
+
+			if (!flMap)
+				return NONE;
+
+			fl = static_cast<uint32>(std::countr_zero(flMap));
+			slMap = slBitmap[fl];
+		}
+
+		sl = static_cast<uint32>(std::countr_zero(slMap));
+		return bins[fl][sl];
+	}
+
+	// keeps size units in block, the rest goes to a new block right after it
+	uint32 HeapAllocator::Split(const uint32 block, const uint64 size)
+	{
+		uint32 rest = NewBlock();
+		uint32 next = blocks[block].next;
+
+		blocks[rest] = { blocks[block].offset + size, blocks[block].size - size, block, next, NONE, NONE, 1, false };
+
+		if (next != NONE)
+			blocks[next].prev = rest;
+
+		blocks[block].next = rest;
+		blocks[block].size = size;
+		return rest;
+	}
+
+	uint32 HeapAllocator::Allocate(const uint64 sizeInBytes, const uint64 alignment)
+	{
+		uint64 units = AlignUp(sizeInBytes ? sizeInBytes : 1, GRANULARITY) / GRANULARITY;
+		uint64 align = (alignment > GRANULARITY) ? AlignUp(alignment, GRANULARITY) / GRANULARITY : 1;
+
+		// a coarser alignment needs room to slide the start forward
+		uint32 block = Find(units + align - 1);
+
+		if (block == NONE)
+			return NONE;
+
+		Remove(block);
+
+		uint64 pad = AlignUp(blocks[block].offset, align) - blocks[block].offset;
+
+		if (pad)
+		{
+			uint32 aligned = Split(block, pad);
+			Insert(block);
+			block = aligned;
+		}
+
+		if (blocks[block].size > units)
+			Insert(Split(block, units));
+
+		blocks[block].alignment = static_cast<uint32>(align);
+		used += units;
+		count++;
+
+		return block;
+	}
+
+	void HeapAllocator::Free(uint32 block)
+	{
+		used -= blocks[block].size;
+		count--;
+
+		// the lower block of a merged pair is the one kept
+		uint32 prev = blocks[block].prev;
+
+		if (prev != NONE && blocks[prev].free)
+		{
+			Remove(prev);
+			blocks[prev].size += blocks[block].size;
+			blocks[prev].next = blocks[block].next;
+
+			if (blocks[block].next != NONE)
+				blocks[blocks[block].next].prev = prev;
+
+			Recycle(block);
+			block = prev;
+		}
+
+		uint32 next = blocks[block].next;
+
+		if (next != NONE && blocks[next].free)
+		{
+			Remove(next);
+			blocks[block].size += blocks[next].size;
+			blocks[block].next = blocks[next].next;
+
+			if (blocks[next].next != NONE)
+				blocks[blocks[next].next].prev = block;
+
+			Recycle(next);
+		}
+
+		Insert(block);
+	}
+
+	// ---------------------------------------------------
+	// Defragmentation hook: walks the heap in address
+	// order and slides every allocation that follows a
+	// free range down into it, as far as its alignment
+	// allows. move() does the copy (ranges may overlap)
+	// and rebinds the resource; block handles stay valid,
+	// only their offsets change. Returns blocks moved.
+	// ---------------------------------------------------
+
+	uint32 HeapAllocator::Compact(const MoveProc& move)
+	{
+		uint32 moved {};
+
+		for (uint32 block = first; block != NONE; block = blocks[block].next)
+		{
+			uint32 hole = blocks[block].prev;
+
+			if (blocks[block].free || hole == NONE || !blocks[hole].free)
+				continue;
+
+			uint64 from = blocks[block].offset;
+			uint64 to = AlignUp(blocks[hole].offset, blocks[block].alignment);
+			uint64 length = blocks[block].size;
+
+			if (to >= from || !move(block, from * GRANULARITY, to * GRANULARITY, length * GRANULARITY))
+				continue;
+
+			uint64 pad = to - blocks[hole].offset;
+			uint64 gap = from - to;
+			uint32 tail;
+
+			Remove(hole);
+			blocks[block].offset = to;
+
+			if (pad)
+			{
+				// alignment leaves the front of the hole where it was
+				blocks[hole].size = pad;
+				Insert(hole);
+
+				tail = Split(block, length);
+				blocks[tail].size = gap;
+			}
+			else
+			{
+				// the hole moves whole to the other side of the block
+				uint32 before = blocks[hole].prev;
+				uint32 after = blocks[block].next;
+
+				blocks[block].prev = before;
+
+				if (before != NONE)
+					blocks[before].next = block;
+				else
+					first = block;
+
+				blocks[hole].offset = to + length;
+				blocks[hole].size = gap;
+				blocks[hole].prev = block;
+				blocks[hole].next = after;
+
+				if (after != NONE)
+					blocks[after].prev = hole;
+
+				blocks[block].next = hole;
+				tail = hole;
+			}
+
+			uint32 next = blocks[tail].next;
+
+			if (next != NONE && blocks[next].free)
+			{
+				Remove(next);
+				blocks[tail].size += blocks[next].size;
+				blocks[tail].next = blocks[next].next;
+
+				if (blocks[next].next != NONE)
+					blocks[blocks[next].next].prev = tail;
+
+				Recycle(next);
+			}
+
+			Insert(tail);
+			moved++;
+		}
+
+		return moved;
+	}
+
+	uint64 HeapAllocator::LargestFree() const noexcept
+	{
+		if (!flBitmap)
+			return 0;
+
+		// the highest bin holds the largest range, but not in any order
+		uint32 fl = 63 - static_cast<uint32>(std::countl_zero(flBitmap));
+		uint32 sl = 31 - static_cast<uint32>(std::countl_zero(slBitmap[fl]));
+		uint64 largest {};
+
+		for (uint32 block = bins[fl][sl]; block != NONE; block = blocks[block].nextFree)
+			largest = (blocks[block].size > largest) ? blocks[block].size : largest;
+
+		return largest * GRANULARITY;
+	}
+
+	// share of the free space outside the largest free range: 0 is one hole, near 1 is dust
+	double HeapAllocator::Fragmentation() const noexcept
+	{
+		uint64 free = size - used;
+		return free ? 1.0 - double(LargestFree() / GRANULARITY) / free : 0.0;
+	}
+
+	// ---------------------------------------------------
+
+	HeapPool::HeapPool() noexcept :
+		heapSize{ HEAP_SIZE },
+		reserved{}
+	{
+	}
+
+	HeapPool::~HeapPool() noexcept
+	{
+		Release();
+	}
+
+	void HeapPool::Initialize(const CreateProc& create, const DestroyProc& destroy, const uint64 heapSize)
+	{
+		Release();
+
+		this->create = create;
+		this->destroy = destroy;
+		this->heapSize = heapSize;
+	}
+
+	// ranges still out point into heaps that are gone after this
+	void HeapPool::Release() noexcept
+	{
+		for (Heap& heap : heaps)
+		{
+			if (heap.handle)
+				destroy(heap.handle);
+		}
+
+		heaps.clear();
+		reserved = 0;
+	}
+
+	bool HeapPool::Allocate(const uint64 sizeInBytes, const uint64 alignment, HeapRange* range)
+	{
+		bool dedicated = sizeInBytes > heapSize;
+		uint32 index = 0;
+		uint32 block = HeapAllocator::NONE;
+
+		if (!dedicated)
+		{
+			for (; index < heaps.size(); ++index)
+			{
+				Heap& heap = heaps[index];
+
+				if (heap.handle && !heap.dedicated)
+				{
+					block = heap.allocator.Allocate(sizeInBytes, alignment);
+
+					if (block != HeapAllocator::NONE)
+						break;
+				}
+			}
+		}
+
+		if (block == HeapAllocator::NONE)
+		{
+			uint64 granularity = (alignment > HeapAllocator::GRANULARITY) ? alignment : HeapAllocator::GRANULARITY;
+			uint64 reserve = dedicated ? AlignUp(sizeInBytes, granularity) : heapSize;
+			void* handle = create(reserve);
+
+			if (!handle)
+				return false;
+
+			// slots of released dedicated heaps are reused
+			for (index = 0; index < heaps.size() && heaps[index].handle; ++index);
+
+			if (index == heaps.size())
+				heaps.push_back({});
+
+			Heap& heap = heaps[index];
+			heap.handle = handle;
+			heap.allocator.Initialize(reserve);
+			heap.dedicated = dedicated;
+			reserved += reserve;
+
+			// heap starts are aligned for anything placed in them
+			block = heap.allocator.Allocate(sizeInBytes, dedicated ? HeapAllocator::GRANULARITY : alignment);
+
+			if (block == HeapAllocator::NONE)
+				return false;
+		}
+
+		const HeapAllocator& allocator = heaps[index].allocator;
+
+		range->heap = heaps[index].handle;
+		range->offset = allocator.Offset(block);
+		range->size = sizeInBytes;
+		range->index = index;
+		range->block = block;
+
+		return true;
+	}
+
+	void HeapPool::Free(const HeapRange& range)
+	{
+		Heap& heap = heaps[range.index];
+		heap.allocator.Free(range.block);
+
+		if (heap.dedicated)
+		{
+			destroy(heap.handle);
+			reserved -= heap.allocator.Size();
+			heap.handle = nullptr;
+		}
+	}
+
+	uint32 HeapPool::Compact(const uint32 index, const HeapAllocator::MoveProc& move)
+	{
+		return heaps[index].handle ? heaps[index].allocator.Compact(move) : 0;
+	}
+
+	uint64 HeapPool::Used() const noexcept
+	{
+		uint64 total {};
+
+		for (const Heap& heap : heaps)
+			total += heap.handle ? heap.allocator.Used() : 0;
+
+		return total;
+	}
+
+	uint32 HeapPool::Allocations() const noexcept
+	{
+		uint32 total {};
+
+		for (const Heap& heap : heaps)
+			total += heap.handle ? heap.allocator.Allocations() : 0;
+
+		return total;
+	}
+}
@@ -0,0 +1,172 @@
+#ifndef HEAPALLOCATOR_H
+#define HEAPALLOCATOR_H
+
+#include "Types.h"
+#include <functional>
+#include <vector>
+
+namespace WXE
+{
+	// ---------------------------------------------------
+	// Two-level segregated fit (TLSF) over the offsets of
+	// one heap. It never touches the memory, so any API
+	// can place resources with it. Free ranges are binned
+	// by size class (power of two, then 16 linear steps)
+	// and two bitmaps find a non-empty bin in O(1); a free
+	// merges with its neighbors right away. Offsets and
+	// sizes are kept in GRANULARITY units, and alignment
+	// classes above that are served by splitting off the
+	// front of the range found.
+	// ---------------------------------------------------
+
+	class HeapAllocator final
+	{
+	public:
+		static constexpr uint64 GRANULARITY = 256;
+		static constexpr uint32 NONE = 0xFFFFFFFF;
+
+		// block, old offset, new offset, size (bytes); false keeps the block where it is
+		using MoveProc = std::function<bool(uint32, uint64, uint64, uint64)>;
+
+	private:
+		enum { SL_BITS = 4, SL_COUNT = 1 << SL_BITS, FL_COUNT = 64 };
+
+		struct Block
+		{
+			uint64 offset;
+			uint64 size;
+			uint32 prev;
+			uint32 next;
+			uint32 prevFree;
+			uint32 nextFree;
+			uint32 alignment;
+			bool free;
+		};
+
+		std::vector<Block> blocks;
+		std::vector<uint32> unused;
+		uint32 bins[FL_COUNT][SL_COUNT];
+		uint32 slBitmap[FL_COUNT];
+		uint64 flBitmap;
+		uint32 first;
+
+		uint64 size;
+		uint64 used;
+		uint32 count;
+
+		static void Mapping(const uint64 size, uint32& fl, uint32& sl) noexcept;
+		uint32 NewBlock();
+		void Recycle(const uint32 block);
+		void Insert(const uint32 block) noexcept;
+		void Remove(const uint32 block) noexcept;
+		uint32 Find(uint64 size) const noexcept;
+		uint32 Split(const uint32 block, const uint64 size);
+
+	public:
+		HeapAllocator(const uint64 sizeInBytes = 0);
+
+		void Initialize(const uint64 sizeInBytes);
+		uint32 Allocate(const uint64 sizeInBytes, const uint64 alignment = GRANULARITY);
+		void Free(const uint32 block);
+		uint32 Compact(const MoveProc& move);
+
+		uint64 Offset(const uint32 block) const noexcept;
+		uint64 Size() const noexcept;
+		uint64 Used() const noexcept;
+		uint32 Allocations() const noexcept;
+		uint64 LargestFree() const noexcept;
+		double Fragmentation() const noexcept;
+	};
+
+	inline uint64 HeapAllocator::Offset(const uint32 block) const noexcept
+	{ return blocks[block].offset * GRANULARITY; }
+
+	inline uint64 HeapAllocator::Size() const noexcept
+	{ return size * GRANULARITY; }
+
+	// bytes handed out, rounded up to the granularity
+	inline uint64 HeapAllocator::Used() const noexcept
+	{ return used * GRANULARITY; }
+
+	inline uint32 HeapAllocator::Allocations() const noexcept
+	{ return count; }
+
+	// ---------------------------------------------------
+	// Where a resource was placed: which heap of the pool,
+	// its native handle and the byte range inside it.
+	// ---------------------------------------------------
+
+	struct HeapRange
+	{
+		void* heap;
+		uint64 offset;
+		uint64 size;
+		uint32 index;
+		uint32 block;
+	};
+
+	// ---------------------------------------------------
+	// Heaps of one memory type. Requests go to the first
+	// heap with room, a new heap is reserved only when none
+	// has it, and a request larger than the heap size gets
+	// a dedicated heap that goes away with it. The create
+	// and destroy callbacks are the only API-specific part
+	// (ID3D12Heap, VkDeviceMemory...).
+	// ---------------------------------------------------
+
+	class HeapPool final
+	{
+	public:
+		static constexpr uint64 HEAP_SIZE = 64ull << 20;
+
+		using CreateProc = std::function<void*(uint64)>;
+		using DestroyProc = std::function<void(void*)>;
+
+	private:
+		struct Heap
+		{
+			void* handle;
+			HeapAllocator allocator;
+			bool dedicated;
+		};
+
+		std::vector<Heap> heaps;
+		CreateProc create;
+		DestroyProc destroy;
+		uint64 heapSize;
+		uint64 reserved;
+
+	public:
+		HeapPool() noexcept;
+		~HeapPool() noexcept;
+
+		HeapPool(const HeapPool&) = delete;
+		HeapPool& operator=(const HeapPool&) = delete;
+
+		void Initialize(const CreateProc& create, const DestroyProc& destroy, const uint64 heapSize = HEAP_SIZE);
+		void Release() noexcept;
+
+		bool Allocate(const uint64 sizeInBytes, const uint64 alignment, HeapRange* range);
+		void Free(const HeapRange& range);
+		uint32 Compact(const uint32 index, const HeapAllocator::MoveProc& move);
+
+		uint32 Heaps() const noexcept;
+		const HeapAllocator& Allocator(const uint32 index) const noexcept;
+		uint64 Reserved() const noexcept;
+		uint64 Used() const noexcept;
+		uint32 Allocations() const noexcept;
+	};
+
+	// heap slots, including released dedicated ones
+	inline uint32 HeapPool::Heaps() const noexcept
+	{ return static_cast<uint32>(heaps.size()); }
+
+	inline const HeapAllocator& HeapPool::Allocator(const uint32 index) const noexcept
+	{ return heaps[index].allocator; }
+
+	// bytes held by live heaps
+	inline uint64 HeapPool::Reserved() const noexcept
+	{ return reserved; }
+}
+
+#endif
@@ -1,44 +1,141 @@
 #include "Input.h"
 #include "KeyCodes.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+#endif
+
 namespace WXE::Inputs
 {
-	bool Keyboard::keys[MAX_KEYS] = {};
-	bool Keyboard::ctrl[MAX_KEYS] = {};
-	string Keyboard::text;
-
-	int32 Mouse::mouseX = {};
-	int32 Mouse::mouseY = {};
-	int16 Mouse::mouseWheel = {};
+#ifdef _WIN32
+	Input::Input() noexcept :
+		Keyboard{}, Mouse{}, frameEventCount{}, window{ GetActiveWindow() }
+	{
+		SetProp(window, "WXE.Input", this);
+		SetWindowLongPtr(window, GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(Input::InputProc));
+	}
 
-	Input::Input() noexcept
-	{ SetWindowLongPtr(GetActiveWindow(), GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(Input::InputProc)); }
+	Input::~Input() noexcept
+	{
+		SetWindowLongPtr(window, GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(Windows::Window::WinProc));
+		RemoveProp(window, "WXE.Input");
+	}
+#elif !defined(__linux__)
+	Input::Input() noexcept :
+		Keyboard{}, Mouse{}, frameEventCount{}
+	{
+	}
 
 	Input::~Input() noexcept
-	{ SetWindowLongPtr(GetActiveWindow(), GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(Windows::Window::WinProc)); }
+	{
+	}
+#endif
 
-	bool Keyboard::KeyPress(const uint8 vkcode) const noexcept
+	void Keyboard::Edges() noexcept
 	{
-		if (ctrl[vkcode])
+		// a key that went both down and up inside the frame
+		// counts as pressed and released, whatever its final state:
+		// pressed  = (keys & ~prev) | (down & up)
+		// released = (prev & ~keys) | (down & up)
+		// in 128-bit halves even with AVX2: Poll writes the sets 8 and 16
+		// bytes at a time, and 256-bit loads of them miss store forwarding
+
+	#if defined(__SSE2__) || defined(_M_X64)
+		for (uint32 i = 0; i < 4; i += 2)
 		{
-			if (KeyDown(vkcode))
-			{
-				ctrl[vkcode] = false;
-				return true;
-			}
+			__m128i cur  = _mm_load_si128(reinterpret_cast<const __m128i*>(keys.bits + i));
+			__m128i prev = _mm_load_si128(reinterpret_cast<const __m128i*>(prevKeys.bits + i));
+			__m128i both = _mm_and_si128(
+				_mm_load_si128(reinterpret_cast<const __m128i*>(downEvents.bits + i)),
+				_mm_load_si128(reinterpret_cast<const __m128i*>(upEvents.bits + i)));
+
+			_mm_store_si128(reinterpret_cast<__m128i*>(pressed.bits + i), _mm_or_si128(_mm_andnot_si128(prev, cur), both));
+			_mm_store_si128(reinterpret_cast<__m128i*>(released.bits + i), _mm_or_si128(_mm_andnot_si128(cur, prev), both));
+		}
+	#else
+		for (uint32 i = 0; i < 4; ++i)
+		{
+			uint64 both = downEvents.bits[i] & upEvents.bits[i];
+			pressed.bits[i] = (keys.bits[i] & ~prevKeys.bits[i]) | both;
+			released.bits[i] = (prevKeys.bits[i] & ~keys.bits[i]) | both;
 		}
-		else if (KeyUp(vkcode))
+	#endif
+	}
+
+	void Input::Poll() noexcept
+	{
+		prevKeys = keys;
+		downEvents = {};
+		upEvents = {};
+		mouseWheel = 0;
+		frameEventCount = 0;
+
+		InputEvent event;
+		while (queue.Pop(event))
 		{
-			ctrl[vkcode] = true;
+			if (frameEventCount < MAX_EVENTS)
+				frameEvents[frameEventCount++] = event;
+
+			switch (event.type)
+			{
+			case KEY_DOWN:
+				keys.Set(event.key);
+				downEvents.Set(event.key);
+				break;
+
+			case KEY_UP:
+				keys.Reset(event.key);
+				upEvents.Set(event.key);
+				break;
+
+			case MOUSE_MOVE:
+				mouseX = event.x;
+				mouseY = event.y;
+				break;
+
+			case MOUSE_WHEEL:
+				mouseWheel += event.wheel;
+				break;
+			}
 		}
 
-		return false;
+		Edges();
 	}
 
+	void Input::Save(InputFrame& frame) const noexcept
+	{
+		frame.keys = keys;
+		frame.down = downEvents;
+		frame.up = upEvents;
+		frame.mouseX = mouseX;
+		frame.mouseY = mouseY;
+		frame.mouseWheel = mouseWheel;
+		frame.text = text;
+	}
+
+	void Input::Load(const InputFrame& frame) noexcept
+	{
+		prevKeys = keys;
+		keys = frame.keys;
+		downEvents = frame.down;
+		upEvents = frame.up;
+		Edges();
+
+		mouseX = frame.mouseX;
+		mouseY = frame.mouseY;
+		mouseWheel = frame.mouseWheel;
+		text = frame.text;
+	}
+
+#ifdef _WIN32
     LRESULT CALLBACK Input::Reader(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
     {
-        if (msg == WM_CHAR)
+        Input* input = Owner(hWnd);
+
+        if (msg == WM_CHAR && input)
         {
+            string& text = input->text;
+
             switch (wParam)
             {
             case VK_BACK:
@@ -47,7 +144,7 @@ namespace WXE::Inputs
 
             case VK_TAB:
             case VK_RETURN:
-                SetWindowLongPtr(GetActiveWindow(), GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(Input::InputProc));
+                SetWindowLongPtr(hWnd, GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(Input::InputProc));
                 break;
 
             default:
@@ -63,53 +160,279 @@ namespace WXE::Inputs
 
     LRESULT CALLBACK Input::InputProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
     {
+        Input* input = Owner(hWnd);
+        Clock::time_point now = Clock::now();
+
+        if (input == nullptr)
+            return CallWindowProc(Windows::Window::WinProc, hWnd, msg, wParam, lParam);
+
         switch (msg)
         {
         case WM_KEYDOWN:
-            keys[wParam] = true;
+            input->Push({ now, KEY_DOWN, static_cast<uint8>(wParam) });
             return 0;
 
         case WM_KEYUP:
-            keys[wParam] = false;
+            input->Push({ now, KEY_UP, static_cast<uint8>(wParam) });
             return 0;
 
         case WM_MOUSEMOVE:
-            mouseX = GET_X_LPARAM(lParam);
-            mouseY = GET_Y_LPARAM(lParam);
+            input->Push({ now, MOUSE_MOVE, 0, 0, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) });
             return 0;
 
         case WM_MOUSEWHEEL:
-            mouseWheel = GET_WHEEL_DELTA_WPARAM(wParam);
+            input->Push({ now, MOUSE_WHEEL, 0, GET_WHEEL_DELTA_WPARAM(wParam) });
             return 0;
 
         case WM_LBUTTONDOWN:
         case WM_LBUTTONDBLCLK:
-            keys[VK_LBUTTON] = true;
+            input->Push({ now, KEY_DOWN, VK_LBUTTON });
             return 0;
 
         case WM_MBUTTONDOWN:
         case WM_MBUTTONDBLCLK:
-            keys[VK_MBUTTON] = true;
+            input->Push({ now, KEY_DOWN, VK_MBUTTON });
             return 0;
 
         case WM_RBUTTONDOWN:
         case WM_RBUTTONDBLCLK:
-            keys[VK_RBUTTON] = true;
+            input->Push({ now, KEY_DOWN, VK_RBUTTON });
             return 0;
 
         case WM_LBUTTONUP:
-            keys[VK_LBUTTON] = false;
+            input->Push({ now, KEY_UP, VK_LBUTTON });
             return 0;
 
         case WM_MBUTTONUP:
-            keys[VK_MBUTTON] = false;
+            input->Push({ now, KEY_UP, VK_MBUTTON });
             return 0;
 
         case WM_RBUTTONUP:
-            keys[VK_RBUTTON] = false;
+            input->Push({ now, KEY_UP, VK_RBUTTON });
             return 0;
         }
 
         return CallWindowProc(Windows::Window::WinProc, hWnd, msg, wParam, lParam);
     }
-}
\ No newline at end of file
+#endif
+}
+#ifdef __linux__
+
+#include <X11/Xlib.h>
+#include <X11/XKBlib.h>
+#include <X11/keysym.h>
+
+#if __has_include(<X11/extensions/XInput2.h>)
+	#include <X11/extensions/XInput2.h>
+	#define WXE_XINPUT2
+#endif
+
+namespace WXE::Inputs
+{
+	// X keysyms to the virtual key codes used by the Win32 backend;
+	// left and right modifiers collapse like WM_KEYDOWN reports them
+	static uint8 VirtualKey(const KeySym sym) noexcept
+	{
+		if (sym >= XK_a && sym <= XK_z) return static_cast<uint8>(VK_A + (sym - XK_a));
+		if (sym >= XK_A && sym <= XK_Z) return static_cast<uint8>(VK_A + (sym - XK_A));
+		if (sym >= XK_0 && sym <= XK_9) return static_cast<uint8>('0' + (sym - XK_0));
+		if (sym >= XK_F1 && sym <= XK_F24) return static_cast<uint8>(VK_F1 + (sym - XK_F1));
+		if (sym >= XK_KP_0 && sym <= XK_KP_9) return static_cast<uint8>(VK_NUMPAD0 + (sym - XK_KP_0));
+
+		switch (sym)
+		{
+		case XK_BackSpace:      return VK_BACK;
+		case XK_Tab:            return VK_TAB;
+		case XK_Clear:          return VK_CLEAR;
+		case XK_Return:         return VK_RETURN;
+		case XK_KP_Enter:       return VK_RETURN;
+		case XK_Shift_L:        return VK_SHIFT;
+		case XK_Shift_R:        return VK_SHIFT;
+		case XK_Control_L:      return VK_CONTROL;
+		case XK_Control_R:      return VK_CONTROL;
+		case XK_Alt_L:          return VK_MENU;
+		case XK_Alt_R:          return VK_MENU;
+		case XK_Pause:          return VK_PAUSE;
+		case XK_Caps_Lock:      return VK_CAPITAL;
+		case XK_Escape:         return VK_ESCAPE;
+		case XK_space:          return VK_SPACE;
+		case XK_Prior:          return VK_PRIOR;
+		case XK_Next:           return VK_NEXT;
+		case XK_End:            return VK_END;
+		case XK_Home:           return VK_HOME;
+		case XK_Left:           return VK_LEFT;
+		case XK_Up:             return VK_UP;
+		case XK_Right:          return VK_RIGHT;
+		case XK_Down:           return VK_DOWN;
+		case XK_Select:         return VK_SELECT;
+		case XK_Execute:        return VK_EXECUTE;
+		case XK_Print:          return VK_SNAPSHOT;
+		case XK_Insert:         return VK_INSERT;
+		case XK_Delete:         return VK_DELETE;
+		case XK_Help:           return VK_HELP;
+		case XK_Super_L:        return VK_LWIN;
+		case XK_Super_R:        return VK_RWIN;
+		case XK_Menu:           return VK_APPS;
+		case XK_KP_Multiply:    return VK_MULTIPLY;
+		case XK_KP_Add:         return VK_ADD;
+		case XK_KP_Separator:   return VK_SEPARATOR;
+		case XK_KP_Subtract:    return VK_SUBTRACT;
+		case XK_KP_Decimal:     return VK_DECIMAL;
+		case XK_KP_Divide:      return VK_DIVIDE;
+		case XK_Num_Lock:       return VK_NUMLOCK;
+		case XK_Scroll_Lock:    return VK_SCROLL;
+		}
+
+		return 0;
+	}
+
+	static void PushButton(Input& input, const Clock::time_point now, const uint8 type, const uint32 button) noexcept
+	{
+		switch (button)
+		{
+		case Button1: input.Push({ now, type, VK_LBUTTON }); break;
+		case Button2: input.Push({ now, type, VK_MBUTTON }); break;
+		case Button3: input.Push({ now, type, VK_RBUTTON }); break;
+		case 8:       input.Push({ now, type, VK_XBUTTON1 }); break;
+		case 9:       input.Push({ now, type, VK_XBUTTON2 }); break;
+
+		// the wheel comes as a press of buttons 4 and 5, one notch each
+		case Button4: if (type == KEY_DOWN) input.Push({ now, MOUSE_WHEEL, 0, 120 }); break;
+		case Button5: if (type == KEY_DOWN) input.Push({ now, MOUSE_WHEEL, 0, -120 }); break;
+		}
+	}
+
+	static void PushKey(Input& input, const Clock::time_point now, const uint8 type, const KeySym sym) noexcept
+	{
+		if (uint8 key = VirtualKey(sym))
+			input.Push({ now, type, key });
+	}
+
+	Input::Input(const Linux::Window* owner, [[maybe_unused]] const bool raw) noexcept :
+		Keyboard{}, Mouse{}, frameEventCount{}, display{}, window{}, xiOpcode{ -1 }, focused{}
+	{
+		if (owner == nullptr || owner->XDisplay() == nullptr)
+			return;
+
+		display = owner->XDisplay();
+		window = owner->Id();
+		focused = true;
+
+		// held keys report one press, not a release/press pair per repeat
+		XkbSetDetectableAutoRepeat(display, True, nullptr);
+
+	#ifdef WXE_XINPUT2
+		// raw events skip pointer acceleration and keyboard grabs;
+		// they are selected on the root window and come regardless
+		// of focus, so they are only used while the window has it
+		int32 event, error;
+		int32 major = 2, minor = 0;
+
+		if (raw && XQueryExtension(display, "XInputExtension", &xiOpcode, &event, &error)
+			&& XIQueryVersion(display, &major, &minor) == Success)
+		{
+			unsigned char mask[XIMaskLen(XI_LASTEVENT)] = {};
+			XISetMask(mask, XI_RawKeyPress);
+			XISetMask(mask, XI_RawKeyRelease);
+			XISetMask(mask, XI_RawButtonPress);
+			XISetMask(mask, XI_RawButtonRelease);
+
+			XIEventMask eventMask { XIAllMasterDevices, sizeof(mask), mask };
+			XISelectEvents(display, DefaultRootWindow(display), &eventMask, 1);
+		}
+		else
+		{
+			xiOpcode = -1;
+		}
+	#endif
+	}
+
+	Input::~Input() noexcept
+	{
+	#ifdef WXE_XINPUT2
+		if (display && xiOpcode != -1)
+		{
+			unsigned char mask[XIMaskLen(XI_LASTEVENT)] = {};
+			XIEventMask eventMask { XIAllMasterDevices, sizeof(mask), mask };
+			XISelectEvents(display, DefaultRootWindow(display), &eventMask, 1);
+		}
+	#endif
+
+		display = nullptr;
+		window = {};
+		xiOpcode = -1;
+	}
+
+	void Input::Release() noexcept
+	{
+		// keys held when focus is lost would never see their release
+		Clock::time_point now = Clock::now();
+
+		for (uint32 key = 0; key < MAX_KEYS; ++key)
+			if (keys.Test(uint8(key)))
+				Push({ now, KEY_UP, uint8(key) });
+	}
+
+	void Input::InputProc(XEvent* event) noexcept
+	{
+		Clock::time_point now = Clock::now();
+		bool raw = xiOpcode != -1;
+
+		switch (event->type)
+		{
+		case FocusIn:
+			focused = true;
+			break;
+
+		case FocusOut:
+			focused = false;
+			Release();
+			break;
+
+		case KeyPress:
+			if (!raw) PushKey(*this, now, KEY_DOWN, XLookupKeysym(&event->xkey, 0));
+			break;
+
+		case KeyRelease:
+			if (!raw) PushKey(*this, now, KEY_UP, XLookupKeysym(&event->xkey, 0));
+			break;
+
+		case ButtonPress:
+			if (!raw) PushButton(*this, now, KEY_DOWN, event->xbutton.button);
+			break;
+
+		case ButtonRelease:
+			if (!raw) PushButton(*this, now, KEY_UP, event->xbutton.button);
+			break;
+
+		case MotionNotify:
+			Push({ now, MOUSE_MOVE, 0, 0, event->xmotion.x, event->xmotion.y });
+			break;
+
+	#ifdef WXE_XINPUT2
+		case GenericEvent:
+			if (event->xcookie.extension != xiOpcode || !XGetEventData(display, &event->xcookie))
+				break;
+
+			if (focused)
+			{
+				const XIRawEvent* rawEvent = static_cast<const XIRawEvent*>(event->xcookie.data);
+				KeyCode code = static_cast<KeyCode>(rawEvent->detail);
+
+				switch (event->xcookie.evtype)
+				{
+				case XI_RawKeyPress:     PushKey(*this, now, KEY_DOWN, XkbKeycodeToKeysym(display, code, 0, 0)); break;
+				case XI_RawKeyRelease:   PushKey(*this, now, KEY_UP, XkbKeycodeToKeysym(display, code, 0, 0)); break;
+				case XI_RawButtonPress:  PushButton(*this, now, KEY_DOWN, rawEvent->detail); break;
+				case XI_RawButtonRelease: PushButton(*this, now, KEY_UP, rawEvent->detail); break;
+				}
+			}
+
+			XFreeEventData(display, &event->xcookie);
+			break;
+	#endif
+		}
+	}
+}
+
+#endif
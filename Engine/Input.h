@@ -2,46 +2,184 @@
 #define INPUT_H
 
 #include "Window.h"
+#include "Clock.h"
+#include <atomic>
 
 namespace WXE::Inputs
 {
-	enum { MAX_KEYS = 256 };
+	enum { MAX_KEYS = 256, MAX_EVENTS = 256 };
+
+	// ---------------------------------------------------
+	// 256-bit key set, one bit per virtual key code
+	// ---------------------------------------------------
+
+	struct alignas(32) KeySet
+	{
+		uint64 bits[MAX_KEYS / 64];
+
+		bool Test(const uint8 key) const noexcept;
+		void Set(const uint8 key) noexcept;
+		void Reset(const uint8 key) noexcept;
+		bool Any() const noexcept;
+	};
+
+	inline bool KeySet::Test(const uint8 key) const noexcept
+	{ return (bits[key >> 6] >> (key & 63)) & 1; }
+
+	inline void KeySet::Set(const uint8 key) noexcept
+	{ bits[key >> 6] |= uint64(1) << (key & 63); }
+
+	inline void KeySet::Reset(const uint8 key) noexcept
+	{ bits[key >> 6] &= ~(uint64(1) << (key & 63)); }
+
+	inline bool KeySet::Any() const noexcept
+	{ return (bits[0] | bits[1] | bits[2] | bits[3]) != 0; }
+
+	// snapshot of the input state, used to record and replay sessions;
+	// down and up hold the keys that went down or up during the frame
+	struct InputFrame
+	{
+		KeySet keys;
+		KeySet down;
+		KeySet up;
+		int32  mouseX;
+		int32  mouseY;
+		int16  mouseWheel;
+		string text;
+	};
+
+	enum InputEventTypes { KEY_DOWN, KEY_UP, MOUSE_MOVE, MOUSE_WHEEL };
+
+	// fields an event type does not use are left zero
+	struct InputEvent
+	{
+		Clock::time_point time {};
+		uint8 type {};
+		uint8 key {};
+		int16 wheel {};
+		int32 x {};
+		int32 y {};
+	};
+
+	// ---------------------------------------------------
+	// Single producer/single consumer ring: the window
+	// procedure (or an input thread) pushes, the engine
+	// drains it once per frame in Input::Poll.
+	// ---------------------------------------------------
+
+	class InputQueue final
+	{
+	public:
+		enum { CAPACITY = 1024 };
+
+	private:
+		InputEvent events[CAPACITY];
+		std::atomic<uint32> head;
+		std::atomic<uint32> tail;
+		std::atomic<uint32> dropped;
+
+	public:
+		InputQueue() noexcept;
+
+		bool Push(const InputEvent& event) noexcept;
+		bool Pop(InputEvent& event) noexcept;
+		uint32 Dropped() const noexcept;
+	};
+
+	inline InputQueue::InputQueue() noexcept : events{}, head{}, tail{}, dropped{}
+	{}
+
+	inline bool InputQueue::Push(const InputEvent& event) noexcept
+	{
+		uint32 t = tail.load(std::memory_order_relaxed);
+
+		if (t - head.load(std::memory_order_acquire) == CAPACITY)
+		{
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		events[t % CAPACITY] = event;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	inline bool InputQueue::Pop(InputEvent& event) noexcept
+	{
+		uint32 h = head.load(std::memory_order_relaxed);
+
+		if (h == tail.load(std::memory_order_acquire))
+			return false;
+
+		event = events[h % CAPACITY];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	inline uint32 InputQueue::Dropped() const noexcept
+	{ return dropped.load(std::memory_order_relaxed); }
+
+	// ---------------------------------------------------
+	// Keyboard and mouse answer from the snapshot built by
+	// the last Poll: keys holds this frame, prevKeys the
+	// one before, and the pressed/released masks are worked
+	// out once per frame, so every query is a pure read
+	// that worker jobs can make too. A press and release
+	// that happened between two polls still show up.
+	// ---------------------------------------------------
 
 	class Keyboard
 	{
 	protected:
-		static bool keys[MAX_KEYS];
-		static bool ctrl[MAX_KEYS];
-		static string text;
+		KeySet keys;
+		KeySet prevKeys;
+		KeySet downEvents;
+		KeySet upEvents;
+		KeySet pressed;
+		KeySet released;
+		string text;
+
+		void Edges() noexcept;
 
 	public:
 		bool KeyDown(const uint8 vkcode) const noexcept;
 		bool KeyUp(const uint8 vkcode) const noexcept;
 		bool KeyPress(const uint8 vkcode) const noexcept;
+		bool KeyReleased(const uint8 vkcode) const noexcept;
+		bool AnyKey() const noexcept;
 		
-		static const char* Text() noexcept;
+		const char* Text() const noexcept;
 	};
 
 	inline bool Keyboard::KeyDown(const uint8 vkcode) const noexcept
-	{ return keys[vkcode]; }
+	{ return keys.Test(vkcode); }
 
 	inline bool Keyboard::KeyUp(const uint8 vkcode) const noexcept
-	{ return !(keys[vkcode]); }
+	{ return !keys.Test(vkcode); }
+
+	inline bool Keyboard::KeyPress(const uint8 vkcode) const noexcept
+	{ return pressed.Test(vkcode); }
+
+	inline bool Keyboard::KeyReleased(const uint8 vkcode) const noexcept
+	{ return released.Test(vkcode); }
+
+	inline bool Keyboard::AnyKey() const noexcept
+	{ return keys.Any(); }
 
-	inline const char* Keyboard::Text() noexcept
+	inline const char* Keyboard::Text() const noexcept
 	{ return text.c_str(); }
 
 	class Mouse
 	{
 	protected:
-		static int16 mouseWheel;
-		static int32 mouseX;
-		static int32 mouseY;
+		int16 mouseWheel;
+		int32 mouseX;
+		int32 mouseY;
 
 	public:
 		int32 MouseX() const noexcept;
 		int32 MouseY() const noexcept;
-		int16 MouseWheel() noexcept;
+		int16 MouseWheel() const noexcept;
 	};
 
 	inline int32 Mouse::MouseX() const noexcept
@@ -50,30 +188,82 @@ namespace WXE::Inputs
 	inline int32 Mouse::MouseY() const noexcept
 	{ return mouseY; }
 
-	inline int16 Mouse::MouseWheel() noexcept
-	{
-		int16 val = mouseWheel;
-		mouseWheel = 0;
-		return val;
-	}
+	// sum of all wheel deltas received during the frame
+	inline int16 Mouse::MouseWheel() const noexcept
+	{ return mouseWheel; }
+
+	// ---------------------------------------------------
+	// Each engine owns its Input: headless instances are
+	// fed through Push or Load, a windowed one by the
+	// window procedure of the window it was created for.
+	// On Linux keys and buttons come as XInput2 raw events
+	// when the server has them, unless raw is false; the
+	// core events of the window are used otherwise.
+	// ---------------------------------------------------
 
 	class Input final : public Keyboard, public Mouse
 	{
+	private:
+		InputQueue queue;
+		InputEvent frameEvents[MAX_EVENTS];
+		uint32 frameEventCount;
+
+	#ifdef _WIN32
+		HWND window;
+
+		static Input* Owner(HWND hWnd) noexcept;
+	#elif __linux__
+		_XDisplay* display;
+		Linux::XWindow window;
+		int32 xiOpcode;
+		bool focused;
+
+		void Release() noexcept;
+	#endif
+
 	public:
+	#ifdef __linux__
+		explicit Input(const Linux::Window* owner = nullptr, const bool raw = true) noexcept;
+	#else
 		Input() noexcept;
+	#endif
 		~Input() noexcept;
 
-		void Read() const noexcept;
+		void Poll() noexcept;
+		void Save(InputFrame& frame) const noexcept;
+		void Load(const InputFrame& frame) noexcept;
+
+		bool Push(const InputEvent& event) noexcept;
+		const InputEvent* Events(uint32& count) const noexcept;
+
+	#ifdef _WIN32
+		void Read() noexcept;
 
 		static LRESULT CALLBACK Reader(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
 		static LRESULT CALLBACK InputProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
+	#elif __linux__
+		void InputProc(_XEvent* event) noexcept;
+	#endif
 	};
 
-	inline void Input::Read() const noexcept
+	inline bool Input::Push(const InputEvent& event) noexcept
+	{ return queue.Push(event); }
+
+	// events drained by the last Poll, in arrival order and timestamped
+	inline const InputEvent* Input::Events(uint32& count) const noexcept
+	{ count = frameEventCount; return frameEvents; }
+
+#ifdef _WIN32
+	inline void Input::Read() noexcept
 	{
 		text.clear();
-		SetWindowLongPtr(GetActiveWindow(), GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(Input::Reader));
+		SetWindowLongPtr(window, GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(Input::Reader));
 	}
+
+	// the Input a window procedure call belongs to
+	inline Input* Input::Owner(HWND hWnd) noexcept
+	{ return static_cast<Input*>(GetProp(hWnd, "WXE.Input")); }
+#endif
 }
 
 #ifdef _WIN32
@@ -0,0 +1,247 @@
+#include "JobSystem.h"
+using std::lock_guard;
+using std::unique_lock;
+using std::mutex;
+using std::thread;
+
+namespace WXE
+{
+    thread_local const JobSystem* JobSystem::workerOwner = nullptr;
+    thread_local uint32 JobSystem::workerIndex = 0;
+
+    JobSystem::JobSystem(const uint32 workers) :
+        queued{},
+        sleeping{},
+        running{ true }
+    {
+        uint32 threadCount = workers;
+
+        if (threadCount == 0)
+        {
+            uint32 cores = thread::hardware_concurrency();
+            threadCount = (cores > 1) ? cores - 1 : 0;
+        }
+
+        queueCount = threadCount + 1;
+        queues = new WorkQueue[queueCount];
+
+        threads.reserve(threadCount);
+        for (uint32 i = 1; i <= threadCount; ++i)
+            threads.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+
+    JobSystem::~JobSystem() noexcept
+    {
+        {
+            lock_guard<mutex> lock(sleepLock);
+            running = false;
+        }
+        wakeUp.notify_all();
+
+        for (thread& t : threads)
+            t.join();
+
+        delete[] queues;
+    }
+
+    void JobSystem::Push(Task&& task) noexcept
+    {
+        uint32 index = Index();
+
+        {
+            lock_guard<mutex> lock(queues[index].lock);
+            queues[index].tasks.push_back(std::move(task));
+        }
+
+        queued++;
+
+        // only pay for the wake-up when somebody is actually asleep
+        if (sleeping > 0)
+        {
+            { lock_guard<mutex> lock(sleepLock); }
+            wakeUp.notify_one();
+        }
+    }
+
+    bool JobSystem::Pop(const uint32 index, Task& task) noexcept
+    {
+        lock_guard<mutex> lock(queues[index].lock);
+
+        if (queues[index].tasks.empty())
+            return false;
+
+        task = std::move(queues[index].tasks.back());
+        queues[index].tasks.pop_back();
+        return true;
+    }
+
+    bool JobSystem::Steal(const uint32 index, Task& task) noexcept
+    {
+        for (uint32 i = 1; i < queueCount; ++i)
+        {
+            WorkQueue& victim = queues[(index + i) % queueCount];
+
+            unique_lock<mutex> lock(victim.lock, std::try_to_lock);
+
+            if (!lock.owns_lock() || victim.tasks.empty())
+                continue;
+
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+
+        return false;
+    }
+
+    bool JobSystem::RunOne(const uint32 index) noexcept
+    {
+        Task task;
+
+        if (!Pop(index, task) && !Steal(index, task))
+            return false;
+
+        queued--;
+
+        task.job();
+
+        if (task.counter)
+            Release(task.counter);
+
+        return true;
+    }
+
+    // ---------------------------------------------------
+    // A dependency is read under the park lock, and only
+    // taken to zero under it: a job is either parked
+    // before the last decrement, and released by it, or
+    // sees the counter already at zero.
+    // ---------------------------------------------------
+
+    bool JobSystem::Park(Task& task) noexcept
+    {
+        lock_guard<mutex> lock(parkLock);
+
+        if (task.dependency->load() > 0)
+        {
+            parked.push_back(std::move(task));
+            return true;
+        }
+
+        return false;
+    }
+
+    // ---------------------------------------------------
+    // Counts a job of the counter done. While others are
+    // left the counter cannot reach zero under us and is
+    // decremented without a lock. The last one is taken
+    // under the park lock; from then on the waiter may
+    // have destroyed the counter, so parked jobs are
+    // matched on the pointer alone.
+    // ---------------------------------------------------
+
+    void JobSystem::Release(JobCounter* counter) noexcept
+    {
+        uint32 count = counter->load();
+
+        while (count > 1)
+        {
+            if (counter->compare_exchange_weak(count, count - 1))
+                return;
+        }
+
+        std::vector<Task> ready;
+
+        {
+            lock_guard<mutex> lock(parkLock);
+
+            // more work may have been added to the counter since
+            if (counter->fetch_sub(1) != 1 || parked.empty())
+                return;
+
+            for (auto task = parked.begin(); task != parked.end();)
+            {
+                if (task->dependency == counter)
+                {
+                    ready.push_back(std::move(*task));
+                    task = parked.erase(task);
+                }
+                else
+                {
+                    ++task;
+                }
+            }
+        }
+
+        for (Task& task : ready)
+            Push(std::move(task));
+    }
+
+    void JobSystem::WorkerLoop(const uint32 index) noexcept
+    {
+        workerOwner = this;
+        workerIndex = index;
+
+        while (running)
+        {
+            if (RunOne(index))
+                continue;
+
+            unique_lock<mutex> lock(sleepLock);
+            sleeping++;
+            wakeUp.wait(lock, [this] { return queued > 0 || !running; });
+            sleeping--;
+        }
+    }
+
+    void JobSystem::Schedule(Job job, JobCounter* counter, JobCounter* dependency) noexcept
+    {
+        if (counter)
+            counter->fetch_add(1);
+
+        Task task{ std::move(job), counter, dependency };
+
+        if (dependency && Park(task))
+            return;
+
+        Push(std::move(task));
+    }
+
+    void JobSystem::Wait(JobCounter& counter) noexcept
+    {
+        uint32 index = Index();
+
+        while (counter.load() > 0)
+        {
+            if (!RunOne(index))
+                std::this_thread::yield();
+        }
+    }
+
+    void JobSystem::ParallelFor(const uint32 count, const uint32 grain,
+        const std::function<void(uint32 begin, uint32 end)>& func) noexcept
+    {
+        JobCounter counter{};
+        uint32 chunk = (grain > 0) ? grain : 1;
+
+        // recursive binary split: the upper half is left for thieves,
+        // the lower half keeps being divided by the current thread
+        std::function<void(uint32, uint32)> split;
+        split = [&](uint32 begin, uint32 end)
+        {
+            while (end - begin > chunk)
+            {
+                uint32 mid = begin + (end - begin) / 2;
+                Schedule([&split, mid, end] { split(mid, end); }, &counter);
+                end = mid;
+            }
+
+            func(begin, end);
+        };
+
+        if (count > 0)
+            split(0, count);
+
+        Wait(counter);
+    }
+}
\ No newline at end of file
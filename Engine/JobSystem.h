@@ -0,0 +1,95 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include "Types.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace WXE
+{
+	using Job = std::function<void()>;
+	using JobCounter = std::atomic<uint32>;
+
+	// ---------------------------------------------------
+	// Work-stealing scheduler: each worker owns a deque,
+	// pops its own jobs LIFO and steals from others FIFO.
+	// The thread that created the scheduler is worker 0
+	// and helps run jobs while it waits on a counter, as
+	// does any other thread calling in: threads that are
+	// not workers of this system use queue 0. A job whose
+	// dependency is not done is parked, not queued, and
+	// goes to the queues when the dependency reaches zero.
+	// ---------------------------------------------------
+
+	class JobSystem final
+	{
+	private:
+		struct Task
+		{
+			Job job;
+			JobCounter* counter;
+			JobCounter* dependency;
+		};
+
+		struct WorkQueue
+		{
+			std::mutex lock;
+			std::deque<Task> tasks;
+		};
+
+		std::vector<std::thread> threads;
+		WorkQueue* queues;
+		uint32 queueCount;
+
+		std::atomic<uint32> queued;
+		std::atomic<uint32> sleeping;
+		std::atomic<bool> running;
+		std::mutex sleepLock;
+		std::condition_variable wakeUp;
+
+		std::vector<Task> parked;
+		std::mutex parkLock;
+
+		static thread_local const JobSystem* workerOwner;
+		static thread_local uint32 workerIndex;
+
+		uint32 Index() const noexcept;
+		void Push(Task&& task) noexcept;
+		bool Park(Task& task) noexcept;
+		void Release(JobCounter* counter) noexcept;
+		bool Pop(const uint32 index, Task& task) noexcept;
+		bool Steal(const uint32 index, Task& task) noexcept;
+		bool RunOne(const uint32 index) noexcept;
+		void WorkerLoop(const uint32 index) noexcept;
+
+	public:
+		JobSystem(const uint32 workers = 0);
+		~JobSystem() noexcept;
+
+		uint32 Workers() const noexcept;
+
+		void Schedule(Job job, JobCounter* counter = nullptr) noexcept;
+		void Schedule(Job job, JobCounter* counter, JobCounter* dependency) noexcept;
+		void Wait(JobCounter& counter) noexcept;
+
+		void ParallelFor(const uint32 count, const uint32 grain,
+			const std::function<void(uint32 begin, uint32 end)>& func) noexcept;
+	};
+
+	inline uint32 JobSystem::Workers() const noexcept
+	{ return queueCount; }
+
+	// queue of the calling thread, if it is one of our workers
+	inline uint32 JobSystem::Index() const noexcept
+	{ return (workerOwner == this) ? workerIndex : 0; }
+
+	inline void JobSystem::Schedule(Job job, JobCounter* counter) noexcept
+	{ Schedule(std::move(job), counter, nullptr); }
+}
+
+#endif
\ No newline at end of file
@@ -6,8 +6,9 @@ namespace WXE
     Mesh::Mesh(const string name) noexcept :
         id{ name },
         vertexBufferCPU{ nullptr },
+    #if defined(_WIN32) || defined(WXE_VULKAN)
         vertexBufferGPU{ nullptr },
-        vertexBufferUpload{ nullptr },
+    #endif
         vertexByteStride{},
         vertexBufferSize{}
     {
@@ -15,11 +16,13 @@ namespace WXE
 
     Mesh::~Mesh() noexcept
     {
-        SafeRelease(vertexBufferUpload);
+    #if defined(_WIN32) || defined(WXE_VULKAN)
         SafeRelease(vertexBufferGPU);
+    #endif
         SafeRelease(vertexBufferCPU);
     }
 
+#ifdef _WIN32
     D3D12_VERTEX_BUFFER_VIEW* Mesh::VertexBufferView() noexcept
     {
         vertexBufferView = {
@@ -30,4 +33,5 @@ namespace WXE
 
         return &vertexBufferView;
     }
+#endif
 }
\ No newline at end of file
@@ -1,20 +1,32 @@
 #ifndef MESH_H
 #define MESH_H
 
-#include <d3d12.h>
 #include "Types.h"
 
+#ifdef _WIN32
+        #include <d3d12.h>
+#else
+        #include "VulkanGraphics.h"
+#endif
+
 namespace WXE
 {
         struct Mesh
         {
                 string id;
 
+#ifdef _WIN32
                 ID3DBlob* vertexBufferCPU;
 
-                ID3D12Resource* vertexBufferUpload;
                 ID3D12Resource* vertexBufferGPU;
                 D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
+#elif defined(WXE_VULKAN)
+                Vulkan::Buffer* vertexBufferCPU;
+
+                Vulkan::Buffer* vertexBufferGPU;
+#else
+                Soft::Buffer* vertexBufferCPU;
+#endif
 
                 uint32 vertexByteStride;
                 uint32 vertexBufferSize;
@@ -22,7 +34,9 @@ namespace WXE
                 Mesh(const string name) noexcept;
                 ~Mesh() noexcept;
 
+#ifdef _WIN32
                 D3D12_VERTEX_BUFFER_VIEW* VertexBufferView() noexcept;
+#endif
 	};
 }
 
@@ -0,0 +1,154 @@
+#include "Profiler.h"
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using std::format;
+using std::ofstream;
+using std::unique_ptr;
+using std::make_unique;
+using std::lock_guard;
+using std::mutex;
+using std::vector;
+
+namespace WXE
+{
+    struct ZoneRecord
+    {
+        const char* name;
+        uint64 begin;
+        uint64 end;
+    };
+
+    // single producer (the owning thread), read only by Stop()
+    // once the producer is known to be out of Record()
+    struct ZoneRing
+    {
+        ZoneRecord records[Profiler::RING_SIZE];
+        std::atomic<uint64> head;
+        std::atomic<bool> writing;
+        uint32 threadId;
+    };
+
+    static mutex ringsLock;
+    static vector<unique_ptr<ZoneRing>> rings;
+    static thread_local ZoneRing* threadRing = nullptr;
+
+    std::atomic<bool> Profiler::enabled = false;
+    uint64 Profiler::captureStart = {};
+
+    void Profiler::Start() noexcept
+    {
+        captureStart = Now();
+        enabled.store(true, std::memory_order_release);
+    }
+
+    void Profiler::Record(const char* name, const uint64 begin, const uint64 end) noexcept
+    {
+        if (!threadRing)
+        {
+            lock_guard<mutex> lock(ringsLock);
+            rings.push_back(make_unique<ZoneRing>());
+            threadRing = rings.back().get();
+            threadRing->head = 0;
+            threadRing->writing = false;
+            threadRing->threadId = static_cast<uint32>(rings.size());
+        }
+
+        // -----------------------------------------------
+        // The flag goes up before the capture is checked
+        // and Stop() clears the capture before it checks
+        // the flag: either this zone sees the capture over
+        // and writes nothing, or Stop() waits for it.
+        // -----------------------------------------------
+
+        threadRing->writing.store(true);
+
+        if (enabled.load())
+        {
+            uint64 head = threadRing->head.load(std::memory_order_relaxed);
+            threadRing->records[head % RING_SIZE] = { name, begin, end };
+            threadRing->head.store(head + 1, std::memory_order_relaxed);
+        }
+
+        threadRing->writing.store(false, std::memory_order_release);
+    }
+
+    // zone names are C strings from the code, quoted as JSON strings
+    static string Escape(const char* name)
+    {
+        string text;
+
+        for (const char* c = name; *c; ++c)
+        {
+            switch (*c)
+            {
+            case '"':  text += "\\\""; break;
+            case '\\': text += "\\\\"; break;
+            case '\n': text += "\\n"; break;
+            case '\t': text += "\\t"; break;
+            default:
+                if (static_cast<uint8>(*c) < 0x20)
+                    text += format("\\u{:04x}", static_cast<uint8>(*c));
+                else
+                    text += *c;
+            }
+        }
+
+        return text;
+    }
+
+    bool Profiler::Stop(const string_view fileName)
+    {
+        enabled.store(false);
+
+        {
+            // zones still being written are let finish, none start after
+            lock_guard<mutex> lock(ringsLock);
+
+            for (const auto& ring : rings)
+                while (ring->writing.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+        }
+
+        ofstream file { string(fileName) };
+        if (!file)
+            return false;
+
+        constexpr double toMicroseconds = 1e6 * Clock::period::num / Clock::period::den;
+
+        file << "{\"traceEvents\":[\n";
+
+        bool first = true;
+        lock_guard<mutex> lock(ringsLock);
+
+        for (const auto& ring : rings)
+        {
+            uint64 head = ring->head.load(std::memory_order_relaxed);
+
+            // a ring that wrapped keeps the last RING_SIZE zones
+            uint64 tail = (head > RING_SIZE) ? head - RING_SIZE : 0;
+
+            for (uint64 i = tail; i < head; ++i)
+            {
+                const ZoneRecord& zone = ring->records[i % RING_SIZE];
+
+                if (zone.begin < captureStart)
+                    continue;
+
+                file << format("{}{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                    first ? "" : ",\n", Escape(zone.name), ring->threadId,
+                    (zone.begin - captureStart) * toMicroseconds,
+                    (zone.end - zone.begin) * toMicroseconds);
+
+                first = false;
+            }
+        }
+
+        file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+        return true;
+    }
+}
\ No newline at end of file
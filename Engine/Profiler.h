@@ -0,0 +1,66 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Types.h"
+#include "Timer.h"
+#include <atomic>
+
+namespace WXE
+{
+	// ---------------------------------------------------
+	// CPU frame profiler: zones are recorded per thread in
+	// lock-free rings while a capture is running, then
+	// written out as Chrome/Perfetto trace JSON by Stop().
+	// ---------------------------------------------------
+
+	class Profiler final
+	{
+	private:
+		static std::atomic<bool> enabled;
+		static uint64 captureStart;
+
+	public:
+		enum { RING_SIZE = 16384 };
+
+		static void Start() noexcept;
+		static bool Stop(const string_view fileName);
+		static bool Enabled() noexcept;
+
+		static uint64 Now() noexcept;
+		static void Record(const char* name, const uint64 begin, const uint64 end) noexcept;
+	};
+
+	inline bool Profiler::Enabled() noexcept
+	{ return enabled.load(std::memory_order_relaxed); }
+
+	inline uint64 Profiler::Now() noexcept
+	{ return static_cast<uint64>(Clock::now().time_since_epoch().count()); }
+
+	class ProfileZone final
+	{
+	private:
+		const char* name;
+		uint64 begin;
+
+	public:
+		ProfileZone(const char* zoneName) noexcept;
+		~ProfileZone() noexcept;
+	};
+
+	inline ProfileZone::ProfileZone(const char* zoneName) noexcept
+		: name{ Profiler::Enabled() ? zoneName : nullptr }, begin{}
+	{ if (name) begin = Profiler::Now(); }
+
+	inline ProfileZone::~ProfileZone() noexcept
+	{ if (name) Profiler::Record(name, begin, Profiler::Now()); }
+}
+
+#ifndef WXE_NO_PROFILER
+	#define PROFILE_CONCAT_(a, b) a##b
+	#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+	#define PROFILE_ZONE(name) WXE::ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+	#define PROFILE_ZONE(name)
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,404 @@
+#include "Rasterizer.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define WXE_RASTER_SSE2
+#endif
+
+namespace WXE
+{
+	Rasterizer::Rasterizer() noexcept :
+		width{},
+		height{},
+		pitch{},
+		tilesX{},
+		tilesY{},
+		clearColor{},
+		clearDepth{ 1.0f },
+		clearPending{},
+		culling{ true }
+	{
+	}
+
+	void Rasterizer::Resize(const uint32 width, const uint32 height)
+	{
+		this->width = width;
+		this->height = height;
+
+		tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+		tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+		// whole tiles are allocated so that four-pixel steps
+		// never run past the end of a row
+		pitch = tilesX * TILE_SIZE;
+		color.assign(size_t(pitch) * tilesY * TILE_SIZE, 0);
+		depth.assign(size_t(pitch) * tilesY * TILE_SIZE, 1.0f);
+
+		bins.resize(size_t(tilesX) * tilesY);
+		for (std::vector<uint32>& bin : bins)
+			bin.clear();
+
+		triangles.clear();
+	}
+
+	void Rasterizer::Clear(const uint32 rgb, const float z) noexcept
+	{
+		clearColor = rgb;
+		clearDepth = z;
+		clearPending = true;
+
+		// whatever was drawn before is covered by the clear
+		for (std::vector<uint32>& bin : bins)
+			bin.clear();
+
+		triangles.clear();
+	}
+
+	void Rasterizer::Draw(const void* vertices, const uint32 stride, const uint32 count,
+		const ViewPort& viewport, const Rect& scissor)
+	{
+		const uint8* data = static_cast<const uint8*>(vertices);
+		Vertex v[3];
+
+		for (uint32 i = 0; i + 2 < count; i += 3)
+		{
+			for (uint32 k = 0; k < 3; ++k)
+				memcpy(&v[k], data + size_t(i + k) * stride, sizeof(Vertex));
+
+			size_t before = triangles.size();
+			Setup(v[0], v[1], v[2], viewport, scissor);
+
+			if (triangles.size() == before)
+				continue;
+
+			// bin by bounding box; tiles it only grazes are rejected when rendered
+			const Triangle& t = triangles.back();
+			uint32 index = static_cast<uint32>(before);
+
+			for (int32 ty = t.minY / TILE_SIZE; ty <= t.maxY / TILE_SIZE; ++ty)
+				for (int32 tx = t.minX / TILE_SIZE; tx <= t.maxX / TILE_SIZE; ++tx)
+					bins[size_t(ty) * tilesX + tx].push_back(index);
+		}
+	}
+
+	void Rasterizer::Setup(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+		const ViewPort& viewport, const Rect& scissor) noexcept
+	{
+		const Vertex* v[3] = { &v0, &v1, &v2 };
+		int64 X[3], Y[3];
+		double attr[3][4];
+
+		for (uint32 i = 0; i < 3; ++i)
+		{
+			// positions come in clip space with w = 1, as the default vertex shader emits them
+			double sx = viewport.TopLeftX + (v[i]->x + 1.0) * 0.5 * viewport.Width;
+			double sy = viewport.TopLeftY + (1.0 - v[i]->y) * 0.5 * viewport.Height;
+
+			// no clipping: triangles reaching past the guard band are dropped
+			if (!(std::fabs(sx) < double(GUARD_BAND) && std::fabs(sy) < double(GUARD_BAND)))
+				return;
+
+			X[i] = std::llround(sx * (1 << SUBPIXEL_BITS));
+			Y[i] = std::llround(sy * (1 << SUBPIXEL_BITS));
+
+			attr[i][0] = viewport.MinDepth + v[i]->z * (viewport.MaxDepth - viewport.MinDepth);
+			attr[i][1] = v[i]->r;
+			attr[i][2] = v[i]->g;
+			attr[i][3] = v[i]->b;
+		}
+
+		// positive area is clockwise on screen, the front face
+		int64 area = (X[1] - X[0]) * (Y[2] - Y[0]) - (Y[1] - Y[0]) * (X[2] - X[0]);
+
+		if (area == 0 || (area < 0 && culling))
+			return;
+
+		if (area < 0)
+		{
+			std::swap(X[1], X[2]);
+			std::swap(Y[1], Y[2]);
+			std::swap(attr[1], attr[2]);
+			area = -area;
+		}
+
+		Triangle t;
+
+		// E(P) = A * P.x + B * P.y + C is zero on the edge and positive inside
+		for (uint32 i = 0; i < 3; ++i)
+		{
+			uint32 j = (i + 1) % 3;
+			t.A[i] = Y[i] - Y[j];
+			t.B[i] = X[j] - X[i];
+			t.C[i] = -(t.A[i] * X[i] + t.B[i] * Y[i]);
+
+			// top-left rule: pixels centered on an edge belong to it only
+			// if it is a left edge or a top edge
+			if (!(t.A[i] > 0 || (t.A[i] == 0 && t.B[i] > 0)))
+				t.C[i] -= 1;
+		}
+
+		// pixel bounds from pixel centers (px * 16 + 8) inside the box
+		int64 minX = std::min({ X[0], X[1], X[2] });
+		int64 maxX = std::max({ X[0], X[1], X[2] });
+		int64 minY = std::min({ Y[0], Y[1], Y[2] });
+		int64 maxY = std::max({ Y[0], Y[1], Y[2] });
+		const int64 half = 1 << (SUBPIXEL_BITS - 1);
+
+		int64 left   = std::max<int64>({ -((half - minX) >> SUBPIXEL_BITS), scissor.left, 0 });
+		int64 top    = std::max<int64>({ -((half - minY) >> SUBPIXEL_BITS), scissor.top, 0 });
+		int64 right  = std::min<int64>({ (maxX - half) >> SUBPIXEL_BITS, scissor.right - 1, int64(width) - 1 });
+		int64 bottom = std::min<int64>({ (maxY - half) >> SUBPIXEL_BITS, scissor.bottom - 1, int64(height) - 1 });
+
+		if (left > right || top > bottom)
+			return;
+
+		t.minX = int32(left);
+		t.minY = int32(top);
+		t.maxX = int32(right);
+		t.maxY = int32(bottom);
+
+		// attributes are planes over pixel centers, anchored at pixel (0, 0):
+		// weight of v1 is E2 / area, weight of v2 is E0 / area
+		for (uint32 k = 0; k < 4; ++k)
+		{
+			double d1 = attr[1][k] - attr[0][k];
+			double d2 = attr[2][k] - attr[0][k];
+			double gx = (d1 * t.A[2] + d2 * t.A[0]) / area;
+			double gy = (d1 * t.B[2] + d2 * t.B[0]) / area;
+
+			t.planes[k].dx = gx * (1 << SUBPIXEL_BITS);
+			t.planes[k].dy = gy * (1 << SUBPIXEL_BITS);
+			t.planes[k].base = attr[0][k] + gx * double(half - X[0]) + gy * double(half - Y[0]);
+		}
+
+		triangles.push_back(t);
+	}
+
+	void Rasterizer::Render(const uint32 tile) noexcept
+	{
+		const int32 tx0 = int32(tile % tilesX) * TILE_SIZE;
+		const int32 ty0 = int32(tile / tilesX) * TILE_SIZE;
+		const int32 tx1 = std::min<int32>(tx0 + TILE_SIZE, width);
+		const int32 ty1 = std::min<int32>(ty0 + TILE_SIZE, height);
+		const int64 sub = 1 << SUBPIXEL_BITS;
+		const int64 half = sub / 2;
+
+		if (clearPending)
+		{
+			for (int32 y = ty0; y < ty0 + TILE_SIZE; ++y)
+			{
+				std::fill_n(color.data() + size_t(y) * pitch + tx0, TILE_SIZE, clearColor);
+				std::fill_n(depth.data() + size_t(y) * pitch + tx0, TILE_SIZE, clearDepth);
+			}
+		}
+
+		for (uint32 index : bins[tile])
+		{
+			const Triangle& t = triangles[index];
+
+			int32 x0 = std::max(t.minX, tx0);
+			int32 y0 = std::max(t.minY, ty0);
+			int32 x1 = std::min(t.maxX + 1, tx1);
+			int32 y1 = std::min(t.maxY + 1, ty1);
+
+			if (x0 >= x1 || y0 >= y1)
+				continue;
+
+			// four-pixel groups start on a multiple of four
+			int32 xs = x0 & ~3;
+
+			// an edge entirely outside rejects the tile, one entirely
+			// inside is left out; the rest fit in 32 bits in a tile
+			int32 e[3], stepX[3], stepY[3];
+			bool outside = false;
+
+			for (uint32 i = 0; i < 3 && !outside; ++i)
+			{
+				int64 ex = t.A[i] * sub * (x1 - 1 - x0);
+				int64 ey = t.B[i] * sub * (y1 - 1 - y0);
+				int64 e00 = t.A[i] * (x0 * sub + half) + t.B[i] * (y0 * sub + half) + t.C[i];
+				int64 lo = e00 + std::min<int64>(ex, 0) + std::min<int64>(ey, 0);
+				int64 hi = e00 + std::max<int64>(ex, 0) + std::max<int64>(ey, 0);
+
+				if (hi < 0)
+				{
+					outside = true;
+				}
+				else if (lo >= 0)
+				{
+					e[i] = stepX[i] = stepY[i] = 0;
+				}
+				else
+				{
+					e[i] = int32(e00 - t.A[i] * sub * (x0 - xs));
+					stepX[i] = int32(t.A[i] * sub);
+					stepY[i] = int32(t.B[i] * sub);
+				}
+			}
+
+			if (outside)
+				continue;
+
+			// planes re-anchored on the first group of the first row
+			float base[4], dx[4], dy[4];
+			for (uint32 k = 0; k < 4; ++k)
+			{
+				base[k] = float(t.planes[k].base + t.planes[k].dx * xs + t.planes[k].dy * y0);
+				dx[k] = float(t.planes[k].dx);
+				dy[k] = float(t.planes[k].dy);
+			}
+
+		#ifdef WXE_RASTER_SSE2
+			const __m128i lane = _mm_setr_epi32(0, 1, 2, 3);
+			const __m128 lanef = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+			const __m128i first = _mm_set1_epi32(x0 - 1);
+			const __m128i last = _mm_set1_epi32(x1);
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 scale = _mm_set1_ps(255.0f);
+
+			__m128i edge[3], edgeStep[3];
+			__m128 plane[4], planeStep[4];
+
+			for (uint32 i = 0; i < 3; ++i)
+			{
+				edge[i] = _mm_setr_epi32(e[i], e[i] + stepX[i], e[i] + 2 * stepX[i], e[i] + 3 * stepX[i]);
+				edgeStep[i] = _mm_set1_epi32(stepX[i] * 4);
+			}
+
+			for (uint32 k = 0; k < 4; ++k)
+			{
+				plane[k] = _mm_add_ps(_mm_set1_ps(base[k]), _mm_mul_ps(lanef, _mm_set1_ps(dx[k])));
+				planeStep[k] = _mm_set1_ps(dx[k] * 4.0f);
+			}
+
+			for (int32 y = y0; y < y1; ++y)
+			{
+				uint32* colorRow = color.data() + size_t(y) * pitch;
+				float* depthRow = depth.data() + size_t(y) * pitch;
+
+				__m128i e0 = edge[0], e1 = edge[1], e2 = edge[2];
+				__m128 z = plane[0], r = plane[1], g = plane[2], b = plane[3];
+
+				for (int32 x = xs; x < x1; x += 4)
+				{
+					__m128i px = _mm_add_epi32(_mm_set1_epi32(x), lane);
+					__m128i inside = _mm_and_si128(
+						_mm_cmpgt_epi32(_mm_or_si128(_mm_or_si128(e0, e1), e2), _mm_set1_epi32(-1)),
+						_mm_and_si128(_mm_cmpgt_epi32(px, first), _mm_cmplt_epi32(px, last)));
+
+					if (_mm_movemask_epi8(inside))
+					{
+						__m128 stored = _mm_load_ps(depthRow + x);
+						__m128 pass = _mm_and_ps(_mm_castsi128_ps(inside),
+							_mm_and_ps(_mm_cmplt_ps(z, stored),
+								_mm_and_ps(_mm_cmpge_ps(z, zero), _mm_cmple_ps(z, one))));
+
+						_mm_store_ps(depthRow + x, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, stored)));
+
+						__m128i ri = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(r, zero), one), scale));
+						__m128i gi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(g, zero), one), scale));
+						__m128i bi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(b, zero), one), scale));
+						__m128i rgb = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(ri, 16), _mm_slli_epi32(gi, 8)), bi);
+
+						__m128i mask = _mm_castps_si128(pass);
+						__m128i old = _mm_load_si128(reinterpret_cast<const __m128i*>(colorRow + x));
+						_mm_store_si128(reinterpret_cast<__m128i*>(colorRow + x),
+							_mm_or_si128(_mm_and_si128(mask, rgb), _mm_andnot_si128(mask, old)));
+					}
+
+					e0 = _mm_add_epi32(e0, edgeStep[0]);
+					e1 = _mm_add_epi32(e1, edgeStep[1]);
+					e2 = _mm_add_epi32(e2, edgeStep[2]);
+					z = _mm_add_ps(z, planeStep[0]);
+					r = _mm_add_ps(r, planeStep[1]);
+					g = _mm_add_ps(g, planeStep[2]);
+					b = _mm_add_ps(b, planeStep[3]);
+				}
+
+				for (uint32 i = 0; i < 3; ++i)
+					edge[i] = _mm_add_epi32(edge[i], _mm_set1_epi32(stepY[i]));
+
+				for (uint32 k = 0; k < 4; ++k)
+					plane[k] = _mm_add_ps(plane[k], _mm_set1_ps(dy[k]));
+			}
+		#else
+			for (int32 y = y0; y < y1; ++y)
+			{
+				uint32* colorRow = color.data() + size_t(y) * pitch;
+				float* depthRow = depth.data() + size_t(y) * pitch;
+				int32 row = y - y0;
+
+				for (int32 x = x0; x < x1; ++x)
+				{
+					int32 col = x - xs;
+
+					if ((e[0] + stepX[0] * col + stepY[0] * row) < 0 ||
+						(e[1] + stepX[1] * col + stepY[1] * row) < 0 ||
+						(e[2] + stepX[2] * col + stepY[2] * row) < 0)
+						continue;
+
+					float z = base[0] + dx[0] * col + dy[0] * row;
+					if (!(z < depthRow[x]) || z < 0.0f || z > 1.0f)
+						continue;
+
+					depthRow[x] = z;
+
+					uint32 rgb = 0;
+					for (uint32 k = 1; k < 4; ++k)
+					{
+						float c = std::clamp(base[k] + dx[k] * col + dy[k] * row, 0.0f, 1.0f);
+						rgb = (rgb << 8) | uint32(c * 255.0f + 0.5f);
+					}
+
+					colorRow[x] = rgb;
+				}
+			}
+		#endif
+		}
+	}
+
+	void Rasterizer::Resolve(const uint32 tile, uint32* target, const uint32 targetPitch) const noexcept
+	{
+		const uint32 tx0 = (tile % tilesX) * TILE_SIZE;
+		const uint32 ty0 = (tile / tilesX) * TILE_SIZE;
+		const uint32 tx1 = std::min<uint32>(tx0 + TILE_SIZE, width);
+		const uint32 ty1 = std::min<uint32>(ty0 + TILE_SIZE, height);
+
+		for (uint32 y = ty0; y < ty1; ++y)
+			memcpy(target + size_t(y) * targetPitch + tx0, color.data() + size_t(y) * pitch + tx0, (tx1 - tx0) * sizeof(uint32));
+	}
+
+	void Rasterizer::Flush(JobSystem* jobs, uint32* target, const uint32 targetPitch) noexcept
+	{
+		PROFILE_ZONE("Rasterize");
+
+		auto render = [&](uint32 begin, uint32 end)
+		{
+			for (uint32 tile = begin; tile < end; ++tile)
+			{
+				Render(tile);
+
+				if (target)
+					Resolve(tile, target, targetPitch);
+			}
+		};
+
+		uint32 tiles = tilesX * tilesY;
+
+		if (jobs)
+			jobs->ParallelFor(tiles, 2, render);
+		else
+			render(0, tiles);
+
+		clearPending = false;
+		triangles.clear();
+
+		for (std::vector<uint32>& bin : bins)
+			bin.clear();
+	}
+}
@@ -0,0 +1,107 @@
+#ifndef RASTERIZER_H
+#define RASTERIZER_H
+
+#include "Types.h"
+#include "JobSystem.h"
+#include <vector>
+
+namespace WXE
+{
+	// ---------------------------------------------------
+	// Tiled triangle rasterizer. Draw() sets triangles up
+	// in 28.4 fixed point and bins them into 64x64 tiles;
+	// Flush() renders the tiles in parallel on the job
+	// system. Inside a tile, edge functions are stepped
+	// four pixels at a time and only for the edges that
+	// cross it. Depth test is LESS with depth writes on.
+	// ---------------------------------------------------
+
+	class Rasterizer final
+	{
+	public:
+		enum { TILE_SIZE = 64, SUBPIXEL_BITS = 4, GUARD_BAND = 8192 };
+
+		// vertex layout of the default shaders: float3 position, float4 color
+		struct Vertex
+		{
+			float x, y, z;
+			float r, g, b, a;
+		};
+
+	private:
+		// attribute plane: value = base + dx * (px - x0) + dy * (py - y0)
+		struct Plane
+		{
+			double base;
+			double dx;
+			double dy;
+		};
+
+		struct Triangle
+		{
+			int64 A[3];
+			int64 B[3];
+			int64 C[3];
+			int32 minX, minY, maxX, maxY;
+			Plane planes[4];
+		};
+
+		std::vector<Triangle> triangles;
+		std::vector<std::vector<uint32>> bins;
+		std::vector<uint32> color;
+		std::vector<float> depth;
+
+		uint32 width;
+		uint32 height;
+		uint32 pitch;
+		uint32 tilesX;
+		uint32 tilesY;
+		uint32 clearColor;
+		float clearDepth;
+		bool clearPending;
+		bool culling;
+
+		void Setup(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+			const ViewPort& viewport, const Rect& scissor) noexcept;
+		void Render(const uint32 tile) noexcept;
+		void Resolve(const uint32 tile, uint32* target, const uint32 targetPitch) const noexcept;
+
+	public:
+		Rasterizer() noexcept;
+
+		void Resize(const uint32 width, const uint32 height);
+		void Clear(const uint32 rgb, const float z) noexcept;
+		void Culling(const bool state) noexcept;
+
+		void Draw(const void* vertices, const uint32 stride, const uint32 count,
+			const ViewPort& viewport, const Rect& scissor);
+		void Flush(JobSystem* jobs, uint32* target = nullptr, const uint32 targetPitch = 0) noexcept;
+
+		const uint32* Pixels() const noexcept;
+		uint32 Pitch() const noexcept;
+		uint32 Width() const noexcept;
+		uint32 Height() const noexcept;
+		uint32 Triangles() const noexcept;
+	};
+
+	inline void Rasterizer::Culling(const bool state) noexcept
+	{ culling = state; }
+
+	inline const uint32* Rasterizer::Pixels() const noexcept
+	{ return color.data(); }
+
+	inline uint32 Rasterizer::Pitch() const noexcept
+	{ return pitch; }
+
+	inline uint32 Rasterizer::Width() const noexcept
+	{ return width; }
+
+	inline uint32 Rasterizer::Height() const noexcept
+	{ return height; }
+
+	// triangles binned since the last Flush
+	inline uint32 Rasterizer::Triangles() const noexcept
+	{ return static_cast<uint32>(triangles.size()); }
+}
+
+#endif
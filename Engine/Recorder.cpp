@@ -0,0 +1,182 @@
+#include "Recorder.h"
+#include "Utils.h"
+#include <cstring>
+
+namespace WXE
+{
+    constexpr uint32 RecorderMagic = 0x52455857;    // "WXER"
+    constexpr uint32 RecorderVersion = 2;
+
+    enum RecordFlags
+    {
+        KEYS_CHANGED  = 0x01,
+        MOUSE_CHANGED = 0x02,
+        WHEEL_MOVED   = 0x04,
+        TEXT_CHANGED  = 0x08,
+        KEY_EVENTS    = 0x10
+    };
+
+    Recorder::Recorder() noexcept :
+        file{ nullptr },
+        recorderMode{ IDLE },
+        frameCount{},
+        last{}
+    {
+    }
+
+    Recorder::~Recorder() noexcept
+    {
+        Close();
+    }
+
+    bool Recorder::Record(const string_view fileName)
+    {
+        Close();
+
+        file = fopen(string(fileName).c_str(), "wb");
+        if (!file)
+            return false;
+
+        uint32 header[] { RecorderMagic, RecorderVersion };
+        fwrite(header, sizeof(header), 1, file);
+
+        recorderMode = RECORDING;
+        return true;
+    }
+
+    bool Recorder::Replay(const string_view fileName)
+    {
+        Close();
+
+        file = fopen(string(fileName).c_str(), "rb");
+        if (!file)
+            return false;
+
+        uint32 header[2] {};
+        if (fread(header, sizeof(header), 1, file) != 1 ||
+            header[0] != RecorderMagic || header[1] != RecorderVersion)
+        {
+            Close();
+            return false;
+        }
+
+        recorderMode = REPLAYING;
+        return true;
+    }
+
+    void Recorder::Close() noexcept
+    {
+        if (file)
+            fclose(file);
+
+        file = nullptr;
+        recorderMode = IDLE;
+        frameCount = 0;
+        last = {};
+    }
+
+    void Recorder::Write(const Inputs::Input* input, const double frameTime)
+    {
+        Inputs::InputFrame frame;
+        input->Save(frame);
+
+        uint8 flags {};
+        if (memcmp(&frame.keys, &last.keys, sizeof(frame.keys)) != 0) flags |= KEYS_CHANGED;
+        if (frame.mouseX != last.mouseX || frame.mouseY != last.mouseY) flags |= MOUSE_CHANGED;
+        if (frame.mouseWheel != 0) flags |= WHEEL_MOVED;
+        if (frame.text != last.text) flags |= TEXT_CHANGED;
+        if (frame.down.Any() || frame.up.Any()) flags |= KEY_EVENTS;
+
+        fwrite(&flags, sizeof(flags), 1, file);
+        fwrite(&frameTime, sizeof(frameTime), 1, file);
+
+        if (flags & KEYS_CHANGED)
+            fwrite(&frame.keys, sizeof(frame.keys), 1, file);
+
+        // a tap inside one frame leaves keys unchanged, only the events show it
+        if (flags & KEY_EVENTS)
+        {
+            fwrite(&frame.down, sizeof(frame.down), 1, file);
+            fwrite(&frame.up, sizeof(frame.up), 1, file);
+        }
+
+        if (flags & MOUSE_CHANGED)
+        {
+            fwrite(&frame.mouseX, sizeof(frame.mouseX), 1, file);
+            fwrite(&frame.mouseY, sizeof(frame.mouseY), 1, file);
+        }
+
+        if (flags & WHEEL_MOVED)
+            fwrite(&frame.mouseWheel, sizeof(frame.mouseWheel), 1, file);
+
+        if (flags & TEXT_CHANGED)
+        {
+            uint16 length = static_cast<uint16>(frame.text.size() < 0xFFFF ? frame.text.size() : 0xFFFF);
+            fwrite(&length, sizeof(length), 1, file);
+            fwrite(frame.text.data(), 1, length, file);
+        }
+
+        last = std::move(frame);
+        frameCount++;
+    }
+
+    // one field of a frame, false on a short read
+    template<typename T>
+    static bool Get(FILE* file, T& value) noexcept
+    {
+        return fread(&value, sizeof(value), 1, file) == 1;
+    }
+
+    bool Recorder::ReadFrame(double& frameTime)
+    {
+        uint8 flags {};
+
+        if (!Get(file, flags) || !Get(file, frameTime) || !(frameTime >= 0.0))
+            return false;
+
+        if ((flags & KEYS_CHANGED) && !Get(file, last.keys))
+            return false;
+
+        last.down = {};
+        last.up = {};
+        if ((flags & KEY_EVENTS) && !(Get(file, last.down) && Get(file, last.up)))
+            return false;
+
+        if ((flags & MOUSE_CHANGED) && !(Get(file, last.mouseX) && Get(file, last.mouseY)))
+            return false;
+
+        last.mouseWheel = 0;
+        if ((flags & WHEEL_MOVED) && !Get(file, last.mouseWheel))
+            return false;
+
+        if (flags & TEXT_CHANGED)
+        {
+            uint16 length {};
+            if (!Get(file, length))
+                return false;
+
+            last.text.resize(length);
+            if (fread(last.text.data(), 1, length, file) != length)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool Recorder::Read(Inputs::Input* input, double& frameTime)
+    {
+        // the end of the file or a frame cut short ends the replay,
+        // nothing of a partly read frame reaches the input
+        if (!ReadFrame(frameTime))
+        {
+            Close();
+            return false;
+        }
+
+        if (input)
+            input->Load(last);
+
+        frameCount++;
+        return true;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include "Types.h"
+#include "Input.h"
+#include <cstdio>
+
+namespace WXE
+{
+	enum RecorderModes { IDLE, RECORDING, REPLAYING };
+
+	// ---------------------------------------------------
+	// Records the input state and frame time of every frame
+	// into a binary file and plays it back. Each frame only
+	// stores the parts of the input that changed.
+	// ---------------------------------------------------
+
+	class Recorder final
+	{
+	private:
+		FILE* file;
+		int32 recorderMode;
+		uint64 frameCount;
+		Inputs::InputFrame last;
+
+		bool ReadFrame(double& frameTime);
+
+	public:
+		Recorder() noexcept;
+		~Recorder() noexcept;
+
+		bool Record(const string_view fileName);
+		bool Replay(const string_view fileName);
+		void Close() noexcept;
+
+		void Write(const Inputs::Input* input, const double frameTime);
+		bool Read(Inputs::Input* input, double& frameTime);
+
+		int32 Mode() const noexcept;
+		uint64 Frames() const noexcept;
+	};
+
+	inline int32 Recorder::Mode() const noexcept
+	{ return recorderMode; }
+
+	inline uint64 Recorder::Frames() const noexcept
+	{ return frameCount; }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "ResolutionScaler.h"
+#include <cmath>
+
+namespace WXE
+{
+	ResolutionScaler::ResolutionScaler(const double hz, const float minimum) noexcept :
+		budget{},
+		average{},
+		scale{ 1.0f },
+		minScale{ minimum },
+		over{},
+		under{},
+		cooldown{},
+		changes{}
+	{
+		Target(hz, minimum);
+	}
+
+	void ResolutionScaler::Target(const double hz, const float minimum) noexcept
+	{
+		budget = (hz > 0.0) ? 1.0 / hz : 0.0;
+		minScale = (minimum > 1.0f) ? 1.0f : (minimum < 0.1f ? 0.1f : minimum);
+		scale = 1.0f;
+		average = budget;
+		over = under = cooldown = changes = 0;
+	}
+
+	bool ResolutionScaler::Update(const double frameCost) noexcept
+	{
+		if (budget <= 0.0)
+			return false;
+
+		// spikes pull the average up fast, it comes down slower
+		average += (frameCost - average) * ((frameCost > average) ? 0.25 : 0.125);
+
+		if (cooldown > 0)
+		{
+			cooldown--;
+			return false;
+		}
+
+		if (average > budget * 0.95)
+		{
+			over++;
+			under = 0;
+		}
+		else if (average < budget * 0.75)
+		{
+			under++;
+			over = 0;
+		}
+		else
+		{
+			over = under = 0;
+		}
+
+		// aim at 85% of the budget, cost going with the pixel count
+		float target = scale * static_cast<float>(std::sqrt(budget * 0.85 / average));
+
+		if (over >= DOWN_FRAMES && scale > minScale)
+			return Set((target < scale - 1.0f / 32) ? target : scale - 1.0f / 32);
+
+		// growing is capped, a wrong guess up costs a dropped frame
+		if (under >= UP_FRAMES && scale < 1.0f)
+			return Set((target < scale + 0.1f) ? target : scale + 0.1f);
+
+		return false;
+	}
+
+	bool ResolutionScaler::Set(float target) noexcept
+	{
+		// steps of 1/32 keep noise from resizing the render target
+		target = std::floor(target * 32.0f + 0.5f) / 32.0f;
+		target = (target > 1.0f) ? 1.0f : (target < minScale ? minScale : target);
+
+		over = under = 0;
+
+		if (target == scale)
+			return false;
+
+		// what the frame should cost at the new scale
+		average *= (target / scale) * (target / scale);
+
+		scale = target;
+		cooldown = COOLDOWN;
+		changes++;
+		return true;
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef RESOLUTIONSCALER_H
+#define RESOLUTIONSCALER_H
+
+#include "Types.h"
+
+namespace WXE
+{
+	// ---------------------------------------------------
+	// Dynamic resolution controller. Frame costs are
+	// averaged and compared with the budget: a few frames
+	// over it shrink the render scale, many frames well
+	// under it grow the scale back in small steps. The
+	// gap between the two thresholds plus a cooldown after
+	// each change keep the scale from oscillating. Steps
+	// assume the cost follows the pixel count, i.e. the
+	// square of the scale.
+	// ---------------------------------------------------
+
+	class ResolutionScaler final
+	{
+	public:
+		enum { DOWN_FRAMES = 3, UP_FRAMES = 30, COOLDOWN = 8 };
+
+	private:
+		double budget;
+		double average;
+		float scale;
+		float minScale;
+		uint32 over;
+		uint32 under;
+		uint32 cooldown;
+		uint32 changes;
+
+		bool Set(float target) noexcept;
+
+	public:
+		ResolutionScaler(const double hz = 0.0, const float minimum = 0.5f) noexcept;
+
+		void Target(const double hz, const float minimum = 0.5f) noexcept;
+		bool Enabled() const noexcept;
+		bool Update(const double frameCost) noexcept;
+
+		float Scale() const noexcept;
+		double Cost() const noexcept;
+		double Budget() const noexcept;
+		uint32 Changes() const noexcept;
+	};
+
+	inline bool ResolutionScaler::Enabled() const noexcept
+	{ return budget > 0.0; }
+
+	inline float ResolutionScaler::Scale() const noexcept
+	{ return scale; }
+
+	// averaged frame cost, in seconds
+	inline double ResolutionScaler::Cost() const noexcept
+	{ return average; }
+
+	inline double ResolutionScaler::Budget() const noexcept
+	{ return budget; }
+
+	// scale changes since the target was set
+	inline uint32 ResolutionScaler::Changes() const noexcept
+	{ return changes; }
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include "ResourceStates.h"
+#include <iterator>
+
+namespace WXE
+{
+	StateTracker::StateTracker(const uint32 readStates) noexcept :
+		readStates{ readStates },
+		issued{},
+		elided{},
+		batches{}
+	{
+	}
+
+	void StateTracker::Track(void* resource, const uint32 state, const uint32 subresources)
+	{
+		resources[resource] = { state, subresources ? subresources : 1, {} };
+	}
+
+	void StateTracker::Untrack(void* resource) noexcept
+	{
+		resources.erase(resource);
+
+		// a resource going away takes its pending transitions along
+		std::erase_if(pending, [resource](const Transition& t) { return t.resource == resource; });
+	}
+
+	// ---------------------------------------------------
+	// A resource holds one state while all subresources
+	// agree, and a state per subresource once one of them
+	// is moved on its own; it goes back to one state when
+	// they agree again. Returns false for resources that
+	// are not tracked or subresources out of range.
+	// ---------------------------------------------------
+
+	bool StateTracker::Require(void* resource, const uint32 state, const uint32 subresource)
+	{
+		auto found = resources.find(resource);
+
+		if (found == resources.end())
+			return false;
+
+		Resource& r = found->second;
+		uint32 index = (r.count == 1) ? ALL_SUBRESOURCES : subresource;
+
+		if (index == ALL_SUBRESOURCES)
+		{
+			if (r.subresources.empty())
+			{
+				r.state = Transit(resource, ALL_SUBRESOURCES, r.state, state);
+				return true;
+			}
+
+			for (uint32 i = 0; i < r.count; ++i)
+				r.subresources[i] = Transit(resource, i, r.subresources[i], state);
+		}
+		else
+		{
+			if (index >= r.count)
+				return false;
+
+			if (r.subresources.empty())
+				r.subresources.assign(r.count, r.state);
+
+			r.subresources[index] = Transit(resource, index, r.subresources[index], state);
+		}
+
+		for (uint32 s : r.subresources)
+			if (s != r.subresources[0])
+				return true;
+
+		r.state = r.subresources[0];
+		r.subresources.clear();
+		return true;
+	}
+
+	// returns the state the subresource is left in
+	uint32 StateTracker::Transit(void* resource, const uint32 subresource, const uint32 before, const uint32 after)
+	{
+		// already there, or reading from a read state that includes it
+		if (before == after || (after && (before & after) == after && (before & ~readStates) == 0))
+		{
+			elided++;
+			return before;
+		}
+
+		// only the last pending transition of the resource can be
+		// changed, an earlier one would move ahead of those after it
+		for (auto p = pending.rbegin(); p != pending.rend(); ++p)
+		{
+			if (p->resource != resource)
+				continue;
+
+			if (p->subresource == subresource)
+			{
+				if (p->before == after)
+				{
+					// there and back: neither one is issued
+					pending.erase(std::next(p).base());
+					elided += 2;
+				}
+				else
+				{
+					p->after = after;
+					elided++;
+				}
+
+				return after;
+			}
+
+			break;
+		}
+
+		pending.push_back({ resource, subresource, before, after });
+		return after;
+	}
+
+	void StateTracker::Flush(BarrierList* list) noexcept
+	{
+		if (pending.empty())
+			return;
+
+		list->Barriers(pending.data(), static_cast<uint32>(pending.size()));
+
+		issued += pending.size();
+		batches++;
+		pending.clear();
+	}
+
+	uint32 StateTracker::State(void* resource, const uint32 subresource) const noexcept
+	{
+		auto found = resources.find(resource);
+
+		if (found == resources.end())
+			return 0;
+
+		const Resource& r = found->second;
+
+		if (r.subresources.empty() || subresource >= r.count)
+			return r.state;
+
+		return r.subresources[subresource];
+	}
+
+	// ---------------------------------------------------
+
+	RecordingList::RecordingList() noexcept :
+		calls{}
+	{
+	}
+
+	void RecordingList::Barriers(const Transition* transitions, const uint32 count) noexcept
+	{
+		recorded.insert(recorded.end(), transitions, transitions + count);
+		calls++;
+	}
+
+	void RecordingList::Reset() noexcept
+	{
+		recorded.clear();
+		calls = 0;
+	}
+}
@@ -0,0 +1,128 @@
+#ifndef RESOURCESTATES_H
+#define RESOURCESTATES_H
+
+#include "Types.h"
+#include <unordered_map>
+#include <vector>
+
+namespace WXE
+{
+	// ---------------------------------------------------
+	// A state transition of a resource, in the terms of
+	// D3D12: states are bit masks, 0 is COMMON (and
+	// PRESENT), and ALL_SUBRESOURCES is the whole resource.
+	// ---------------------------------------------------
+
+	struct Transition
+	{
+		void* resource;
+		uint32 subresource;
+		uint32 before;
+		uint32 after;
+	};
+
+	// what the state tracker needs from a command list
+	class BarrierList
+	{
+	public:
+		virtual ~BarrierList() = default;
+
+		virtual void Barriers(const Transition* transitions, const uint32 count) noexcept = 0;
+	};
+
+	// ---------------------------------------------------
+	// Resource state tracking. Callers register resources
+	// with the state they were created in and then only
+	// say which state they need; the tracker works out
+	// the transitions. A transition to the state already
+	// held, or to a read state included in the current
+	// read states, is dropped, and one still pending for
+	// the same subresource is redirected (or cancelled if
+	// it goes back) instead of followed by another one.
+	// Flush() issues everything pending in one call,
+	// before a draw or a copy needs the states.
+	// ---------------------------------------------------
+
+	class StateTracker final
+	{
+	public:
+		enum : uint32 { ALL_SUBRESOURCES = 0xFFFFFFFF };
+
+	private:
+		struct Resource
+		{
+			uint32 state;
+			uint32 count;
+			std::vector<uint32> subresources;
+		};
+
+		std::unordered_map<void*, Resource> resources;
+		std::vector<Transition> pending;
+		uint32 readStates;
+		uint64 issued;
+		uint64 elided;
+		uint64 batches;
+
+		uint32 Transit(void* resource, const uint32 subresource, const uint32 before, const uint32 after);
+
+	public:
+		StateTracker(const uint32 readStates = 0) noexcept;
+
+		void Track(void* resource, const uint32 state, const uint32 subresources = 1);
+		void Untrack(void* resource) noexcept;
+		bool Require(void* resource, const uint32 state, const uint32 subresource = ALL_SUBRESOURCES);
+		void Flush(BarrierList* list) noexcept;
+
+		uint32 State(void* resource, const uint32 subresource = 0) const noexcept;
+		uint32 Pending() const noexcept;
+		uint64 Issued() const noexcept;
+		uint64 Elided() const noexcept;
+		uint64 Batches() const noexcept;
+	};
+
+	// transitions waiting for the next Flush()
+	inline uint32 StateTracker::Pending() const noexcept
+	{ return static_cast<uint32>(pending.size()); }
+
+	// barriers handed to command lists
+	inline uint64 StateTracker::Issued() const noexcept
+	{ return issued; }
+
+	// transitions asked for and never issued
+	inline uint64 StateTracker::Elided() const noexcept
+	{ return elided; }
+
+	// Flush() calls that issued barriers
+	inline uint64 StateTracker::Batches() const noexcept
+	{ return batches; }
+
+	// ---------------------------------------------------
+	// A command list that only records the barriers it is
+	// given, to check the tracker where there is no device.
+	// ---------------------------------------------------
+
+	class RecordingList final : public BarrierList
+	{
+	private:
+		std::vector<Transition> recorded;
+		uint32 calls;
+
+	public:
+		RecordingList() noexcept;
+
+		void Barriers(const Transition* transitions, const uint32 count) noexcept override;
+		void Reset() noexcept;
+
+		const std::vector<Transition>& Recorded() const noexcept;
+		uint32 Calls() const noexcept;
+	};
+
+	inline const std::vector<Transition>& RecordingList::Recorded() const noexcept
+	{ return recorded; }
+
+	// Barriers() calls, one per batch
+	inline uint32 RecordingList::Calls() const noexcept
+	{ return calls; }
+}
+
+#endif
@@ -0,0 +1,111 @@
+#include "StreamCopy.h"
+#include "JobSystem.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+#endif
+
+namespace WXE
+{
+#if defined(__AVX2__)
+	using Vector = __m256i;
+
+	static inline Vector Load(const uint8* source) noexcept
+	{ return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source)); }
+
+	static inline void Stream(uint8* destination, const Vector v) noexcept
+	{ _mm256_stream_si256(reinterpret_cast<__m256i*>(destination), v); }
+#elif defined(__SSE2__) || defined(_M_X64)
+	using Vector = __m128i;
+
+	static inline Vector Load(const uint8* source) noexcept
+	{ return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source)); }
+
+	static inline void Stream(uint8* destination, const Vector v) noexcept
+	{ _mm_stream_si128(reinterpret_cast<__m128i*>(destination), v); }
+#endif
+
+	static void StreamRange(uint8* dst, const uint8* src, size_t size) noexcept
+	{
+	#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+		constexpr size_t width = sizeof(Vector);
+
+		// streaming stores need an aligned destination; the few
+		// bytes before the first boundary go through the cache
+		size_t head = (width - (reinterpret_cast<uintptr_t>(dst) & (width - 1))) & (width - 1);
+		if (head > size)
+			head = size;
+
+		memcpy(dst, src, head);
+		dst += head;
+		src += head;
+		size -= head;
+
+		// two cache lines per step, all loads ahead of the stores
+		while (size >= 128)
+		{
+			Vector v[128 / width];
+
+			for (size_t i = 0; i < 128 / width; ++i)
+				v[i] = Load(src + i * width);
+
+			for (size_t i = 0; i < 128 / width; ++i)
+				Stream(dst + i * width, v[i]);
+
+			dst += 128;
+			src += 128;
+			size -= 128;
+		}
+
+		while (size >= width)
+		{
+			Stream(dst, Load(src));
+			dst += width;
+			src += width;
+			size -= width;
+		}
+
+		memcpy(dst, src, size);
+
+		// streaming stores are weakly ordered: drain them before
+		// the copy counts as done and the GPU is told to read it
+		_mm_sfence();
+	#else
+		memcpy(dst, src, size);
+	#endif
+	}
+
+	void StreamCopy(void* destination, const void* source, const size_t size, JobSystem* jobs) noexcept
+	{
+		uint8* dst = static_cast<uint8*>(destination);
+		const uint8* src = static_cast<const uint8*>(source);
+
+		if (size < STREAM_MIN_SIZE)
+		{
+			memcpy(dst, src, size);
+			return;
+		}
+
+		if (jobs == nullptr || size < STREAM_PARALLEL_SIZE)
+		{
+			StreamRange(dst, src, size);
+			return;
+		}
+
+		// chunks start on cache line multiples of the destination,
+		// and every worker fences its own stores before returning
+		uint32 chunks = static_cast<uint32>((size + STREAM_CHUNK_SIZE - 1) / STREAM_CHUNK_SIZE);
+
+		jobs->ParallelFor(chunks, 1, [=](uint32 begin, uint32 end)
+		{
+			size_t first = size_t(begin) * STREAM_CHUNK_SIZE;
+			size_t last = size_t(end) * STREAM_CHUNK_SIZE;
+
+			StreamRange(dst + first, src + first, (last < size ? last : size) - first);
+		});
+	}
+}
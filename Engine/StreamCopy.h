@@ -0,0 +1,33 @@
+#ifndef STREAMCOPY_H
+#define STREAMCOPY_H
+
+#include "Types.h"
+#include <cstddef>
+
+namespace WXE
+{
+	class JobSystem;
+
+	// ---------------------------------------------------
+	// Copy into write-combined memory: mapped upload heaps
+	// and host visible device memory. Whole cache lines
+	// are written with non-temporal stores, which bypass
+	// the cache and are never read back, and the copy ends
+	// with a store fence, so the data is out of the CPU
+	// before anything is submitted. Large copies are split
+	// across the job workers when jobs is given. Plain
+	// memcpy is still the better choice for cached memory
+	// that is read again soon.
+	// ---------------------------------------------------
+
+	enum : size_t
+	{
+		STREAM_MIN_SIZE = 4 << 10,
+		STREAM_CHUNK_SIZE = 256 << 10,
+		STREAM_PARALLEL_SIZE = 2 << 20
+	};
+
+	void StreamCopy(void* destination, const void* source, const size_t size, JobSystem* jobs = nullptr) noexcept;
+}
+
+#endif
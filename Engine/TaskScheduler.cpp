@@ -0,0 +1,124 @@
+#include "TaskScheduler.h"
+using std::lock_guard;
+using std::mutex;
+
+namespace WXE
+{
+    TaskScheduler::TaskScheduler(JobSystem* jobSystem) noexcept :
+        jobs{ jobSystem },
+        now{},
+        taskCount{},
+        pendingJobs{}
+    {
+    }
+
+    TaskScheduler::~TaskScheduler() noexcept
+    {
+        // tasks still waiting on a job must see it finish before being destroyed
+        if (jobs)
+            jobs->Wait(pendingJobs);
+
+        ready.insert(ready.end(), finished.begin(), finished.end());
+
+        for (Task::Handle handle : ready)
+            handle.destroy();
+
+        while (!sleepers.empty())
+        {
+            sleepers.top().handle.destroy();
+            sleepers.pop();
+        }
+    }
+
+    void TaskScheduler::Start(Task&& task)
+    {
+        Task::Handle handle = task.handle;
+        task.handle = nullptr;
+
+        handle.promise().scheduler = this;
+        taskCount++;
+
+        // runs up to its first co_await right away
+        Resume(handle);
+    }
+
+    void TaskScheduler::Resume(Task::Handle handle) noexcept
+    {
+        handle.resume();
+
+        if (handle.done())
+        {
+            // the exception is kept for the engine to report, throwing it
+            // here would go through Update and the engine's frame
+            if (handle.promise().exception)
+                failures.push_back(handle.promise().exception);
+
+            handle.destroy();
+            taskCount--;
+        }
+    }
+
+    void TaskScheduler::Update(const double frameTime)
+    {
+        now += frameTime;
+
+        // wake-ups from this frame go to a separate list so that a
+        // task awaiting NextFrame() is not resumed twice in one frame
+        resuming.swap(ready);
+
+        while (!sleepers.empty() && sleepers.top().wake <= now)
+        {
+            resuming.push_back(sleepers.top().handle);
+            sleepers.pop();
+        }
+
+        {
+            lock_guard<mutex> lock(finishedLock);
+            resuming.insert(resuming.end(), finished.begin(), finished.end());
+            finished.clear();
+        }
+
+        // the list is taken before any task runs: a task scheduling
+        // itself again goes to ready, never back into this batch
+        std::vector<Task::Handle> batch;
+        batch.swap(resuming);
+
+        for (Task::Handle handle : batch)
+            Resume(handle);
+
+        // keep the storage for the next frame
+        batch.clear();
+        resuming.swap(batch);
+    }
+
+    void TaskScheduler::WaitFrame(Task::Handle handle)
+    {
+        ready.push_back(handle);
+    }
+
+    void TaskScheduler::WaitSeconds(Task::Handle handle, const double secs)
+    {
+        if (secs <= 0.0)
+            ready.push_back(handle);
+        else
+            sleepers.push(Sleeper{ now + secs, handle });
+    }
+
+    void TaskScheduler::WaitJob(Task::Handle handle, Job&& job)
+    {
+        if (!jobs)
+        {
+            job();
+            ready.push_back(handle);
+            return;
+        }
+
+        jobs->Schedule([this, handle, job = std::move(job)]
+        {
+            job();
+
+            lock_guard<mutex> lock(finishedLock);
+            finished.push_back(handle);
+        }, &pendingJobs);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include "Types.h"
+#include "JobSystem.h"
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+namespace WXE
+{
+	class TaskScheduler;
+
+	// ---------------------------------------------------
+	// Game logic coroutine. A Task is handed to the
+	// scheduler with Start() and is resumed by it once per
+	// frame at most, only when what it awaits is ready.
+	// ---------------------------------------------------
+
+	class Task final
+	{
+	public:
+		struct promise_type
+		{
+			TaskScheduler* scheduler = nullptr;
+			std::exception_ptr exception;
+
+			Task get_return_object() noexcept
+			{ return Task{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			std::suspend_always final_suspend() noexcept { return {}; }
+			void return_void() noexcept {}
+			void unhandled_exception() noexcept { exception = std::current_exception(); }
+		};
+
+		using Handle = std::coroutine_handle<promise_type>;
+
+	private:
+		Handle handle;
+
+		explicit Task(Handle h) noexcept : handle{ h } {}
+		friend class TaskScheduler;
+
+	public:
+		Task(Task&& other) noexcept : handle{ other.handle } { other.handle = nullptr; }
+		Task(const Task&) = delete;
+		Task& operator=(const Task&) = delete;
+		~Task() { if (handle) handle.destroy(); }
+	};
+
+	class TaskScheduler final
+	{
+	private:
+		struct Sleeper
+		{
+			double wake;
+			Task::Handle handle;
+
+			bool operator>(const Sleeper& other) const noexcept
+			{ return wake > other.wake; }
+		};
+
+		JobSystem* jobs;
+		double now;
+		uint32 taskCount;
+
+		std::vector<Task::Handle> ready;
+		std::vector<Task::Handle> resuming;
+		std::priority_queue<Sleeper, std::vector<Sleeper>, std::greater<Sleeper>> sleepers;
+
+		std::mutex finishedLock;
+		std::vector<Task::Handle> finished;
+		JobCounter pendingJobs;
+
+		std::vector<std::exception_ptr> failures;
+
+		void Resume(Task::Handle handle) noexcept;
+
+	public:
+		TaskScheduler(JobSystem* jobSystem = nullptr) noexcept;
+		~TaskScheduler() noexcept;
+
+		void Start(Task&& task);
+		void Update(const double frameTime);
+
+		double Now() const noexcept;
+		uint32 Count() const noexcept;
+		std::exception_ptr Failure() noexcept;
+
+		void WaitFrame(Task::Handle handle);
+		void WaitSeconds(Task::Handle handle, const double secs);
+		void WaitJob(Task::Handle handle, Job&& job);
+	};
+
+	inline double TaskScheduler::Now() const noexcept
+	{ return now; }
+
+	inline uint32 TaskScheduler::Count() const noexcept
+	{ return taskCount; }
+
+	// oldest exception a finished task left behind, taken off the list
+	inline std::exception_ptr TaskScheduler::Failure() noexcept
+	{
+		if (failures.empty()) return nullptr;
+		std::exception_ptr failure = failures.front();
+		failures.erase(failures.begin());
+		return failure;
+	}
+
+	// ---------------------------------------------------
+	// Awaitables: co_await NextFrame(), Seconds(x), RunJob(f)
+	// ---------------------------------------------------
+
+	struct NextFrame
+	{
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(Task::Handle h) { h.promise().scheduler->WaitFrame(h); }
+		void await_resume() const noexcept {}
+	};
+
+	struct Seconds
+	{
+		double secs;
+
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(Task::Handle h) { h.promise().scheduler->WaitSeconds(h, secs); }
+		void await_resume() const noexcept {}
+	};
+
+	struct RunJob
+	{
+		Job job;
+
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(Task::Handle h) { h.promise().scheduler->WaitJob(h, std::move(job)); }
+		void await_resume() const noexcept {}
+	};
+}
+
+#endif
\ No newline at end of file
@@ -1,11 +1,11 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+#include "Clock.h"
 #include <chrono>
 
 namespace WXE
 {
-	using Clock = std::chrono::high_resolution_clock;
 	using std::chrono::duration_cast;
 	using std::chrono::duration;
 
@@ -0,0 +1,183 @@
+#include "TimerWheel.h"
+
+namespace WXE
+{
+    TimerWheel::TimerWheel(const double tickSeconds) noexcept :
+        freeList{ NIL },
+        current{},
+        active{},
+        resolution{ tickSeconds },
+        pending{}
+    {
+        for (uint32& head : heads)
+            head = NIL;
+    }
+
+    uint32 TimerWheel::Allocate() noexcept
+    {
+        if (freeList != NIL)
+        {
+            uint32 index = freeList;
+            freeList = nodes[index].next;
+            return index;
+        }
+
+        nodes.push_back(Node{ 0, {}, nullptr, NIL, NIL, NIL, 1 });
+        return static_cast<uint32>(nodes.size() - 1);
+    }
+
+    void TimerWheel::Release(const uint32 index) noexcept
+    {
+        Node& node = nodes[index];
+        node.callback = nullptr;
+        node.flag = nullptr;
+        node.slot = NIL;
+        node.generation++;
+        node.next = freeList;
+        freeList = index;
+        active--;
+    }
+
+    void TimerWheel::Insert(const uint32 index) noexcept
+    {
+        Node& node = nodes[index];
+        uint64 delta = node.expires - current;
+
+        // the level is picked by how far away the timer is,
+        // the slot by the matching bits of its expiration tick
+        uint32 level {};
+        while (level < LEVELS - 1 && delta >= (uint64(1) << (SLOT_BITS * (level + 1))))
+            level++;
+
+        uint64 expires = node.expires;
+        if (level == LEVELS - 1 && delta >= (uint64(1) << (SLOT_BITS * LEVELS)))
+            expires = current + (uint64(1) << (SLOT_BITS * LEVELS)) - 1;
+
+        uint32 slot = level * SLOTS + static_cast<uint32>((expires >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+        node.slot = slot;
+        node.prev = NIL;
+        node.next = heads[slot];
+
+        if (heads[slot] != NIL)
+            nodes[heads[slot]].prev = index;
+
+        heads[slot] = index;
+    }
+
+    void TimerWheel::Unlink(const uint32 index) noexcept
+    {
+        Node& node = nodes[index];
+
+        if (node.prev != NIL) nodes[node.prev].next = node.next;
+        else                  heads[node.slot] = node.next;
+
+        if (node.next != NIL)
+            nodes[node.next].prev = node.prev;
+
+        node.prev = node.next = NIL;
+        node.slot = NIL;
+    }
+
+    TimerId TimerWheel::Schedule(const double secs, TimerCallback&& callback, bool* flag)
+    {
+        uint64 ticks = (secs > 0.0) ? static_cast<uint64>(secs / resolution + 0.999999) : 0;
+
+        uint32 index = Allocate();
+        Node& node = nodes[index];
+        node.expires = current + (ticks > 0 ? ticks : 1);
+        node.callback = std::move(callback);
+        node.flag = flag;
+
+        if (flag)
+            *flag = false;
+
+        Insert(index);
+        active++;
+
+        return (uint64(node.generation) << 32) | index;
+    }
+
+    bool TimerWheel::Active(const TimerId id) const noexcept
+    {
+        uint32 index = static_cast<uint32>(id);
+        uint32 generation = static_cast<uint32>(id >> 32);
+
+        return index < nodes.size()
+            && nodes[index].generation == generation
+            && nodes[index].slot != NIL;
+    }
+
+    bool TimerWheel::Cancel(const TimerId id) noexcept
+    {
+        if (!Active(id))
+            return false;
+
+        uint32 index = static_cast<uint32>(id);
+        Unlink(index);
+        Release(index);
+        return true;
+    }
+
+    void TimerWheel::Cascade(const uint32 level) noexcept
+    {
+        uint32 slot = level * SLOTS + static_cast<uint32>((current >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+        uint32 index = heads[slot];
+        heads[slot] = NIL;
+
+        while (index != NIL)
+        {
+            uint32 next = nodes[index].next;
+            Insert(index);
+            index = next;
+        }
+    }
+
+    void TimerWheel::Fire(const uint32 slot)
+    {
+        // pop one at a time: callbacks may cancel or schedule other timers
+        while (heads[slot] != NIL)
+        {
+            uint32 index = heads[slot];
+            Unlink(index);
+
+            if (nodes[index].expires > current)
+            {
+                Insert(index);
+                continue;
+            }
+
+            TimerCallback callback = std::move(nodes[index].callback);
+            bool* flag = nodes[index].flag;
+            Release(index);
+
+            if (flag) *flag = true;
+            if (callback) callback();
+        }
+    }
+
+    void TimerWheel::Advance(const double frameTime)
+    {
+        pending += frameTime;
+
+        uint64 ticks = static_cast<uint64>(pending / resolution);
+        pending -= ticks * resolution;
+
+        while (ticks-- > 0)
+        {
+            current++;
+
+            // when a level wraps, pull the next slot of the level above down
+            for (uint32 level = 1; level < LEVELS; ++level)
+            {
+                if ((current & ((uint64(1) << (SLOT_BITS * level)) - 1)) != 0)
+                    break;
+
+                Cascade(level);
+            }
+
+            Fire(static_cast<uint32>(current & (SLOTS - 1)));
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include "Types.h"
+#include <functional>
+#include <vector>
+
+namespace WXE
+{
+	using TimerId = uint64;
+	using TimerCallback = std::function<void()>;
+
+	// ---------------------------------------------------
+	// Hierarchical timing wheel: 4 levels of 256 slots with
+	// one tick of resolution each (1 ms by default). Timers
+	// sit in intrusive lists, so Schedule and Cancel are
+	// O(1) and Advance only touches the slots that expire.
+	// ---------------------------------------------------
+
+	class TimerWheel final
+	{
+	private:
+		enum { LEVELS = 4, SLOTS = 256, SLOT_BITS = 8, NIL = 0xFFFFFFFF };
+
+		struct Node
+		{
+			uint64 expires;
+			TimerCallback callback;
+			bool* flag;
+			uint32 prev;
+			uint32 next;
+			uint32 slot;
+			uint32 generation;
+		};
+
+		std::vector<Node> nodes;
+		uint32 freeList;
+		uint32 heads[LEVELS * SLOTS];
+		uint64 current;
+		uint32 active;
+		double resolution;
+		double pending;
+
+		uint32 Allocate() noexcept;
+		void Insert(const uint32 index) noexcept;
+		void Unlink(const uint32 index) noexcept;
+		void Release(const uint32 index) noexcept;
+		void Cascade(const uint32 level) noexcept;
+		void Fire(const uint32 slot);
+		TimerId Schedule(const double secs, TimerCallback&& callback, bool* flag);
+
+	public:
+		TimerWheel(const double tickSeconds = 0.001) noexcept;
+
+		TimerId Schedule(const double secs, TimerCallback callback);
+		TimerId Schedule(const double secs, bool* flag);
+		bool Cancel(const TimerId id) noexcept;
+		bool Active(const TimerId id) const noexcept;
+
+		void Advance(const double frameTime);
+		uint32 Count() const noexcept;
+	};
+
+	inline uint32 TimerWheel::Count() const noexcept
+	{ return active; }
+
+	inline TimerId TimerWheel::Schedule(const double secs, TimerCallback callback)
+	{ return Schedule(secs, std::move(callback), nullptr); }
+
+	inline TimerId TimerWheel::Schedule(const double secs, bool* flag)
+	{ return Schedule(secs, TimerCallback{}, flag); }
+}
+
+#endif
\ No newline at end of file
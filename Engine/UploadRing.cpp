@@ -0,0 +1,89 @@
+#include "UploadRing.h"
+
+namespace WXE
+{
+	UploadRing::UploadRing() noexcept :
+		device{ nullptr },
+		capacity{},
+		head{},
+		closed{},
+		tail{},
+		stalls{}
+	{
+	}
+
+	void UploadRing::Initialize(FenceDevice* device, const uint64 capacity) noexcept
+	{
+		this->device = device;
+		this->capacity = capacity;
+
+		batches.clear();
+		head = closed = tail = 0;
+		stalls = 0;
+	}
+
+	// ---------------------------------------------------
+	// Positions only grow; the offset in the buffer is the
+	// position modulo the capacity. An upload never wraps
+	// around the end: it starts over at the next lap. It
+	// fails only when the space is held by uploads still
+	// open (Close() them first) or is more than the ring.
+	// ---------------------------------------------------
+
+	bool UploadRing::Allocate(const uint64 size, const uint64 alignment, uint64* offset) noexcept
+	{
+		if (size > capacity)
+			return false;
+
+		// an empty ring starts over at the front
+		if (head == tail && batches.empty())
+			head = closed = tail = 0;
+
+		for (;;)
+		{
+			uint64 start = (alignment > 1) ? (head + alignment - 1) / alignment * alignment : head;
+
+			if (start % capacity + size > capacity)
+				start = (start / capacity + 1) * capacity;
+
+			if (start + size - tail <= capacity)
+			{
+				head = start + size;
+				*offset = start % capacity;
+				return true;
+			}
+
+			if (batches.empty())
+				return false;
+
+			// the oldest batch holds the space needed
+			if (device->Completed() < batches.front().fence)
+			{
+				stalls++;
+				device->Wait(batches.front().fence);
+			}
+
+			Reclaim();
+		}
+	}
+
+	void UploadRing::Close(const uint64 fence) noexcept
+	{
+		if (head > closed)
+		{
+			batches.push_back({ fence, head });
+			closed = head;
+		}
+	}
+
+	void UploadRing::Reclaim() noexcept
+	{
+		uint64 completed = device->Completed();
+
+		while (!batches.empty() && batches.front().fence <= completed)
+		{
+			tail = batches.front().end;
+			batches.pop_front();
+		}
+	}
+}
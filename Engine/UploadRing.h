@@ -0,0 +1,67 @@
+#ifndef UPLOADRING_H
+#define UPLOADRING_H
+
+#include "Types.h"
+#include "FrameRing.h"
+#include <deque>
+
+namespace WXE
+{
+	// ---------------------------------------------------
+	// Space accounting of a persistently mapped staging
+	// ring. Uploads are packed one after another, a batch
+	// submitted to the copy queue closes everything packed
+	// since the last one under its fence value, and that
+	// space comes back once the fence is reached. A full
+	// ring waits on its oldest batch. Only offsets live
+	// here: the mapped buffer belongs to the backend.
+	// ---------------------------------------------------
+
+	class UploadRing final
+	{
+	private:
+		struct Batch
+		{
+			uint64 fence;
+			uint64 end;
+		};
+
+		FenceDevice* device;
+		std::deque<Batch> batches;
+		uint64 capacity;
+		uint64 head;
+		uint64 closed;
+		uint64 tail;
+		uint64 stalls;
+
+	public:
+		UploadRing() noexcept;
+
+		void Initialize(FenceDevice* device, const uint64 capacity) noexcept;
+		bool Allocate(const uint64 size, const uint64 alignment, uint64* offset) noexcept;
+		void Close(const uint64 fence) noexcept;
+		void Reclaim() noexcept;
+
+		bool Open() const noexcept;
+		uint64 Capacity() const noexcept;
+		uint64 Used() const noexcept;
+		uint64 Stalls() const noexcept;
+	};
+
+	// packed since the last Close(), waiting to be submitted
+	inline bool UploadRing::Open() const noexcept
+	{ return head > closed; }
+
+	inline uint64 UploadRing::Capacity() const noexcept
+	{ return capacity; }
+
+	// bytes written and not reclaimed yet
+	inline uint64 UploadRing::Used() const noexcept
+	{ return head - tail; }
+
+	// times Allocate() waited for the copy queue
+	inline uint64 UploadRing::Stalls() const noexcept
+	{ return stalls; }
+}
+
+#endif
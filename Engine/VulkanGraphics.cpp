@@ -0,0 +1,1418 @@
+#include "VulkanGraphics.h"
+
+#ifdef WXE_VULKAN
+
+#include "Error.h"
+#include "Profiler.h"
+#include "StreamCopy.h"
+#include "Utils.h"
+#include <fstream>
+#include <cstring>
+
+// Graphics.h already names the engine window Window at global
+// scope, so Xlib's typedef of the same name is renamed here
+#define Window XlibWindow
+#include <X11/Xlib.h>
+#include <vulkan/vulkan_xlib.h>
+#undef Window
+
+// where the SPIR-V shaders are read from, relative to the working
+// directory unless the build points it at its own output
+#ifndef WXE_SHADER_DIR
+    #define WXE_SHADER_DIR "../Engine/Shaders/"
+#endif
+
+namespace WXE::Vulkan
+{
+    Buffer::Buffer() noexcept :
+        device{ VK_NULL_HANDLE },
+        buffer{ VK_NULL_HANDLE },
+        pool{ nullptr },
+        range{},
+        mapped{ nullptr },
+        size{}
+    {
+    }
+
+    void Buffer::Destroy() noexcept
+    {
+        if (device == VK_NULL_HANDLE)
+            return;
+
+        vkDestroyBuffer(device, buffer, nullptr);
+
+        if (pool)
+            pool->Free(range);
+
+        device = VK_NULL_HANDLE;
+        buffer = VK_NULL_HANDLE;
+        pool = nullptr;
+        mapped = nullptr;
+        size = 0;
+    }
+
+    void Buffer::Release() noexcept
+    {
+        // frames still in flight may be reading from it
+        if (device != VK_NULL_HANDLE)
+            vkDeviceWaitIdle(device);
+
+        Destroy();
+        delete this;
+    }
+
+    QueueFence::QueueFence() noexcept :
+        device{ VK_NULL_HANDLE },
+        queue{ VK_NULL_HANDLE },
+        value{},
+        completed{}
+    {
+    }
+
+    void QueueFence::Initialize(VkDevice device, VkQueue queue) noexcept
+    {
+        this->device = device;
+        this->queue = queue;
+    }
+
+    // the queue must be idle, the fences go with the device
+    void QueueFence::Release() noexcept
+    {
+        for (const Pending& entry : pending)
+            vkDestroyFence(device, entry.fence, nullptr);
+
+        for (VkFence fence : spare)
+            vkDestroyFence(device, fence, nullptr);
+
+        pending.clear();
+        spare.clear();
+    }
+
+    void QueueFence::Retire() const noexcept
+    {
+        // the queue runs in order, so the first pending fence not reached ends it
+        while (!pending.empty() && vkGetFenceStatus(device, pending.front().fence) == VK_SUCCESS)
+        {
+            completed = pending.front().value;
+            vkResetFences(device, 1, &pending.front().fence);
+            spare.push_back(pending.front().fence);
+            pending.pop_front();
+        }
+    }
+
+    uint64 QueueFence::Signal() noexcept
+    {
+        VkFence fence { VK_NULL_HANDLE };
+
+        if (!spare.empty())
+        {
+            fence = spare.back();
+            spare.pop_back();
+        }
+        else
+        {
+            VkFenceCreateInfo fenceInfo {};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+            if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+                return value;
+        }
+
+        // a submission with no work signals once everything before it is done
+        if (vkQueueSubmit(queue, 0, nullptr, fence) != VK_SUCCESS)
+        {
+            spare.push_back(fence);
+            return value;
+        }
+
+        pending.push_back({ ++value, fence });
+        return value;
+    }
+
+    uint64 QueueFence::Completed() const noexcept
+    {
+        Retire();
+        return completed;
+    }
+
+    void QueueFence::Wait(const uint64 value) noexcept
+    {
+        PROFILE_ZONE("WaitFence");
+
+        for (const Pending& entry : pending)
+        {
+            if (entry.value >= value)
+            {
+                vkWaitForFences(device, 1, &entry.fence, VK_TRUE, UINT64_MAX);
+                break;
+            }
+        }
+
+        Retire();
+    }
+
+    Graphics::Graphics() noexcept :
+        window{ nullptr },
+        instance{ VK_NULL_HANDLE },
+        physicalDevice{ VK_NULL_HANDLE },
+        memoryProperties{},
+        device{ VK_NULL_HANDLE },
+        queue{ VK_NULL_HANDLE },
+        queueFamily{},
+        surface{ VK_NULL_HANDLE },
+        swapChain{ VK_NULL_HANDLE },
+        colorFormat{ VK_FORMAT_B8G8R8A8_UNORM },
+        depthFormat{ VK_FORMAT_D32_SFLOAT },
+        extent{},
+        requested{},
+        offscreen{ VK_NULL_HANDLE },
+        offscreenMemory{ VK_NULL_HANDLE },
+        depthImage{ VK_NULL_HANDLE },
+        depthMemory{ VK_NULL_HANDLE },
+        depthView{ VK_NULL_HANDLE },
+        scene{ VK_NULL_HANDLE },
+        sceneMemory{ VK_NULL_HANDLE },
+        sceneView{ VK_NULL_HANDLE },
+        sceneFramebuffer{ VK_NULL_HANDLE },
+        scaled{},
+        renderPass{ VK_NULL_HANDLE },
+        scenePass{ VK_NULL_HANDLE },
+        pipelineLayout{ VK_NULL_HANDLE },
+        pipeline{ VK_NULL_HANDLE },
+        frameIndex{},
+        imageIndex{},
+        lastFrame{ -1 },
+        uploadPool{ VK_NULL_HANDLE },
+        uploadCommands{ VK_NULL_HANDLE },
+        uploadFence{ VK_NULL_HANDLE },
+        copyPools{},
+        copyCommands{},
+        copyOpen{ false },
+        jobs{ nullptr }
+    {
+        backBufferCount = 2;
+        antialiasing = 1;
+        quality = 0;
+        vSync = false;
+        renderScale = 1.0f;
+
+        for (Frame& frame : frames)
+        {
+            frame.pool = VK_NULL_HANDLE;
+            frame.commands = VK_NULL_HANDLE;
+            frame.fence = VK_NULL_HANDLE;
+            frame.acquired = VK_NULL_HANDLE;
+        }
+
+        ZeroMemory(bgColor, sizeof(bgColor));
+        ZeroMemory(&viewport, sizeof(viewport));
+        ZeroMemory(&scissorRect, sizeof(scissorRect));
+    }
+
+    Graphics::~Graphics()
+    {
+        if (device != VK_NULL_HANDLE)
+        {
+            vkDeviceWaitIdle(device);
+
+            DestroyTargets();
+
+            vkDestroyPipeline(device, pipeline, nullptr);
+            vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+            vkDestroyRenderPass(device, renderPass, nullptr);
+            vkDestroyRenderPass(device, scenePass, nullptr);
+
+            // offscreen there is no swap chain extension to call into
+            if (swapChain != VK_NULL_HANDLE)
+                vkDestroySwapchainKHR(device, swapChain, nullptr);
+
+            for (Frame& frame : frames)
+            {
+                vkDestroySemaphore(device, frame.acquired, nullptr);
+                vkDestroyFence(device, frame.fence, nullptr);
+                vkDestroyCommandPool(device, frame.pool, nullptr);
+            }
+
+            vkDestroyFence(device, uploadFence, nullptr);
+            vkDestroyCommandPool(device, uploadPool, nullptr);
+
+            for (VkCommandPool pool : copyPools)
+                vkDestroyCommandPool(device, pool, nullptr);
+
+            copyFence.Release();
+            staging.Destroy();
+
+            for (HeapPool& pool : pools)
+                pool.Release();
+
+            vkDestroyDevice(device, nullptr);
+        }
+
+        if (instance != VK_NULL_HANDLE)
+        {
+            if (surface != VK_NULL_HANDLE)
+                vkDestroySurfaceKHR(instance, surface, nullptr);
+
+            vkDestroyInstance(instance, nullptr);
+        }
+    }
+
+    uint32 Graphics::MemoryType(const uint32 typeBits, const VkMemoryPropertyFlags flags) const
+    {
+        for (uint32 i = 0; i < memoryProperties.memoryTypeCount; ++i)
+        {
+            if ((typeBits & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & flags) == flags)
+                return i;
+        }
+
+        ThrowIfFailed(VK_ERROR_OUT_OF_DEVICE_MEMORY);
+        return 0;
+    }
+
+    // ---------------------------------------------------
+    // One pool per memory type; buffers are bound at an
+    // offset inside a pooled heap instead of getting a
+    // vkAllocateMemory each (drivers cap those at 4096)
+    // ---------------------------------------------------
+
+    void Graphics::CreatePools()
+    {
+        for (uint32 type = 0; type < memoryProperties.memoryTypeCount; ++type)
+        {
+            pools[type].Initialize(
+                [this, type](uint64 size) -> void*
+                {
+                    Heap* heap = new Heap { VK_NULL_HANDLE, nullptr };
+
+                    VkMemoryAllocateInfo allocInfo {};
+                    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+                    allocInfo.allocationSize = size;
+                    allocInfo.memoryTypeIndex = type;
+
+                    VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, &heap->memory);
+
+                    if (result == VK_SUCCESS && (memoryProperties.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+                        result = vkMapMemory(device, heap->memory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&heap->mapped));
+
+                    if (result != VK_SUCCESS)
+                    {
+                        vkFreeMemory(device, heap->memory, nullptr);
+                        delete heap;
+                        ThrowIfFailed(result);
+                    }
+
+                    return heap;
+                },
+                [this](void* handle)
+                {
+                    // freeing mapped memory unmaps it
+                    Heap* heap = static_cast<Heap*>(handle);
+                    vkFreeMemory(device, heap->memory, nullptr);
+                    delete heap;
+                });
+        }
+    }
+
+    void Graphics::CreateBuffer(const uint32 sizeInBytes, const VkBufferUsageFlags usage,
+        const VkMemoryPropertyFlags flags, Buffer* buffer)
+    {
+        VkBufferCreateInfo bufferInfo {};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = sizeInBytes;
+        bufferInfo.usage = usage;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        ThrowIfFailed(vkCreateBuffer(device, &bufferInfo, nullptr, &buffer->buffer));
+
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(device, buffer->buffer, &requirements);
+
+        HeapPool& pool = pools[MemoryType(requirements.memoryTypeBits, flags)];
+
+        if (!pool.Allocate(requirements.size, requirements.alignment, &buffer->range))
+            ThrowIfFailed(VK_ERROR_OUT_OF_DEVICE_MEMORY);
+
+        buffer->pool = &pool;
+
+        Heap* heap = static_cast<Heap*>(buffer->range.heap);
+        ThrowIfFailed(vkBindBufferMemory(device, buffer->buffer, heap->memory, buffer->range.offset));
+
+        // host visible heaps stay mapped, the buffer points into its range
+        if (heap->mapped)
+            buffer->mapped = heap->mapped + buffer->range.offset;
+
+        buffer->device = device;
+        buffer->size = sizeInBytes;
+    }
+
+    void Graphics::CreateImage(const VkFormat format, const VkImageUsageFlags usage,
+        VkImage* image, VkDeviceMemory* memory) const
+    {
+        VkImageCreateInfo imageInfo {};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = format;
+        imageInfo.extent = { extent.width, extent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        ThrowIfFailed(vkCreateImage(device, &imageInfo, nullptr, image));
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(device, *image, &requirements);
+
+        VkMemoryAllocateInfo allocInfo {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = requirements.size;
+        allocInfo.memoryTypeIndex = MemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        ThrowIfFailed(vkAllocateMemory(device, &allocInfo, nullptr, memory));
+        ThrowIfFailed(vkBindImageMemory(device, *image, *memory, 0));
+    }
+
+    VkImageView Graphics::CreateView(const VkImage image, const VkFormat format, const VkImageAspectFlags aspect) const
+    {
+        VkImageViewCreateInfo viewInfo {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.subresourceRange = { aspect, 0, 1, 0, 1 };
+
+        VkImageView view;
+        ThrowIfFailed(vkCreateImageView(device, &viewInfo, nullptr, &view));
+        return view;
+    }
+
+    VkShaderModule Graphics::LoadShader(const char* fileName) const
+    {
+        std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+
+        if (!file)
+            ThrowIfFailed(VK_ERROR_INITIALIZATION_FAILED);
+
+        // SPIR-V is a stream of 32-bit words
+        std::vector<uint32> code(static_cast<size_t>(file.tellg()) / sizeof(uint32));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(code.data()), code.size() * sizeof(uint32));
+
+        VkShaderModuleCreateInfo moduleInfo {};
+        moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        moduleInfo.codeSize = code.size() * sizeof(uint32);
+        moduleInfo.pCode = code.data();
+
+        VkShaderModule module;
+        ThrowIfFailed(vkCreateShaderModule(device, &moduleInfo, nullptr, &module));
+        return module;
+    }
+
+    void Graphics::SelectDevice()
+    {
+        uint32 count {};
+        ThrowIfFailed(vkEnumeratePhysicalDevices(instance, &count, nullptr));
+
+        std::vector<VkPhysicalDevice> devices(count);
+        ThrowIfFailed(vkEnumeratePhysicalDevices(instance, &count, devices.data()));
+
+        // -----------------------------------------------
+        // Hardware first; a CPU implementation such as
+        // lavapipe is only taken when nothing else is there
+        // -----------------------------------------------
+
+        auto rank = [](const VkPhysicalDeviceType type) noexcept -> int32
+        {
+            switch (type)
+            {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return 4;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 3;
+            case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return 2;
+            case VK_PHYSICAL_DEVICE_TYPE_CPU: return 1;
+            default: return 0;
+            }
+        };
+
+        int32 best { -1 };
+
+        for (VkPhysicalDevice candidate : devices)
+        {
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(candidate, &properties);
+
+            if (properties.apiVersion < VK_API_VERSION_1_1 || rank(properties.deviceType) <= best)
+                continue;
+
+            uint32 familyCount {};
+            vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, nullptr);
+
+            std::vector<VkQueueFamilyProperties> families(familyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, families.data());
+
+            for (uint32 i = 0; i < familyCount; ++i)
+            {
+                if (!(families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+                    continue;
+
+                VkBool32 present { VK_TRUE };
+                if (surface != VK_NULL_HANDLE)
+                    vkGetPhysicalDeviceSurfaceSupportKHR(candidate, i, surface, &present);
+
+                if (present)
+                {
+                    physicalDevice = candidate;
+                    queueFamily = i;
+                    best = rank(properties.deviceType);
+                    break;
+                }
+            }
+        }
+
+        if (physicalDevice == VK_NULL_HANDLE)
+            ThrowIfFailed(VK_ERROR_INCOMPATIBLE_DRIVER);
+
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+    }
+
+    void Graphics::Initialize(Window* window, JobSystem* jobs)
+    {
+        this->window = window;
+        this->jobs = jobs;
+
+        uint32 color { window->Color() };
+        bgColor[0] = ((color >> 16) & 0xFF) / 255.0f;
+        bgColor[1] = ((color >> 8) & 0xFF) / 255.0f;
+        bgColor[2] = (color & 0xFF) / 255.0f;
+        bgColor[3] = 1.0f;
+
+        // without a display the frames are rendered offscreen and read back
+        bool presentable { window->XDisplay() != nullptr };
+
+        // ---------------------------------------------------
+        // Instance
+        // ---------------------------------------------------
+
+        VkApplicationInfo appInfo {};
+        appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        appInfo.pApplicationName = window->Title().c_str();
+        appInfo.pEngineName = "WXE";
+        appInfo.apiVersion = VK_API_VERSION_1_1;
+
+        const char* instanceExtensions[] = { VK_KHR_SURFACE_EXTENSION_NAME, VK_KHR_XLIB_SURFACE_EXTENSION_NAME };
+
+        VkInstanceCreateInfo instanceInfo {};
+        instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        instanceInfo.pApplicationInfo = &appInfo;
+        instanceInfo.enabledExtensionCount = presentable ? 2 : 0;
+        instanceInfo.ppEnabledExtensionNames = instanceExtensions;
+
+    #ifdef _DEBUG
+        // validation is turned on when the layer is installed
+        const char* validation { "VK_LAYER_KHRONOS_validation" };
+
+        uint32 layerCount {};
+        vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+        std::vector<VkLayerProperties> layers(layerCount);
+        vkEnumerateInstanceLayerProperties(&layerCount, layers.data());
+
+        for (const VkLayerProperties& layer : layers)
+        {
+            if (strcmp(layer.layerName, validation) == 0)
+            {
+                instanceInfo.enabledLayerCount = 1;
+                instanceInfo.ppEnabledLayerNames = &validation;
+            }
+        }
+    #endif
+
+        ThrowIfFailed(vkCreateInstance(&instanceInfo, nullptr, &instance));
+
+        if (presentable)
+        {
+            VkXlibSurfaceCreateInfoKHR surfaceInfo {};
+            surfaceInfo.sType = VK_STRUCTURE_TYPE_XLIB_SURFACE_CREATE_INFO_KHR;
+            surfaceInfo.dpy = window->XDisplay();
+            surfaceInfo.window = window->Id();
+
+            ThrowIfFailed(vkCreateXlibSurfaceKHR(instance, &surfaceInfo, nullptr, &surface));
+        }
+
+        // ---------------------------------------------------
+        // Device and Queue
+        // ---------------------------------------------------
+
+        SelectDevice();
+
+        float priority { 1.0f };
+
+        VkDeviceQueueCreateInfo queueInfo {};
+        queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueInfo.queueFamilyIndex = queueFamily;
+        queueInfo.queueCount = 1;
+        queueInfo.pQueuePriorities = &priority;
+
+        const char* deviceExtensions[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+
+        VkDeviceCreateInfo deviceInfo {};
+        deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        deviceInfo.queueCreateInfoCount = 1;
+        deviceInfo.pQueueCreateInfos = &queueInfo;
+        deviceInfo.enabledExtensionCount = presentable ? 1 : 0;
+        deviceInfo.ppEnabledExtensionNames = deviceExtensions;
+
+        ThrowIfFailed(vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device));
+        vkGetDeviceQueue(device, queueFamily, 0, &queue);
+
+        CreatePools();
+
+        // ---------------------------------------------------
+        // Formats
+        // ---------------------------------------------------
+
+        for (VkFormat format : { VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D16_UNORM })
+        {
+            VkFormatProperties properties;
+            vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+
+            if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+            {
+                depthFormat = format;
+                break;
+            }
+        }
+
+        if (presentable)
+        {
+            uint32 formatCount {};
+            vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &formatCount, nullptr);
+            std::vector<VkSurfaceFormatKHR> formats(formatCount);
+            vkGetPhysicalDeviceSurfaceFormatsKHR(physicalDevice, surface, &formatCount, formats.data());
+
+            // the same unorm layout as the DX12 back buffers, else whatever comes first
+            colorFormat = formatCount ? formats[0].format : VK_FORMAT_B8G8R8A8_UNORM;
+
+            for (const VkSurfaceFormatKHR& format : formats)
+            {
+                if (format.format == VK_FORMAT_B8G8R8A8_UNORM || format.format == VK_FORMAT_R8G8B8A8_UNORM)
+                {
+                    colorFormat = format.format;
+                    break;
+                }
+            }
+        }
+
+        // ---------------------------------------------------
+        // Frames in Flight
+        // ---------------------------------------------------
+
+        VkCommandPoolCreateInfo poolInfo {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        poolInfo.queueFamilyIndex = queueFamily;
+
+        VkCommandBufferAllocateInfo commandsInfo {};
+        commandsInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandsInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        commandsInfo.commandBufferCount = 1;
+
+        // frames start signaled so the first Clear() does not wait
+        VkFenceCreateInfo fenceInfo {};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+        VkSemaphoreCreateInfo semaphoreInfo {};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        for (Frame& frame : frames)
+        {
+            ThrowIfFailed(vkCreateCommandPool(device, &poolInfo, nullptr, &frame.pool));
+            commandsInfo.commandPool = frame.pool;
+            ThrowIfFailed(vkAllocateCommandBuffers(device, &commandsInfo, &frame.commands));
+            ThrowIfFailed(vkCreateFence(device, &fenceInfo, nullptr, &frame.fence));
+            ThrowIfFailed(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &frame.acquired));
+        }
+
+        ThrowIfFailed(vkCreateCommandPool(device, &poolInfo, nullptr, &uploadPool));
+        commandsInfo.commandPool = uploadPool;
+        ThrowIfFailed(vkAllocateCommandBuffers(device, &commandsInfo, &uploadCommands));
+
+        fenceInfo.flags = 0;
+        ThrowIfFailed(vkCreateFence(device, &fenceInfo, nullptr, &uploadFence));
+
+        // ---------------------------------------------------
+        // Upload batches and staging ring
+        // ---------------------------------------------------
+
+        for (uint32 i = 0; i < COPY_BATCHES; ++i)
+        {
+            ThrowIfFailed(vkCreateCommandPool(device, &poolInfo, nullptr, &copyPools[i]));
+            commandsInfo.commandPool = copyPools[i];
+            ThrowIfFailed(vkAllocateCommandBuffers(device, &commandsInfo, &copyCommands[i]));
+        }
+
+        copyFence.Initialize(device, queue);
+        copyBatches.Initialize(&copyFence, COPY_BATCHES);
+
+        CreateBuffer(STAGING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &staging);
+        uploads.Initialize(&copyFence, STAGING_SIZE);
+
+        // ---------------------------------------------------
+        // Render Pass
+        // ---------------------------------------------------
+
+        VkAttachmentDescription attachments[2] {};
+
+        attachments[0].format = colorFormat;
+        attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+        attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachments[0].finalLayout = presentable ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        attachments[1].format = depthFormat;
+        attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+        attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference colorRef { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+        VkAttachmentReference depthRef { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+        VkSubpassDescription subpass {};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &colorRef;
+        subpass.pDepthStencilAttachment = &depthRef;
+
+        // the previous frame may still be writing (or copying out of) the
+        // same color and depth images when this one starts clearing them
+        VkSubpassDependency dependency {};
+        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependency.dstSubpass = 0;
+        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+            | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+        dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+            | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+            | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+        VkRenderPassCreateInfo passInfo {};
+        passInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        passInfo.attachmentCount = 2;
+        passInfo.pAttachments = attachments;
+        passInfo.subpassCount = 1;
+        passInfo.pSubpasses = &subpass;
+        passInfo.dependencyCount = 1;
+        passInfo.pDependencies = &dependency;
+
+        ThrowIfFailed(vkCreateRenderPass(device, &passInfo, nullptr, &renderPass));
+
+        // the scene pass only differs in the final layout, so the pipeline suits both
+        if (presentable)
+        {
+            attachments[0].finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            ThrowIfFailed(vkCreateRenderPass(device, &passInfo, nullptr, &scenePass));
+        }
+
+        CreateTargets();
+        CreatePipeline();
+    }
+
+    void Graphics::CreateTargets()
+    {
+        requested = { uint32(window->Width()), uint32(window->Height()) };
+
+        extent.width = requested.width ? requested.width : 1;
+        extent.height = requested.height ? requested.height : 1;
+
+        if (surface != VK_NULL_HANDLE)
+        {
+            VkSurfaceCapabilitiesKHR caps;
+            ThrowIfFailed(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physicalDevice, surface, &caps));
+
+            // the surface size wins when the platform fixes it
+            if (caps.currentExtent.width != UINT32_MAX)
+                extent = caps.currentExtent;
+
+            uint32 imageCount = backBufferCount > caps.minImageCount ? backBufferCount : caps.minImageCount;
+            if (caps.maxImageCount && imageCount > caps.maxImageCount)
+                imageCount = caps.maxImageCount;
+
+            // -----------------------------------------------
+            // FIFO waits for the vertical blank; otherwise
+            // MAILBOX, or IMMEDIATE when that is not offered
+            // -----------------------------------------------
+
+            VkPresentModeKHR presentMode { VK_PRESENT_MODE_FIFO_KHR };
+
+            if (!vSync)
+            {
+                uint32 modeCount {};
+                vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &modeCount, nullptr);
+                std::vector<VkPresentModeKHR> modes(modeCount);
+                vkGetPhysicalDeviceSurfacePresentModesKHR(physicalDevice, surface, &modeCount, modes.data());
+
+                for (VkPresentModeKHR mode : modes)
+                {
+                    if (mode == VK_PRESENT_MODE_MAILBOX_KHR)
+                        presentMode = mode;
+                    else if (mode == VK_PRESENT_MODE_IMMEDIATE_KHR && presentMode == VK_PRESENT_MODE_FIFO_KHR)
+                        presentMode = mode;
+                }
+            }
+
+            VkSwapchainKHR oldSwapChain { swapChain };
+
+            VkSwapchainCreateInfoKHR swapInfo {};
+            swapInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+            swapInfo.surface = surface;
+            swapInfo.minImageCount = imageCount;
+            swapInfo.imageFormat = colorFormat;
+            swapInfo.imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+            swapInfo.imageExtent = extent;
+            swapInfo.imageArrayLayers = 1;
+            swapInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            swapInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            swapInfo.preTransform = caps.currentTransform;
+            swapInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+            swapInfo.presentMode = presentMode;
+            swapInfo.clipped = VK_TRUE;
+            swapInfo.oldSwapchain = oldSwapChain;
+
+            ThrowIfFailed(vkCreateSwapchainKHR(device, &swapInfo, nullptr, &swapChain));
+
+            if (oldSwapChain != VK_NULL_HANDLE)
+                vkDestroySwapchainKHR(device, oldSwapChain, nullptr);
+
+            uint32 count {};
+            ThrowIfFailed(vkGetSwapchainImagesKHR(device, swapChain, &count, nullptr));
+            images.resize(count);
+            ThrowIfFailed(vkGetSwapchainImagesKHR(device, swapChain, &count, images.data()));
+
+            // one per image: a present can still be waiting on it when
+            // the frame that signaled it comes around again
+            VkSemaphoreCreateInfo semaphoreInfo {};
+            semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+            rendered.resize(count);
+            for (VkSemaphore& semaphore : rendered)
+                ThrowIfFailed(vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore));
+
+            // scaled frames are drawn here first, in its top left corner
+            CreateImage(colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                &scene, &sceneMemory);
+        }
+        else
+        {
+            CreateImage(colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                &offscreen, &offscreenMemory);
+
+            images.assign(1, offscreen);
+
+            // each frame in flight copies into its own readback buffer
+            for (Frame& frame : frames)
+            {
+                CreateBuffer(extent.width * extent.height * sizeof(uint32), VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frame.readback);
+            }
+        }
+
+        CreateImage(depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, &depthImage, &depthMemory);
+        depthView = CreateView(depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+
+        views.resize(images.size());
+        framebuffers.resize(images.size());
+
+        for (size_t i = 0; i < images.size(); ++i)
+        {
+            views[i] = CreateView(images[i], colorFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+
+            VkImageView attachments[] = { views[i], depthView };
+
+            VkFramebufferCreateInfo framebufferInfo {};
+            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass = renderPass;
+            framebufferInfo.attachmentCount = 2;
+            framebufferInfo.pAttachments = attachments;
+            framebufferInfo.width = extent.width;
+            framebufferInfo.height = extent.height;
+            framebufferInfo.layers = 1;
+
+            ThrowIfFailed(vkCreateFramebuffer(device, &framebufferInfo, nullptr, &framebuffers[i]));
+        }
+
+        if (scene != VK_NULL_HANDLE)
+        {
+            sceneView = CreateView(scene, colorFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+
+            VkImageView attachments[] = { sceneView, depthView };
+
+            VkFramebufferCreateInfo framebufferInfo {};
+            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass = scenePass;
+            framebufferInfo.attachmentCount = 2;
+            framebufferInfo.pAttachments = attachments;
+            framebufferInfo.width = extent.width;
+            framebufferInfo.height = extent.height;
+            framebufferInfo.layers = 1;
+
+            ThrowIfFailed(vkCreateFramebuffer(device, &framebufferInfo, nullptr, &sceneFramebuffer));
+        }
+
+        viewport.TopLeftX = {};
+        viewport.TopLeftY = {};
+        viewport.Width = static_cast<float>(extent.width);
+        viewport.Height = static_cast<float>(extent.height);
+        viewport.MinDepth = {};
+        viewport.MaxDepth = 1.0f;
+
+        scissorRect = { 0, 0, static_cast<int32>(extent.width), static_cast<int32>(extent.height) };
+
+        lastFrame = -1;
+    }
+
+    // the swap chain itself is kept, it is handed over when targets are rebuilt
+    void Graphics::DestroyTargets() noexcept
+    {
+        for (VkFramebuffer framebuffer : framebuffers)
+            vkDestroyFramebuffer(device, framebuffer, nullptr);
+
+        for (VkImageView view : views)
+            vkDestroyImageView(device, view, nullptr);
+
+        for (VkSemaphore semaphore : rendered)
+            vkDestroySemaphore(device, semaphore, nullptr);
+
+        framebuffers.clear();
+        views.clear();
+        rendered.clear();
+        images.clear();
+
+        vkDestroyImageView(device, depthView, nullptr);
+        vkDestroyImage(device, depthImage, nullptr);
+        vkFreeMemory(device, depthMemory, nullptr);
+
+        vkDestroyImage(device, offscreen, nullptr);
+        vkFreeMemory(device, offscreenMemory, nullptr);
+
+        vkDestroyFramebuffer(device, sceneFramebuffer, nullptr);
+        vkDestroyImageView(device, sceneView, nullptr);
+        vkDestroyImage(device, scene, nullptr);
+        vkFreeMemory(device, sceneMemory, nullptr);
+
+        depthView = VK_NULL_HANDLE;
+        depthImage = VK_NULL_HANDLE;
+        depthMemory = VK_NULL_HANDLE;
+        offscreen = VK_NULL_HANDLE;
+        offscreenMemory = VK_NULL_HANDLE;
+        sceneFramebuffer = VK_NULL_HANDLE;
+        sceneView = VK_NULL_HANDLE;
+        scene = VK_NULL_HANDLE;
+        sceneMemory = VK_NULL_HANDLE;
+
+        for (Frame& frame : frames)
+            frame.readback.Destroy();
+    }
+
+    void Graphics::CreatePipeline()
+    {
+        // ---------------------------------------------------
+        // The HLSL shaders of the DX12 path, compiled to
+        // SPIR-V by the build (glslangValidator or dxc)
+        // into WXE_SHADER_DIR
+        // ---------------------------------------------------
+
+        VkShaderModule vertexShader { LoadShader(WXE_SHADER_DIR "Vertex.spv") };
+        VkShaderModule pixelShader { LoadShader(WXE_SHADER_DIR "Pixel.spv") };
+
+        VkPipelineShaderStageCreateInfo stages[2] {};
+        stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        stages[0].module = vertexShader;
+        stages[0].pName = "main";
+        stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        stages[1].module = pixelShader;
+        stages[1].pName = "main";
+
+        // same input layout as the DX12 pipeline: POSITION at 0, COLOR at 12
+        VkVertexInputBindingDescription binding { 0, sizeof(Rasterizer::Vertex), VK_VERTEX_INPUT_RATE_VERTEX };
+
+        VkVertexInputAttributeDescription attributes[] =
+        {
+            { 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+            { 1, 0, VK_FORMAT_R32G32B32A32_SFLOAT, 12 }
+        };
+
+        VkPipelineVertexInputStateCreateInfo inputInfo {};
+        inputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        inputInfo.vertexBindingDescriptionCount = 1;
+        inputInfo.pVertexBindingDescriptions = &binding;
+        inputInfo.vertexAttributeDescriptionCount = 2;
+        inputInfo.pVertexAttributeDescriptions = attributes;
+
+        VkPipelineInputAssemblyStateCreateInfo assemblyInfo {};
+        assemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        assemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+        VkPipelineViewportStateCreateInfo viewportInfo {};
+        viewportInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        viewportInfo.viewportCount = 1;
+        viewportInfo.scissorCount = 1;
+
+        // Clear() flips the viewport, so clockwise is front as in D3D
+        VkPipelineRasterizationStateCreateInfo rasterInfo {};
+        rasterInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        rasterInfo.polygonMode = VK_POLYGON_MODE_FILL;
+        rasterInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+        rasterInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
+        rasterInfo.lineWidth = 1.0f;
+
+        VkPipelineMultisampleStateCreateInfo multisampleInfo {};
+        multisampleInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        multisampleInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+        VkPipelineDepthStencilStateCreateInfo depthInfo {};
+        depthInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depthInfo.depthTestEnable = VK_TRUE;
+        depthInfo.depthWriteEnable = VK_TRUE;
+        depthInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+
+        VkPipelineColorBlendAttachmentState blendAttachment {};
+        blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT
+            | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+        VkPipelineColorBlendStateCreateInfo blendInfo {};
+        blendInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        blendInfo.attachmentCount = 1;
+        blendInfo.pAttachments = &blendAttachment;
+
+        // viewport and scissor follow the window, no rebuild on resize
+        VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+        VkPipelineDynamicStateCreateInfo dynamicInfo {};
+        dynamicInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        dynamicInfo.dynamicStateCount = 2;
+        dynamicInfo.pDynamicStates = dynamicStates;
+
+        VkPipelineLayoutCreateInfo layoutInfo {};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        ThrowIfFailed(vkCreatePipelineLayout(device, &layoutInfo, nullptr, &pipelineLayout));
+
+        VkGraphicsPipelineCreateInfo pipelineInfo {};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipelineInfo.stageCount = 2;
+        pipelineInfo.pStages = stages;
+        pipelineInfo.pVertexInputState = &inputInfo;
+        pipelineInfo.pInputAssemblyState = &assemblyInfo;
+        pipelineInfo.pViewportState = &viewportInfo;
+        pipelineInfo.pRasterizationState = &rasterInfo;
+        pipelineInfo.pMultisampleState = &multisampleInfo;
+        pipelineInfo.pDepthStencilState = &depthInfo;
+        pipelineInfo.pColorBlendState = &blendInfo;
+        pipelineInfo.pDynamicState = &dynamicInfo;
+        pipelineInfo.layout = pipelineLayout;
+        pipelineInfo.renderPass = renderPass;
+        pipelineInfo.subpass = 0;
+
+        VkResult result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+
+        vkDestroyShaderModule(device, vertexShader, nullptr);
+        vkDestroyShaderModule(device, pixelShader, nullptr);
+
+        ThrowIfFailed(result);
+    }
+
+    void Graphics::Clear()
+    {
+        PROFILE_ZONE("Clear");
+
+        Frame& frame = frames[frameIndex];
+
+        // only the frame being reused is waited for, the other keeps running
+        vkWaitForFences(device, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+
+        // uploads recorded since the last frame go out ahead of it
+        SubmitUploads();
+        uploads.Reclaim();
+
+        // a resized window is picked up at the start of a frame
+        bool resized { requested.width != uint32(window->Width()) || requested.height != uint32(window->Height()) };
+
+        VkResult result { VK_SUCCESS };
+
+        if (surface != VK_NULL_HANDLE && !resized)
+            result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, frame.acquired, VK_NULL_HANDLE, &imageIndex);
+
+        if (resized || result == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            vkDeviceWaitIdle(device);
+            DestroyTargets();
+            CreateTargets();
+
+            if (surface != VK_NULL_HANDLE)
+                result = vkAcquireNextImageKHR(device, swapChain, UINT64_MAX, frame.acquired, VK_NULL_HANDLE, &imageIndex);
+        }
+
+        // VK_SUBOPTIMAL_KHR still presents, the next resize fixes it
+        ThrowIfFailed(result);
+
+        if (surface == VK_NULL_HANDLE)
+            imageIndex = 0;
+
+        // -----------------------------------------------
+        // The render scale shrinks the area drawn to. With
+        // a swap chain that area lives in the scene image
+        // and Present() stretches it over the window
+        // -----------------------------------------------
+
+        uint32 renderWidth = Scaled(extent.width);
+        uint32 renderHeight = Scaled(extent.height);
+
+        viewport.Width = static_cast<float>(renderWidth);
+        viewport.Height = static_cast<float>(renderHeight);
+        scissorRect = { 0, 0, static_cast<int32>(renderWidth), static_cast<int32>(renderHeight) };
+
+        scaled = scene != VK_NULL_HANDLE && (renderWidth != extent.width || renderHeight != extent.height);
+
+        vkResetFences(device, 1, &frame.fence);
+        vkResetCommandPool(device, frame.pool, 0);
+
+        VkCommandBufferBeginInfo beginInfo {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        ThrowIfFailed(vkBeginCommandBuffer(frame.commands, &beginInfo));
+
+        VkClearValue clearValues[2] {};
+        memcpy(clearValues[0].color.float32, bgColor, sizeof(bgColor));
+        clearValues[1].depthStencil = { 1.0f, 0 };
+
+        VkRenderPassBeginInfo passInfo {};
+        passInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        passInfo.renderPass = scaled ? scenePass : renderPass;
+        passInfo.framebuffer = scaled ? sceneFramebuffer : framebuffers[imageIndex];
+        passInfo.renderArea = { { 0, 0 }, { renderWidth, renderHeight } };
+        passInfo.clearValueCount = 2;
+        passInfo.pClearValues = clearValues;
+
+        vkCmdBeginRenderPass(frame.commands, &passInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        // negative height puts +Y up in clip space, as in D3D,
+        // so the shaders and vertex data are shared unchanged
+        VkViewport view {
+            viewport.TopLeftX,
+            viewport.TopLeftY + viewport.Height,
+            viewport.Width,
+            -viewport.Height,
+            viewport.MinDepth,
+            viewport.MaxDepth
+        };
+
+        VkRect2D scissor {
+            { scissorRect.left, scissorRect.top },
+            { uint32(scissorRect.right - scissorRect.left), uint32(scissorRect.bottom - scissorRect.top) }
+        };
+
+        vkCmdSetViewport(frame.commands, 0, 1, &view);
+        vkCmdSetScissor(frame.commands, 0, 1, &scissor);
+        vkCmdBindPipeline(frame.commands, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    }
+
+    void Graphics::Present()
+    {
+        PROFILE_ZONE("Present");
+
+        Frame& frame = frames[frameIndex];
+
+        vkCmdEndRenderPass(frame.commands);
+
+        uint32 renderWidth = RenderWidth();
+        uint32 renderHeight = RenderHeight();
+
+        if (scaled)
+        {
+            // -----------------------------------------------
+            // The scene pass left the scene image in TRANSFER_SRC
+            // layout; the swap chain image is blitted into whole
+            // and handed back to the presentation engine
+            // -----------------------------------------------
+
+            VkImageMemoryBarrier barrier {};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = images[imageIndex];
+            barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+            vkCmdPipelineBarrier(frame.commands, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+            VkImageBlit blit {};
+            blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+            blit.srcOffsets[1] = { int32(renderWidth), int32(renderHeight), 1 };
+            blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+            blit.dstOffsets[1] = { int32(extent.width), int32(extent.height), 1 };
+
+            vkCmdBlitImage(frame.commands, scene, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                images[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = 0;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+            vkCmdPipelineBarrier(frame.commands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+
+        if (surface == VK_NULL_HANDLE)
+        {
+            // the render pass left the image in TRANSFER_SRC layout;
+            // only the rendered corner is copied, rows keep the full pitch
+            VkBufferImageCopy region {};
+            region.bufferRowLength = extent.width;
+            region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+            region.imageExtent = { renderWidth, renderHeight, 1 };
+
+            vkCmdCopyImageToBuffer(frame.commands, offscreen, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                frame.readback.buffer, 1, &region);
+
+            VkBufferMemoryBarrier barrier {};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.buffer = frame.readback.buffer;
+            barrier.size = VK_WHOLE_SIZE;
+
+            vkCmdPipelineBarrier(frame.commands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                0, 0, nullptr, 1, &barrier, 0, nullptr);
+        }
+
+        ThrowIfFailed(vkEndCommandBuffer(frame.commands));
+
+        // a scaled frame first touches the swap chain image in the blit
+        VkPipelineStageFlags waitStage { scaled ? VK_PIPELINE_STAGE_TRANSFER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+
+        VkSubmitInfo submitInfo {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &frame.commands;
+
+        if (surface != VK_NULL_HANDLE)
+        {
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores = &frame.acquired;
+            submitInfo.pWaitDstStageMask = &waitStage;
+            submitInfo.signalSemaphoreCount = 1;
+            submitInfo.pSignalSemaphores = &rendered[imageIndex];
+        }
+
+        ThrowIfFailed(vkQueueSubmit(queue, 1, &submitInfo, frame.fence));
+
+        if (surface != VK_NULL_HANDLE)
+        {
+            VkPresentInfoKHR presentInfo {};
+            presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+            presentInfo.waitSemaphoreCount = 1;
+            presentInfo.pWaitSemaphores = &rendered[imageIndex];
+            presentInfo.swapchainCount = 1;
+            presentInfo.pSwapchains = &swapChain;
+            presentInfo.pImageIndices = &imageIndex;
+
+            // an out of date swap chain is rebuilt by the next Clear()
+            VkResult result = vkQueuePresentKHR(queue, &presentInfo);
+
+            if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+                requested = {};
+            else
+                ThrowIfFailed(result);
+        }
+
+        lastFrame = int32(frameIndex);
+        frameIndex = (frameIndex + 1) % FRAMES_IN_FLIGHT;
+    }
+
+    void Graphics::ResetCommands()
+    {
+        ThrowIfFailed(vkResetCommandPool(device, uploadPool, 0));
+
+        VkCommandBufferBeginInfo beginInfo {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        ThrowIfFailed(vkBeginCommandBuffer(uploadCommands, &beginInfo));
+    }
+
+    void Graphics::SubmitCommands()
+    {
+        SubmitUploads();
+
+        ThrowIfFailed(vkEndCommandBuffer(uploadCommands));
+
+        VkSubmitInfo submitInfo {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &uploadCommands;
+
+        // uploads complete before the call returns, as in the DX12 path
+        ThrowIfFailed(vkQueueSubmit(queue, 1, &submitInfo, uploadFence));
+        ThrowIfFailed(vkWaitForFences(device, 1, &uploadFence, VK_TRUE, UINT64_MAX));
+        ThrowIfFailed(vkResetFences(device, 1, &uploadFence));
+    }
+
+    void Graphics::Allocate(const uint32 sizeInBytes, Buffer** resource)
+    {
+        Allocate(UPLOAD, sizeInBytes, resource);
+    }
+
+    void Graphics::Allocate(const uint32 type, const uint32 sizeInBytes, Buffer** resource)
+    {
+        Buffer* buffer = new Buffer();
+
+        try
+        {
+            if (type == GPU)
+                CreateBuffer(sizeInBytes, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer);
+            else
+                CreateBuffer(sizeInBytes, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer);
+        }
+        catch (...)
+        {
+            buffer->device = device;
+            buffer->Destroy();
+            delete buffer;
+            throw;
+        }
+
+        *resource = buffer;
+    }
+
+    void Graphics::Copy(const void* vertices, const uint32 sizeInBytes, Buffer* bufferCPU) const noexcept
+    {
+        StreamCopy(bufferCPU->Data(), vertices, sizeInBytes < bufferCPU->Size() ? sizeInBytes : bufferCPU->Size(), jobs);
+    }
+
+    // ---------------------------------------------------
+    // Copies go through the staging ring, a piece at a time
+    // when the data is larger than the ring. If the space
+    // is held by the batch still being recorded, the batch
+    // is submitted and the ring waits for it.
+    // ---------------------------------------------------
+
+    void Graphics::Upload(const void* data, const uint32 sizeInBytes, Buffer* bufferGPU, const uint64 offset) noexcept
+    {
+        PROFILE_ZONE("Upload");
+
+        const uint8* source = static_cast<const uint8*>(data);
+        uint64 done {};
+
+        while (done < sizeInBytes)
+        {
+            uint64 piece = (sizeInBytes - done < uploads.Capacity()) ? sizeInBytes - done : uploads.Capacity();
+            uint64 stagingOffset {};
+
+            if (!uploads.Allocate(piece, 16, &stagingOffset))
+            {
+                SubmitUploads();
+                uploads.Allocate(piece, 16, &stagingOffset);
+            }
+
+            if (!copyOpen)
+            {
+                // waits only if this pool's last batch is still copying
+                uint32 batch = copyBatches.Begin();
+                vkResetCommandPool(device, copyPools[batch], 0);
+
+                VkCommandBufferBeginInfo beginInfo {};
+                beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+                vkBeginCommandBuffer(copyCommands[batch], &beginInfo);
+
+                copyOpen = true;
+            }
+
+            StreamCopy(static_cast<uint8*>(staging.mapped) + stagingOffset, source + done, static_cast<size_t>(piece), jobs);
+
+            VkBufferCopy region { stagingOffset, offset + done, piece };
+            vkCmdCopyBuffer(copyCommands[copyBatches.Index()], staging.buffer, bufferGPU->buffer, 1, &region);
+
+            done += piece;
+        }
+    }
+
+    void Graphics::SubmitUploads() noexcept
+    {
+        if (!copyOpen)
+            return;
+
+        PROFILE_ZONE("SubmitUploads");
+
+        VkCommandBuffer commands = copyCommands[copyBatches.Index()];
+
+        // one barrier for the whole batch; it covers every later submission
+        VkMemoryBarrier barrier {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+        vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+            0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        vkEndCommandBuffer(commands);
+
+        VkSubmitInfo submitInfo {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commands;
+
+        vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+
+        uploads.Close(copyBatches.End());
+        copyOpen = false;
+    }
+
+    void Graphics::Draw(const Buffer* vertices, const uint32 stride, const uint32 count) noexcept
+    {
+        // the pipeline is built for the default vertex layout
+        if (stride != sizeof(Rasterizer::Vertex))
+            return;
+
+        uint32 available = vertices->Size() / stride;
+
+        VkCommandBuffer commands { frames[frameIndex].commands };
+        VkDeviceSize offset {};
+
+        vkCmdBindVertexBuffers(commands, 0, 1, &vertices->buffer, &offset);
+        vkCmdDraw(commands, count < available ? count : available, 1, 0, 0);
+    }
+
+    const uint32* Graphics::Pixels() noexcept
+    {
+        if (surface != VK_NULL_HANDLE || lastFrame < 0)
+            return nullptr;
+
+        // the last frame submitted is the one read back
+        Frame& frame = frames[lastFrame];
+        vkWaitForFences(device, 1, &frame.fence, VK_TRUE, UINT64_MAX);
+
+        return static_cast<const uint32*>(frame.readback.Data());
+    }
+}
+
+#endif
@@ -0,0 +1,269 @@
+#ifndef VULKANGRAPHICS_H
+#define VULKANGRAPHICS_H
+
+#include "Graphics.h"
+#include "HeapAllocator.h"
+#include "UploadRing.h"
+
+#ifdef WXE_VULKAN
+
+// platform surface headers are only pulled in by VulkanGraphics.cpp,
+// for the same reason Xlib stays out of Window.h
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <deque>
+#pragma comment(lib, "vulkan.lib")
+
+namespace WXE::Vulkan
+{
+	// ---------------------------------------------------
+	// Buffer memory: CPU and UPLOAD buffers are host
+	// visible and stay mapped, GPU buffers are device
+	// local and are filled through an upload buffer. The
+	// memory is a range of a pooled heap, not its own
+	// allocation.
+	// ---------------------------------------------------
+
+	class Buffer final
+	{
+	private:
+		VkDevice device;
+		VkBuffer buffer;
+		HeapPool* pool;
+		HeapRange range;
+		void* mapped;
+		uint32 size;
+
+		void Destroy() noexcept;
+		friend class Graphics;
+
+	public:
+		Buffer() noexcept;
+
+		VkBuffer Handle() const noexcept;
+		void* Data() const noexcept;
+		uint32 Size() const noexcept;
+		void Release() noexcept;
+	};
+
+	inline VkBuffer Buffer::Handle() const noexcept
+	{ return buffer; }
+
+	inline void* Buffer::Data() const noexcept
+	{ return mapped; }
+
+	inline uint32 Buffer::Size() const noexcept
+	{ return size; }
+
+	// ---------------------------------------------------
+	// Fence values on a Vulkan 1.1 queue. Signal() makes
+	// an empty submission with a VkFence, which signals
+	// once all the work submitted before it is done; the
+	// fences are recycled as their values are reached.
+	// ---------------------------------------------------
+
+	class QueueFence final : public FenceDevice
+	{
+	private:
+		struct Pending
+		{
+			uint64 value;
+			VkFence fence;
+		};
+
+		VkDevice device;
+		VkQueue queue;
+		uint64 value;
+
+		// retiring reached fences is bookkeeping, even from Completed()
+		mutable std::deque<Pending> pending;
+		mutable std::vector<VkFence> spare;
+		mutable uint64 completed;
+
+		void Retire() const noexcept;
+
+	public:
+		QueueFence() noexcept;
+
+		void Initialize(VkDevice device, VkQueue queue) noexcept;
+		void Release() noexcept;
+
+		uint64 Signal() noexcept override;
+		uint64 Completed() const noexcept override;
+		void Wait(const uint64 value) noexcept override;
+	};
+
+	// ---------------------------------------------------
+	// Vulkan backend with the same surface as the DX12 one.
+	// Up to FRAMES_IN_FLIGHT frames are recorded ahead of
+	// the GPU, each with its own command pool and fence,
+	// so Clear() only waits for the frame it is about to
+	// reuse. Without a display (e.g. lavapipe on CI) it
+	// renders to an offscreen image that is read back.
+	// Below full render scale a frame is drawn into the
+	// scene image and blitted, filtered, to the swap chain.
+	// Upload() packs data into a mapped staging ring; the
+	// copies go out in batches ahead of the next frame, on
+	// the same queue, so no ownership transfer is needed.
+	// ---------------------------------------------------
+
+	class Graphics : public GraphicsDesc
+	{
+	public:
+		enum { FRAMES_IN_FLIGHT = 2, COPY_BATCHES = 3, STAGING_SIZE = 16 << 20 };
+
+	private:
+		// a pooled heap: host visible ones are mapped once, whole
+		struct Heap
+		{
+			VkDeviceMemory memory;
+			uint8* mapped;
+		};
+
+		struct Frame
+		{
+			VkCommandPool pool;
+			VkCommandBuffer commands;
+			VkFence fence;
+			VkSemaphore acquired;
+			Buffer readback;
+		};
+
+		Window* window;
+		VkInstance instance;
+		VkPhysicalDevice physicalDevice;
+		VkPhysicalDeviceMemoryProperties memoryProperties;
+		VkDevice device;
+		VkQueue queue;
+		uint32 queueFamily;
+
+		VkSurfaceKHR surface;
+		VkSwapchainKHR swapChain;
+		VkFormat colorFormat;
+		VkFormat depthFormat;
+		VkExtent2D extent;
+		VkExtent2D requested;
+		std::vector<VkImage> images;
+		std::vector<VkImageView> views;
+		std::vector<VkFramebuffer> framebuffers;
+		std::vector<VkSemaphore> rendered;
+
+		VkImage offscreen;
+		VkDeviceMemory offscreenMemory;
+		VkImage depthImage;
+		VkDeviceMemory depthMemory;
+		VkImageView depthView;
+
+		VkImage scene;
+		VkDeviceMemory sceneMemory;
+		VkImageView sceneView;
+		VkFramebuffer sceneFramebuffer;
+		bool scaled;
+
+		VkRenderPass renderPass;
+		VkRenderPass scenePass;
+		VkPipelineLayout pipelineLayout;
+		VkPipeline pipeline;
+
+		Frame frames[FRAMES_IN_FLIGHT];
+		uint32 frameIndex;
+		uint32 imageIndex;
+		int32 lastFrame;
+
+		VkCommandPool uploadPool;
+		VkCommandBuffer uploadCommands;
+		VkFence uploadFence;
+
+		HeapPool pools[VK_MAX_MEMORY_TYPES];
+
+		VkCommandPool copyPools[COPY_BATCHES];
+		VkCommandBuffer copyCommands[COPY_BATCHES];
+		QueueFence copyFence;
+		FrameRing copyBatches;
+		Buffer staging;
+		UploadRing uploads;
+		bool copyOpen;
+
+		JobSystem* jobs;
+
+		uint32 MemoryType(const uint32 typeBits, const VkMemoryPropertyFlags flags) const;
+		void CreateBuffer(const uint32 sizeInBytes, const VkBufferUsageFlags usage,
+			const VkMemoryPropertyFlags flags, Buffer* buffer);
+		void CreatePools();
+		void CreateImage(const VkFormat format, const VkImageUsageFlags usage,
+			VkImage* image, VkDeviceMemory* memory) const;
+		VkImageView CreateView(const VkImage image, const VkFormat format, const VkImageAspectFlags aspect) const;
+		VkShaderModule LoadShader(const char* fileName) const;
+
+		void SelectDevice();
+		void CreateTargets();
+		void DestroyTargets() noexcept;
+		void CreatePipeline();
+
+	public:
+		Graphics() noexcept;
+		~Graphics();
+
+		void Initialize(Window* window, JobSystem* jobs = nullptr);
+		void Clear();
+		void Present();
+
+		void ResetCommands();
+		void SubmitCommands();
+
+		void Allocate(const uint32 sizeInBytes,
+			Buffer** resource);
+
+		void Allocate(const uint32 type,
+			const uint32 sizeInBytes,
+			Buffer** resource);
+
+		const HeapPool& Pool(const uint32 memoryType) const noexcept;
+		const UploadRing& Uploads() const noexcept;
+
+		void Copy(const void* vertices,
+			const uint32 sizeInBytes,
+			Buffer* bufferCPU) const noexcept;
+
+		void Upload(const void* data,
+			const uint32 sizeInBytes,
+			Buffer* bufferGPU,
+			const uint64 offset = 0) noexcept;
+
+		void SubmitUploads() noexcept;
+
+		void Draw(const Buffer* vertices,
+			const uint32 stride,
+			const uint32 count) noexcept;
+
+		bool Complete(const _XEvent* event) noexcept;
+		const uint32* Pixels() noexcept;
+		uint32 Pitch() const noexcept;
+
+		VkDevice Device() const noexcept;
+		VkCommandBuffer CommandBuffer() const noexcept;
+	};
+
+	// presentation goes through the swap chain, no X events to claim
+	inline bool Graphics::Complete(const _XEvent*) noexcept
+	{ return false; }
+
+	inline uint32 Graphics::Pitch() const noexcept
+	{ return extent.width; }
+
+	inline VkDevice Graphics::Device() const noexcept
+	{ return device; }
+
+	inline const HeapPool& Graphics::Pool(const uint32 memoryType) const noexcept
+	{ return pools[memoryType]; }
+
+	inline const UploadRing& Graphics::Uploads() const noexcept
+	{ return uploads; }
+
+	inline VkCommandBuffer Graphics::CommandBuffer() const noexcept
+	{ return frames[frameIndex].commands; }
+}
+
+#endif
+
+#endif
@@ -1,208 +1,313 @@
-#include "Window.h"
-
-#ifdef _WIN32
-
-void GetSizeScreen(WXE::uint32 width, WXE::uint32 height) {
-    width = GetSystemMetrics(SM_CXSCREEN);
-    height = GetSystemMetrics(SM_CYSCREEN);
-}
-
-namespace WXE::Windows
-{
-	void (*Window::inFocus)() = nullptr;
-	void (*Window::lostFocus)() = nullptr;
-
-	Window::Window() noexcept
-	{
-		hInstance = GetModuleHandle(nullptr);
-		windowHandle = 0;
-		GetSizeScreen(windowWidth, windowHeight);
-		windowIcon = LoadIcon(nullptr, IDI_APPLICATION);
-		windowCursor = LoadCursor(nullptr, IDC_ARROW);
-		windowColor = RGB(255, 255, 255);
-		windowTitle = string("Windows Game");
-		windowStyle = WS_POPUP | WS_VISIBLE;
-		windowMode = FULLSCREEN;
-		windowPosX = 0;
-		windowPosY = 0;
-		windowCenterX = windowWidth / 2.0f;
-		windowCenterY = windowHeight / 2.0f;
-	}
-
-	void Window::Mode(const int32 mode) noexcept
-	{
-		windowMode = mode;
-
-		if (mode == WINDOWED) windowStyle = WS_OVERLAPPED | WS_SYSMENU | WS_VISIBLE;
-		else				  windowStyle = WS_EX_TOPMOST | WS_POPUP | WS_VISIBLE;
-	}
-
-	void Window::Size(const int32 width, const int32 height) noexcept
-	{
-		windowWidth = width;
-		windowHeight = height;
-
-		windowCenterX = windowWidth / 2.0f;
-		windowCenterY = windowHeight / 2.0f;
-
-		windowPosX = GetSystemMetrics(SM_CXSCREEN) / 2.0f - windowWidth / 2.0f;
-		windowPosY = GetSystemMetrics(SM_CYSCREEN) / 2.0f - windowHeight / 2.0f;
-	}
-
-    bool Window::Create()
-    {
-		WNDCLASSEX wndClass {
-			.cbSize = sizeof(WNDCLASSEX),
-			.style = CS_DBLCLKS | CS_OWNDC | CS_HREDRAW | CS_VREDRAW,
-			.lpfnWndProc = Window::WinProc,
-			.cbClsExtra = 0,
-			.cbWndExtra = 0,
-			.hInstance = hInstance,
-			.hIcon = windowIcon,
-			.hCursor = windowCursor,
-			.hbrBackground = static_cast<HBRUSH>(CreateSolidBrush(windowColor)),
-			.lpszMenuName = nullptr,
-			.lpszClassName = "GameWindow",
-			.hIconSm = windowIcon,
-		};
-
-        if (!RegisterClassEx(&wndClass))
-            return false;
-
-        windowHandle = CreateWindowEx(
-            0,
-            "GameWindow",
-            windowTitle.c_str(),
-            windowStyle,
-			static_cast<int32>(windowPosX), static_cast<int32>(windowPosY),
-            windowWidth, windowHeight,
-			nullptr,
-			nullptr,
-            hInstance,
-            nullptr
-		);
-
-        if (windowMode == WINDOWED)
-        {
-            RECT rect { 0, 0, windowWidth, windowHeight };
-
-            AdjustWindowRectEx(&rect,
-                GetWindowStyle(windowHandle),
-                GetMenu(windowHandle) != nullptr,
-                GetWindowExStyle(windowHandle));
-
-			windowPosX = (GetSystemMetrics(SM_CXSCREEN) / 2.0f) - ((rect.right - rect.left) / 2.0f);
-			windowPosY = (GetSystemMetrics(SM_CYSCREEN) / 2.0f) - ((rect.bottom - rect.top) / 2.0f);
-
-            MoveWindow(
-                windowHandle,
-				static_cast<int32>(windowPosX), static_cast<int32>(windowPosY),
-                rect.right - rect.left,
-                rect.bottom - rect.top,
-                TRUE
-			);
-        }
-
-        return (windowHandle ? true : false);
-    }
-
-	LRESULT CALLBACK Window::WinProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
-	{
-		switch (msg) 
-		{
-		case WM_KILLFOCUS:
-			if (lostFocus)
-				lostFocus();
-			return 0;
-
-		case WM_SETFOCUS:
-			if (inFocus)
-				inFocus();
-			return 0;
-
-		case WM_DESTROY:
-			PostQuitMessage(0);
-			return 0;
-		}
-
-		return DefWindowProc(hWnd, msg, wParam, lParam);
-	}
-}
-
-#elif __linux__
-
-#include <cstdlib>
-#include "Utils.h"
-#pragma comment(lib, "X11.lib")
-
-namespace WXE::Linux
-{
-	Window::Window() noexcept :
-    screenNum{}
-    {
-        windowPosX = 0;
-        windowPosY = 0;
-        windowTitle = string("Game Window");
-        display = XOpenDisplay(nullptr);
-        screen = DefaultScreenOfDisplay(display);
-    
-	    windowHeight = screen->height;
-        windowWidth  = screen->width;
-    }
-
-    Window::~Window() noexcept
-    {
-        XFlush(display);
-        SafeDelete(screen);
-        XCloseDisplay(display);
-    }
-
-    bool Window::Create()
-    {
-        display = XOpenDisplay(getenv("DISPLAY"));
-        if(display == nullptr);
-			return false;
-
-        screenNum = DefaultScreen(display);
-
-        window = XCreateSimpleWindow(
-            display, 
-            DefaultRootWindow(display),
-            windowPosX, windowPosY, 
-            windowWidth, windowHeight,
-            2,
-            BlackPixel(display, screenNum),
-            WhitePixel(display, screenNum)
-        );
-
-        XStoreName(display, window, windowTitle.c_str());
-        XSelectInput(display, window, ButtonPressMask|StructureNotifyMask );
-        XMapWindow(display, window);
-
-		return true;
-    }
-
-    void Window::GetSizeScreen(uint32 width, uint32 height)
-    {
-        screen = DefaultScreenOfDisplay(display);
-    
-	    windowHeight = screen->height;
-        windowWidth  = screen->width;
-    }
-
-    void Window::Size(const uint32 width, const uint32 height) noexcept
-    {
-        windowWidth = width;
-        windowHeight = height;
-
-        windowCenterX = windowWidth / 2.0f;
-        windowCenterY = windowHeight / 2.0f;
-
-        uint32 widthScreen, heightScreen;
-        GetSizeScreen(widthScreen, heightScreen); 
-        windowPosX = widthScreen / 2.0f - windowWidth / 2.0f;
-        windowPosY = heightScreen / 2.0f - windowHeight / 2.0f;
-    }
-}
-
+#include "Window.h"
+
+#ifdef _WIN32
+
+void GetSizeScreen(WXE::uint32 width, WXE::uint32 height) {
+    width = GetSystemMetrics(SM_CXSCREEN);
+    height = GetSystemMetrics(SM_CYSCREEN);
+}
+
+namespace WXE::Windows
+{
+	std::function<void()> Window::inFocus;
+	std::function<void()> Window::lostFocus;
+
+	Window::Window() noexcept
+	{
+		hInstance = GetModuleHandle(nullptr);
+		windowHandle = 0;
+		GetSizeScreen(windowWidth, windowHeight);
+		windowIcon = LoadIcon(nullptr, IDI_APPLICATION);
+		windowCursor = LoadCursor(nullptr, IDC_ARROW);
+		windowColor = RGB(255, 255, 255);
+		windowTitle = string("Windows Game");
+		windowStyle = WS_POPUP | WS_VISIBLE;
+		windowMode = FULLSCREEN;
+		windowPosX = 0;
+		windowPosY = 0;
+		windowCenterX = windowWidth / 2.0f;
+		windowCenterY = windowHeight / 2.0f;
+	}
+
+	void Window::Mode(const int32 mode) noexcept
+	{
+		windowMode = mode;
+
+		if (mode == WINDOWED) windowStyle = WS_OVERLAPPED | WS_SYSMENU | WS_VISIBLE;
+		else				  windowStyle = WS_EX_TOPMOST | WS_POPUP | WS_VISIBLE;
+	}
+
+	void Window::Size(const int32 width, const int32 height) noexcept
+	{
+		windowWidth = width;
+		windowHeight = height;
+
+		windowCenterX = windowWidth / 2.0f;
+		windowCenterY = windowHeight / 2.0f;
+
+		windowPosX = GetSystemMetrics(SM_CXSCREEN) / 2.0f - windowWidth / 2.0f;
+		windowPosY = GetSystemMetrics(SM_CYSCREEN) / 2.0f - windowHeight / 2.0f;
+	}
+
+    bool Window::Create()
+    {
+		WNDCLASSEX wndClass {
+			.cbSize = sizeof(WNDCLASSEX),
+			.style = CS_DBLCLKS | CS_OWNDC | CS_HREDRAW | CS_VREDRAW,
+			.lpfnWndProc = Window::WinProc,
+			.cbClsExtra = 0,
+			.cbWndExtra = 0,
+			.hInstance = hInstance,
+			.hIcon = windowIcon,
+			.hCursor = windowCursor,
+			.hbrBackground = static_cast<HBRUSH>(CreateSolidBrush(windowColor)),
+			.lpszMenuName = nullptr,
+			.lpszClassName = "GameWindow",
+			.hIconSm = windowIcon,
+		};
+
+        if (!RegisterClassEx(&wndClass))
+            return false;
+
+        windowHandle = CreateWindowEx(
+            0,
+            "GameWindow",
+            windowTitle.c_str(),
+            windowStyle,
+			static_cast<int32>(windowPosX), static_cast<int32>(windowPosY),
+            windowWidth, windowHeight,
+			nullptr,
+			nullptr,
+            hInstance,
+            nullptr
+		);
+
+        if (windowMode == WINDOWED)
+        {
+            RECT rect { 0, 0, windowWidth, windowHeight };
+
+            AdjustWindowRectEx(&rect,
+                GetWindowStyle(windowHandle),
+                GetMenu(windowHandle) != nullptr,
+                GetWindowExStyle(windowHandle));
+
+			windowPosX = (GetSystemMetrics(SM_CXSCREEN) / 2.0f) - ((rect.right - rect.left) / 2.0f);
+			windowPosY = (GetSystemMetrics(SM_CYSCREEN) / 2.0f) - ((rect.bottom - rect.top) / 2.0f);
+
+            MoveWindow(
+                windowHandle,
+				static_cast<int32>(windowPosX), static_cast<int32>(windowPosY),
+                rect.right - rect.left,
+                rect.bottom - rect.top,
+                TRUE
+			);
+        }
+
+        return (windowHandle ? true : false);
+    }
+
+	LRESULT CALLBACK Window::WinProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
+	{
+		switch (msg) 
+		{
+		case WM_KILLFOCUS:
+			if (lostFocus)
+				lostFocus();
+			return 0;
+
+		case WM_SETFOCUS:
+			if (inFocus)
+				inFocus();
+			return 0;
+
+		case WM_DESTROY:
+			PostQuitMessage(0);
+			return 0;
+		}
+
+		return DefWindowProc(hWnd, msg, wParam, lParam);
+	}
+}
+
+#elif __linux__
+
+#include <cstdlib>
+#include "Utils.h"
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/Xresource.h>
+#include <poll.h>
+#pragma comment(lib, "X11.lib")
+
+namespace WXE::Linux
+{
+	Window::Window() noexcept :
+    screenNum{},
+    window{},
+    deleteAtom{},
+    windowColor{ 0xFFFFFF },
+    focused{ true },
+    closed{}
+    {
+        windowPosX = 0;
+        windowPosY = 0;
+        windowWidth = 0;
+        windowHeight = 0;
+        windowTitle = string("Game Window");
+        display = XOpenDisplay(getenv("DISPLAY"));
+
+        if (display)
+        {
+            uint32 width, height;
+            GetSizeScreen(width, height);
+            windowWidth = width;
+            windowHeight = height;
+        }
+
+        windowCenterX = windowWidth / 2.0f;
+        windowCenterY = windowHeight / 2.0f;
+    }
+
+    Window::~Window() noexcept
+    {
+        if (display)
+        {
+            XFlush(display);
+            XCloseDisplay(display);
+        }
+    }
+
+    bool Window::Create()
+    {
+        if (display == nullptr)
+            display = XOpenDisplay(getenv("DISPLAY"));
+
+        if (display == nullptr)
+			return false;
+
+        screenNum = DefaultScreen(display);
+
+        window = XCreateSimpleWindow(
+            display, 
+            DefaultRootWindow(display),
+            windowPosX, windowPosY, 
+            windowWidth, windowHeight,
+            2,
+            BlackPixel(display, screenNum),
+            windowColor
+        );
+
+        XStoreName(display, window, windowTitle.c_str());
+
+        // the window manager asks to close instead of killing the connection
+        Atom protocol = XInternAtom(display, "WM_DELETE_WINDOW", False);
+        XSetWMProtocols(display, window, &protocol, 1);
+        deleteAtom = protocol;
+
+        XSelectInput(display, window,
+            KeyPressMask|KeyReleaseMask|ButtonPressMask|ButtonReleaseMask|
+            PointerMotionMask|FocusChangeMask|StructureNotifyMask);
+        XMapWindow(display, window);
+
+		return true;
+    }
+
+    bool Window::Pump(const int32 timeout, EventProc proc, void* context) noexcept
+    {
+        if (display == nullptr)
+            return !closed;
+
+        // events Xlib has already read cost no system call; the
+        // connection is read by the Flush() closing every frame,
+        // so the socket is only polled when asked to wait on it
+        int32 pending = XEventsQueued(display, QueuedAlready);
+
+        if (pending == 0 && timeout != 0)
+        {
+            // flushing reads what the server has sent so far
+            XFlush(display);
+            pending = XQLength(display);
+
+            pollfd fd { ConnectionNumber(display), POLLIN, 0 };
+            if (pending == 0 && poll(&fd, 1, timeout) > 0)
+                pending = XEventsQueued(display, QueuedAfterReading);
+        }
+
+        while (pending-- > 0)
+        {
+            XEvent event;
+            XNextEvent(display, &event);
+            Dispatch(&event);
+
+            if (proc)
+                proc(context, &event);
+        }
+
+        return !closed;
+    }
+
+    void Window::Flush() noexcept
+    {
+        // sends the frame's requests and queues the events read back
+        if (display)
+            XFlush(display);
+    }
+
+    void Window::Dispatch(XEvent* event) noexcept
+    {
+        switch (event->type)
+        {
+        case FocusIn:
+            focused = true;
+            if (inFocus)
+                inFocus();
+            break;
+
+        case FocusOut:
+            focused = false;
+            if (lostFocus)
+                lostFocus();
+            break;
+
+        case ConfigureNotify:
+            windowWidth = event->xconfigure.width;
+            windowHeight = event->xconfigure.height;
+            windowCenterX = windowWidth / 2.0f;
+            windowCenterY = windowHeight / 2.0f;
+            break;
+
+        case ClientMessage:
+            if (static_cast<unsigned long>(event->xclient.data.l[0]) == deleteAtom)
+                closed = true;
+            break;
+
+        case DestroyNotify:
+            closed = true;
+            break;
+        }
+    }
+
+    void Window::GetSizeScreen(uint32& width, uint32& height)
+    {
+        Screen* screen = DefaultScreenOfDisplay(display);
+    
+	    width = screen->width;
+        height = screen->height;
+    }
+
+    void Window::Size(const uint32 width, const uint32 height) noexcept
+    {
+        windowWidth = width;
+        windowHeight = height;
+
+        windowCenterX = windowWidth / 2.0f;
+        windowCenterY = windowHeight / 2.0f;
+
+        uint32 widthScreen {}, heightScreen {};
+        if (display) GetSizeScreen(widthScreen, heightScreen); 
+        windowPosX = widthScreen / 2.0f - windowWidth / 2.0f;
+        windowPosY = heightScreen / 2.0f - windowHeight / 2.0f;
+    }
+}
+
 #endif
\ No newline at end of file
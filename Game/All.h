@@ -6,9 +6,28 @@
 #include "Types.h"
 #include "Window.h"
 #include "Graphics.h"
+#include "VulkanGraphics.h"
 #include "Input.h"
+#include "Clock.h"
+#include "JobSystem.h"
+#include "TaskScheduler.h"
+#include "TimerWheel.h"
+#include "DoubleBuffer.h"
+#include "FrameStats.h"
+#include "FrameLimiter.h"
+#include "FrameRing.h"
+#include "HeapAllocator.h"
+#include "UploadRing.h"
+#include "StreamCopy.h"
+#include "ResourceStates.h"
+#include "ResolutionScaler.h"
+#include "Framebuffer.h"
+#include "Rasterizer.h"
+#include "Recorder.h"
 #include "Game.h"
 #include "Engine.h"
+#include "EngineGroup.h"
+#include "Profiler.h"
 #include "Error.h"
 #include "Mesh.h"
 #include "Utils.h"
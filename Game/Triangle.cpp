@@ -7,8 +7,10 @@ namespace WXE
         graphics->ResetCommands();
     
         BuildGeometry();
+    #ifdef _WIN32
         BuildRootSignature();
         BuildPipelineState();
+    #endif
         
         graphics->SubmitCommands();
     }
@@ -21,21 +23,33 @@ namespace WXE
     
     void Triangle::Display() noexcept
     {
+    #ifdef _WIN32
         graphics->Clear(pipelineState);
 
         graphics->CommandList()->SetGraphicsRootSignature(rootSignature);
         graphics->CommandList()->IASetVertexBuffers(0, 1, geometry->VertexBufferView());
         graphics->CommandList()->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
+        graphics->FlushBarriers();
         graphics->CommandList()->DrawInstanced(3, 1, 0, 0);
+    #else
+        graphics->Clear();
+    #ifdef WXE_VULKAN
+        graphics->Draw(geometry->vertexBufferGPU, geometry->vertexByteStride, 3);
+    #else
+        graphics->Draw(geometry->vertexBufferCPU, geometry->vertexByteStride, 3);
+    #endif
+    #endif
 
         graphics->Present();
     }
 
     void Triangle::Finalize() noexcept
     {
+    #ifdef _WIN32
         rootSignature->Release();
         pipelineState->Release();
+    #endif
         delete geometry;
     }
 
@@ -56,13 +70,16 @@ namespace WXE
         geometry->vertexBufferSize = vbSize;
 
         graphics->Allocate(vbSize, &geometry->vertexBufferCPU);
-        graphics->Allocate(UPLOAD, vbSize, &geometry->vertexBufferUpload);
-        graphics->Allocate(GPU, vbSize, &geometry->vertexBufferGPU);
-
         graphics->Copy(vertices, vbSize, geometry->vertexBufferCPU);
-        graphics->Copy(vertices, vbSize, geometry->vertexBufferUpload, geometry->vertexBufferGPU);
+
+    #if defined(_WIN32) || defined(WXE_VULKAN)
+        // staged through the shared upload ring, nothing to keep per mesh
+        graphics->Allocate(GPU, vbSize, &geometry->vertexBufferGPU);
+        graphics->Upload(vertices, vbSize, geometry->vertexBufferGPU);
+    #endif
     }
 
+#ifdef _WIN32
     void Triangle::BuildRootSignature()
     {
         D3D12_ROOT_SIGNATURE_DESC rootSigDesc {
@@ -195,6 +212,7 @@ namespace WXE
         vertexShader->Release();
         pixelShader->Release();
     }
+#endif
 }
 
 #ifdef _WIN32
@@ -214,8 +232,8 @@ auto APIENTRY WinMain(_In_ HINSTANCE hInstance,
         engine->window->Title("Triangle");
         engine->window->Icon(IDI_ICON);
         engine->window->Cursor(IDC_CURSOR);
-        engine->window->LostFocus(Engine::Pause);
-        engine->window->InFocus(Engine::Resume);
+        engine->window->LostFocus([engine] { engine->Pause(); });
+        engine->window->InFocus([engine] { engine->Resume(); });
 
         int exit = engine->Start(new Triangle());
 
@@ -231,6 +249,26 @@ auto APIENTRY WinMain(_In_ HINSTANCE hInstance,
 #else
 int main(int argc, char ** argv)
 {
+    using namespace WXE;
+
+    try
+    {
+        Engine* engine = new Engine();
+        engine->window->Size(600, 600);
+        engine->window->Color(0, 122, 204);
+        engine->window->Title("Triangle");
+        engine->window->LostFocus([engine] { engine->Pause(); });
+        engine->window->InFocus([engine] { engine->Resume(); });
+
+        int exit = engine->Start(new Triangle());
 
+        delete engine;
+        return exit;
+    }
+    catch (Error& e)
+    {
+        fputs(e.ToString().data(), stderr);
+        return 0;
+    }
 }
 #endif
\ No newline at end of file
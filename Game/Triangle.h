@@ -10,12 +10,32 @@
 	using namespace DirectX;
 	using Position = XMFLOAT3;
 	using Color = XMFLOAT4;
+#else
+	// same layout as XMFLOAT3/XMFLOAT4, which the software renderer reads
+	struct Position
+	{
+		float x, y, z;
+		Position(float x, float y, float z) : x{ x }, y{ y }, z{ z } {}
+	};
+
+	struct Color
+	{
+		float r, g, b, a;
+		Color(const float* c) : r{ c[0] }, g{ c[1] }, b{ c[2] }, a{ c[3] } {}
+	};
+
+	namespace Colors
+	{
+		constexpr float Red[] = { 1.0f, 0.0f, 0.0f, 1.0f };
+		constexpr float Orange[] = { 1.0f, 0.647058845f, 0.0f, 1.0f };
+		constexpr float Yellow[] = { 1.0f, 1.0f, 0.0f, 1.0f };
+	}
 #endif
 
 struct Vertex
 {
 	Position Pos;
-	Color Color;
+	::Color Color;
 };
 
 namespace WXE
@@ -23,8 +43,10 @@ namespace WXE
 	class Triangle : public Game
 	{
 	private:
+	#ifdef _WIN32
 		ID3D12RootSignature* rootSignature;
 		ID3D12PipelineState* pipelineState;
+	#endif
 		Mesh* geometry;
 
 	public:
@@ -34,8 +56,10 @@ namespace WXE
 		void Finalize() noexcept;
 
 		void BuildGeometry() noexcept;
+	#ifdef _WIN32
 		void BuildRootSignature();
 		void BuildPipelineState();
+	#endif
 	};
 }
 
@@ -0,0 +1,49 @@
+# ---------------------------------------------------
+# Vulkan backend. The HLSL shaders of the DX12 path
+# are compiled to SPIR-V at build time, by the
+# glslangValidator or dxc of the Vulkan SDK, into
+# Shaders/ under the build tree; the engine reads
+# them from there (WXE_SHADER_DIR).
+# ---------------------------------------------------
+
+find_package(Vulkan REQUIRED)
+
+find_program(WXE_GLSLANG glslangValidator HINTS $ENV{VULKAN_SDK}/bin)
+find_program(WXE_DXC dxc HINTS $ENV{VULKAN_SDK}/bin)
+
+set(WXE_SHADER_OUTPUT ${CMAKE_BINARY_DIR}/Shaders)
+set(WXE_SPIRV)
+
+foreach(shader Vertex:vert:vs_6_0 Pixel:frag:ps_6_0)
+    string(REPLACE ":" ";" parts ${shader})
+    list(GET parts 0 name)
+    list(GET parts 1 stage)
+    list(GET parts 2 profile)
+
+    set(source ${PROJECT_SOURCE_DIR}/Engine/${name}.hlsl)
+    set(output ${WXE_SHADER_OUTPUT}/${name}.spv)
+
+    if(WXE_GLSLANG)
+        set(compile ${WXE_GLSLANG} -D -V -S ${stage} -e main -o ${output} ${source})
+    elseif(WXE_DXC)
+        set(compile ${WXE_DXC} -spirv -T ${profile} -E main -Fo ${output} ${source})
+    else()
+        message(FATAL_ERROR "WXE_VULKAN needs glslangValidator or dxc to build the shaders")
+    endif()
+
+    add_custom_command(
+        OUTPUT ${output}
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${WXE_SHADER_OUTPUT}
+        COMMAND ${compile}
+        DEPENDS ${source}
+        COMMENT "SPIR-V ${name}.spv"
+        VERBATIM)
+
+    list(APPEND WXE_SPIRV ${output})
+endforeach()
+
+add_custom_target(Shaders DEPENDS ${WXE_SPIRV})
+add_dependencies(Engine Shaders)
+
+target_compile_definitions(Engine PUBLIC WXE_VULKAN WXE_SHADER_DIR="${WXE_SHADER_OUTPUT}/")
+target_link_libraries(Engine PUBLIC Vulkan::Vulkan)
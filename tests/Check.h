@@ -0,0 +1,46 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// ---------------------------------------------------
+// Minimal checks for the module tests: CHECK() reports
+// and counts a failure, Result() turns the count into
+// the exit code ctest looks at.
+// ---------------------------------------------------
+
+namespace Test
+{
+	inline int failures = 0;
+
+	// --bench asks for the timings as well as the checks
+	inline bool Bench(int argc, char** argv)
+	{ return argc > 1 && strcmp(argv[1], "--bench") == 0; }
+
+	// seconds taken by one call of func
+	template<typename Func>
+	inline double Seconds(Func&& func)
+	{
+		auto start = std::chrono::steady_clock::now();
+		func();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	inline int Result(const char* name)
+	{
+		printf("%s: %s\n", name, failures ? "FAILED" : "passed");
+		return failures ? 1 : 0;
+	}
+}
+
+#define CHECK(x)                                                            \
+    do {                                                                    \
+        if (!(x)) {                                                         \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x);    \
+            Test::failures++;                                               \
+        }                                                                   \
+    } while (0)
+
+#endif
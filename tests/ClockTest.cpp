@@ -0,0 +1,139 @@
+#include "Clock.h"
+#include "Check.h"
+#include <cmath>
+#include <thread>
+#include <vector>
+using namespace WXE;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+// Clock time minus steady_clock time, in seconds, read between
+// two steady_clock reads; the tightest pair of a few is kept
+static double Offset()
+{
+	double offset {};
+	double best = 1.0;
+
+	for (uint32 i = 0; i < 3; ++i)
+	{
+		double before = duration<double>(steady_clock::now().time_since_epoch()).count();
+		double clock = duration<double>(Clock::now().time_since_epoch()).count();
+		double after = duration<double>(steady_clock::now().time_since_epoch()).count();
+
+		if (after - before < best)
+		{
+			best = after - before;
+			offset = clock - (before + after) / 2;
+		}
+	}
+
+	return offset;
+}
+
+// seconds of Update() and now() on a few threads; returns the largest offset seen
+static double Run(const double seconds, const uint32 threads, std::atomic<uint32>& backwards)
+{
+	std::vector<std::thread> pool;
+	std::vector<double> offsets(threads);
+
+	for (uint32 t = 0; t < threads; ++t)
+	{
+		pool.emplace_back([&, t]
+		{
+			Clock::time_point last = Clock::now();
+			auto end = steady_clock::now() + duration<double>(seconds);
+
+			while (steady_clock::now() < end)
+			{
+				Clock::Update();
+				Clock::time_point now = Clock::now();
+
+				if (now < last)
+					backwards++;
+
+				last = now;
+				offsets[t] = std::fmax(offsets[t], std::fabs(Offset()));
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+			}
+		});
+	}
+
+	for (std::thread& thread : pool)
+		thread.join();
+
+	double worst {};
+	for (double offset : offsets)
+		worst = std::fmax(worst, offset);
+
+	return worst;
+}
+
+int main(int argc, char** argv)
+{
+	bool tsc = (Clock::Source() == TSC);
+
+	// how far the first calibration alone drifts, before any re-sync
+	if (Test::Bench(argc, argv) && tsc)
+	{
+		std::this_thread::sleep_for(std::chrono::seconds(5));
+		printf("offset after 5 s on the 20 ms calibration: %.0f ns\n", Offset() * 1e9);
+	}
+
+	// steady_clock source: the same time base
+	{
+		CHECK(Clock::Source(STEADY));
+		CHECK(Clock::Source() == STEADY);
+		CHECK(std::fabs(Offset()) < 0.001);
+		CHECK(Clock::Frequency() == 1e9);
+	}
+
+	if (!tsc || !Clock::Source(TSC))
+	{
+		printf("no invariant TSC, only the steady_clock source is checked\n");
+		return Test::Result("Clock");
+	}
+
+	// switching to the TSC keeps the steady_clock time base
+	{
+		CHECK(Clock::Source() == TSC);
+		CHECK(Clock::Frequency() > 1e8 && Clock::Frequency() < 1e10);
+		CHECK(std::fabs(Offset()) < 0.001);
+	}
+
+	// through re-syncs on threads ticking side by side, time
+	// never goes back and stays on steady_clock
+	{
+		std::atomic<uint32> backwards {};
+		double worst = Run(2.5, 4, backwards);
+
+		CHECK(backwards == 0);
+		CHECK(worst < 0.001);
+		printf("largest offset over 2.5 s with re-syncs: %.0f ns\n", worst * 1e9);
+	}
+
+	if (Test::Bench(argc, argv))
+	{
+		std::atomic<uint32> backwards {};
+		double worst = Run(5.0, 1, backwards);
+		printf("largest offset over 5 s with re-syncs: %.0f ns\n", worst * 1e9);
+
+		const uint32 count = 10'000'000;
+		volatile int64 sink {};
+
+		double tscTime = Test::Seconds([&] {
+			for (uint32 i = 0; i < count; ++i)
+				sink = Clock::now().time_since_epoch().count();
+		});
+
+		Clock::Source(STEADY);
+
+		double steadyTime = Test::Seconds([&] {
+			for (uint32 i = 0; i < count; ++i)
+				sink = Clock::now().time_since_epoch().count();
+		});
+
+		printf("now(): TSC %.1f ns, steady_clock %.1f ns\n", tscTime / count * 1e9, steadyTime / count * 1e9);
+	}
+
+	return Test::Result("Clock");
+}
@@ -0,0 +1,87 @@
+#include "EngineGroup.h"
+#include "Check.h"
+#include <cmath>
+#include <vector>
+using namespace WXE;
+
+struct Result
+{
+	uint32 updates;
+	double simulated;
+};
+
+// a bot that runs a fixed number of ticks, spinning for a while in each
+class Bot final : public Game
+{
+private:
+	Result* result;
+	uint32 limit;
+	double work;
+
+public:
+	Bot(Result* result, const uint32 limit, const double work = 0.0) noexcept :
+		result{ result }, limit{ limit }, work{ work } {}
+
+	void Init() override {}
+	void Finalize() override {}
+
+	void Update() override
+	{
+		auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(work);
+		while (std::chrono::steady_clock::now() < end);
+
+		result->updates++;
+		result->simulated += frameTime;
+
+		if (result->updates == limit)
+			engine->Quit();
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// every engine runs its own ticks at its own rate and
+	// leaves the group run when it quits, the others go on
+	{
+		const uint32 count = 8;
+		Result results[count] {};
+
+		EngineGroup group(4);
+
+		for (uint32 i = 0; i < count; ++i)
+			group.Add(new Bot(&results[i], 10 * (i + 1)))->TickRate(100.0);
+
+		CHECK(group.Size() == count);
+		CHECK(group.Run() == 0);
+
+		for (uint32 i = 0; i < count; ++i)
+		{
+			CHECK(results[i].updates == 10 * (i + 1));
+			CHECK(std::fabs(results[i].simulated - 0.1 * (i + 1)) < 1e-9);
+			CHECK(!group.Get(i)->Running());
+		}
+	}
+
+	if (Test::Bench(argc, argv))
+	{
+		const uint32 ticks = 100;
+		const double work = 0.0002;
+
+		for (uint32 count = 1; count <= 64; count *= 2)
+		{
+			std::vector<Result> results(count);
+
+			EngineGroup group;
+
+			for (uint32 i = 0; i < count; ++i)
+				group.Add(new Bot(&results[i], ticks, work))->TickRate(60.0);
+
+			double seconds = Test::Seconds([&] { group.Run(); });
+
+			printf("%2u engines x %u ticks of %.1f ms: %8.0f engine ticks/s, %.3f ms per group tick\n",
+				count, ticks, work * 1000, count * ticks / seconds, seconds / ticks * 1000);
+		}
+	}
+
+	return Test::Result("EngineGroup");
+}
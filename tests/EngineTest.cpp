@@ -0,0 +1,133 @@
+#include "Engine.h"
+#include "Check.h"
+#include <atomic>
+#include <thread>
+using namespace WXE;
+
+struct Stages
+{
+	double update;
+	double draw;
+	double display;
+	bool spin;
+};
+
+struct Counts
+{
+	uint32 updates;
+	uint32 draws;
+	uint32 displays;
+	uint32 overlapped;
+};
+
+// work of a stage: spinning holds a core, sleeping stands in for
+// time spent waiting on something else (a GPU, the driver)
+static void Work(const double seconds, const bool spin)
+{
+	auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+
+	if (spin)
+		while (std::chrono::steady_clock::now() < end);
+	else
+		std::this_thread::sleep_until(end);
+}
+
+// a game whose stages take a set time, quitting after a number of frames
+class Stage final : public Game
+{
+private:
+	Stages stages;
+	Counts* counts;
+	uint32 frames;
+	std::atomic<bool> updating;
+
+public:
+	Stage(const Stages& stages, Counts* counts, const uint32 frames) noexcept :
+		stages{ stages }, counts{ counts }, frames{ frames }, updating{} {}
+
+	void Init() override {}
+	void Finalize() override {}
+
+	void Update() override
+	{
+		updating = true;
+		Work(stages.update, stages.spin);
+		counts->updates++;
+		updating = false;
+	}
+
+	void Draw() override
+	{
+		Work(stages.draw, stages.spin);
+		counts->draws++;
+	}
+
+	void Display() override
+	{
+		counts->overlapped += updating;
+		Work(stages.display, stages.spin);
+		counts->displays++;
+
+		if (counts->displays == frames)
+			engine->Quit();
+	}
+};
+
+// seconds per frame of a graphical engine, offscreen without a display
+static double Run(JobSystem& jobs, const Stages& stages, const bool pipelined, const uint32 frames, Counts& counts)
+{
+	counts = {};
+	Engine engine(GRAPHICAL, &jobs);
+	engine.window->Size(64, 64);
+	engine.Pipelined(pipelined);
+
+	double seconds = Test::Seconds([&] { engine.Start(new Stage(stages, &counts, frames)); });
+	return seconds / frames;
+}
+
+int main(int argc, char** argv)
+{
+	JobSystem jobs(2);
+
+	// pipelined, Display runs while the next Update does, once per
+	// frame as serially, and the frame costs the longer side only
+	{
+		const Stages stages { 0.004, 0.001, 0.003, false };
+		const uint32 frames = 50;
+		Counts serial, pipelined;
+
+		double serialTime = Run(jobs, stages, false, frames, serial);
+		double pipelinedTime = Run(jobs, stages, true, frames, pipelined);
+
+		CHECK(serial.displays == frames && serial.draws == frames && serial.updates == frames);
+		CHECK(pipelined.displays == frames && pipelined.draws == frames && pipelined.updates == frames);
+		CHECK(serial.overlapped == 0);
+		CHECK(pipelined.overlapped > frames * 3 / 4);
+		CHECK(pipelinedTime < serialTime * 0.75);
+
+		printf("update 4 + draw 1 + display 3 ms, sleeping: serial %.2f ms, pipelined %.2f ms per frame\n",
+			serialTime * 1000.0, pipelinedTime * 1000.0);
+	}
+
+	if (Test::Bench(argc, argv))
+	{
+		// on one core spinning stages have nothing to overlap with
+		printf("cores: %u\n", std::thread::hardware_concurrency());
+
+		for (bool spin : { false, true })
+		{
+			for (const Stages& stages : { Stages { 0.004, 0.001, 0.003, spin }, Stages { 0.002, 0.002, 0.002, spin } })
+			{
+				Counts counts;
+				double serial = Run(jobs, stages, false, 200, counts);
+				double pipelined = Run(jobs, stages, true, 200, counts);
+
+				printf("%s update %.0f, draw %.0f, display %.0f ms: serial %.2f ms, pipelined %.2f ms per frame\n",
+					spin ? "spinning" : "sleeping", stages.update * 1000, stages.draw * 1000, stages.display * 1000,
+					serial * 1000.0, pipelined * 1000.0);
+			}
+		}
+	}
+
+	return Test::Result("Engine");
+}
@@ -0,0 +1,135 @@
+#include "FrameRing.h"
+#include "Check.h"
+using namespace WXE;
+
+// the CPU side of a frame: recording takes this long
+static void Record(const double seconds)
+{
+	Clock::time_point end = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+	while (Clock::now() < end);
+}
+
+// seconds per frame over count frames of cpu and gpu time
+static double Pace(const uint32 frames, const double cpu, const double gpu, const uint32 count, double& stallRate)
+{
+	MockDevice device(gpu);
+	FrameRing ring(&device, frames);
+
+	double seconds = Test::Seconds([&] {
+		for (uint32 i = 0; i < count; ++i)
+		{
+			ring.Begin();
+			Record(cpu);
+			ring.End();
+		}
+		ring.Flush();
+	});
+
+	stallRate = ring.StallRate();
+	return seconds / count;
+}
+
+int main(int argc, char** argv)
+{
+	// slots are handed out in turn and reused, under rising fences
+	{
+		MockDevice device;
+		FrameRing ring(&device, 3);
+		bool inTurn = true;
+
+		for (uint32 i = 0; i < 12; ++i)
+		{
+			inTurn = inTurn && ring.Begin() == i % 3 && ring.Index() == i % 3;
+			inTurn = inTurn && ring.End() == i + 1;
+		}
+
+		CHECK(inTurn);
+		CHECK(ring.Index() == 0);
+		CHECK(ring.Stalls() == 0 && ring.StallRate() == 0.0);
+	}
+
+	// the frame count is kept between one and MAX_FRAMES
+	{
+		MockDevice device;
+		CHECK(FrameRing(&device, 0).Frames() == 1);
+		CHECK(FrameRing(&device, 9).Frames() == FrameRing::MAX_FRAMES);
+	}
+
+	// a GPU slower than the CPU stalls every frame once the ring is
+	// full, and the slot handed out is always off the GPU
+	{
+		const uint32 count = 40;
+		MockDevice device(0.002);
+		FrameRing ring(&device, 2);
+		uint64 fences[2] {};
+		bool offGpu = true;
+
+		for (uint32 i = 0; i < count; ++i)
+		{
+			uint32 slot = ring.Begin();
+			offGpu = offGpu && device.Completed() >= fences[slot];
+			fences[slot] = ring.End();
+		}
+
+		CHECK(offGpu);
+
+		// a frame delayed by the OS past its GPU work stalls less, never more
+		CHECK(ring.Stalls() <= count - 2 && ring.Stalls() >= (count - 2) * 3 / 4);
+		CHECK(ring.StallRate() > 0.5);
+		printf("stalls: %llu of %u frames\n", (unsigned long long)ring.Stalls(), count);
+	}
+
+	// Flush waits for the last frame, not just the oldest
+	{
+		MockDevice device(0.005);
+		FrameRing ring(&device, 3);
+		uint64 last {};
+
+		for (uint32 i = 0; i < 3; ++i)
+		{
+			ring.Begin();
+			last = ring.End();
+		}
+
+		CHECK(device.Completed() < last);
+
+		double seconds = Test::Seconds([&] { ring.Flush(); });
+
+		CHECK(device.Completed() == last);
+		CHECK(seconds > 0.010);
+
+		// nothing left to wait for
+		CHECK(Test::Seconds([&] { ring.Flush(); }) < 0.001);
+	}
+
+	if (Test::Bench(argc, argv))
+	{
+		MockDevice device;
+		FrameRing ring(&device, 2);
+		const uint32 count = 1000000;
+
+		double cycle = Test::Seconds([&] {
+			for (uint32 i = 0; i < count; ++i)
+			{
+				ring.Begin();
+				ring.End();
+			}
+		});
+
+		printf("Begin + End on an idle device: %.1f ns\n", cycle / count * 1e9);
+
+		// with 2 ms on each side one frame in flight is serial,
+		// two overlap the CPU with the GPU
+		for (uint32 frames = 1; frames <= FrameRing::MAX_FRAMES; ++frames)
+		{
+			double balanced, balancedRate, gpuBound, gpuBoundRate;
+			balanced = Pace(frames, 0.002, 0.002, 100, balancedRate);
+			gpuBound = Pace(frames, 0.001, 0.003, 100, gpuBoundRate);
+
+			printf("%u frames: cpu 2 ms gpu 2 ms %.2f ms (stalls %.0f%%), cpu 1 ms gpu 3 ms %.2f ms (stalls %.0f%%)\n",
+				frames, balanced * 1000.0, balancedRate * 100.0, gpuBound * 1000.0, gpuBoundRate * 100.0);
+		}
+	}
+
+	return Test::Result("FrameRing");
+}
@@ -0,0 +1,103 @@
+#include "FrameStats.h"
+#include "Check.h"
+#include <cstdio>
+using namespace WXE;
+
+static uint32 Lines(const char* fileName)
+{
+	FILE* file = fopen(fileName, "r");
+	if (!file)
+		return 0;
+
+	uint32 lines {};
+	for (int c = fgetc(file); c != EOF; c = fgetc(file))
+		lines += (c == '\n');
+
+	fclose(file);
+	return lines;
+}
+
+int main(int argc, char** argv)
+{
+	const char* fileName = "FrameStatsTest.csv";
+	remove(fileName);
+
+	// percentiles come from the 0.1 ms buckets
+	{
+		FrameStats stats;
+
+		for (uint32 i = 1; i <= 100; ++i)
+			stats.Add(i / 10000.0);
+
+		CHECK(stats.Frames() == 100);
+		CHECK(stats.P50() > 0.00499 && stats.P50() < 0.00511);
+		CHECK(stats.P99() > 0.00989 && stats.P99() < 0.01001);
+		CHECK(stats.Max() > 0.00999 && stats.Max() < 0.01001);
+		CHECK(stats.Hitches() == 0);
+
+		stats.Add(0.05);
+		CHECK(stats.Hitches() == 1);
+	}
+
+	// dumps go out on a job, a header and a line per period,
+	// and Flush() adds the part of the period left over
+	{
+		JobSystem jobs(2);
+		FrameStats stats;
+		stats.Jobs(&jobs);
+		stats.Dump(fileName, 0.1);
+
+		for (uint32 i = 0; i < 35; ++i)
+		{
+			stats.Add(0.01);
+
+			// let each write finish, so no line is replaced by a newer one
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+
+		stats.Flush();
+		CHECK(Lines(fileName) == 1 + 3 + 1);
+
+		stats.Flush();
+		CHECK(Lines(fileName) == 1 + 3 + 1);
+	}
+
+	remove(fileName);
+
+	if (Test::Bench(argc, argv))
+	{
+		const uint32 count = 1000;
+
+		// a dump due on every frame: the cost the frame thread pays
+		FrameStats sync;
+		sync.Dump(fileName, 1e-9);
+		double inline_ = Test::Seconds([&] {
+			for (uint32 i = 0; i < count; ++i)
+				sync.Add(0.016);
+		});
+		remove(fileName);
+
+		JobSystem jobs(2);
+		FrameStats async;
+		async.Jobs(&jobs);
+		async.Dump(fileName, 1e-9);
+		double posted = Test::Seconds([&] {
+			for (uint32 i = 0; i < count; ++i)
+				async.Add(0.016);
+		});
+		async.Flush();
+		remove(fileName);
+
+		FrameStats plain;
+		double add = Test::Seconds([&] {
+			for (uint32 i = 0; i < count * 100; ++i)
+				plain.Add(0.016);
+		});
+
+		printf("Add() with a dump due: written on the frame %.2f us, on a job %.2f us\n",
+			inline_ / count * 1e6, posted / count * 1e6);
+		printf("Add() without a dump: %.1f ns\n", add / (count * 100) * 1e9);
+	}
+
+	return Test::Result("FrameStats");
+}
@@ -0,0 +1,91 @@
+#include "Framebuffer.h"
+#include "Check.h"
+using namespace WXE;
+
+// the pump hands every event to the framebuffer, which
+// takes the MIT-SHM completions and frees their buffer
+static void Complete(void* context, _XEvent* event)
+{
+	static_cast<Linux::Framebuffer*>(context)->Complete(event);
+}
+
+static void Frame(Linux::Window& window, Linux::Framebuffer& framebuffer, const uint32 n)
+{
+	uint32* pixels = framebuffer.Pixels();
+	const uint32 pitch = framebuffer.Pitch();
+
+	for (uint32 y = 0; y < framebuffer.Height(); ++y)
+		for (uint32 x = 0; x < framebuffer.Width(); ++x)
+			pixels[y * pitch + x] = 0xFF000000 | ((x + n) & 0xFF) << 16 | ((y + n) & 0xFF) << 8;
+
+	framebuffer.Present();
+	window.Pump(0, Complete, &framebuffer);
+}
+
+int main(int argc, char** argv)
+{
+	// nothing to present to: ctest reports the test as skipped
+	Linux::Window window;
+
+	if (window.XDisplay() == nullptr)
+	{
+		printf("Framebuffer: skipped, no display\n");
+		return 77;
+	}
+
+	window.Size(256, 256);
+	window.Color(0, 0, 0);
+	CHECK(window.Create());
+
+	Linux::Framebuffer framebuffer;
+	CHECK(framebuffer.Initialize(&window, 256, 256));
+	CHECK(framebuffer.Width() == 256 && framebuffer.Height() == 256);
+	CHECK(framebuffer.Pixels() != nullptr);
+	CHECK(framebuffer.Pitch() >= 256);
+
+	if (framebuffer.Pixels() == nullptr)
+		return Test::Result("Framebuffer");
+
+	// more frames than buffers: both are handed back after
+	// their put, whether the completion was pumped or not
+	for (uint32 i = 0; i < 200; ++i)
+		Frame(window, framebuffer, i);
+
+	CHECK(framebuffer.Pixels() != nullptr);
+
+	// resizing brings up new buffers at the new size
+	CHECK(framebuffer.Resize(320, 200));
+	CHECK(framebuffer.Width() == 320 && framebuffer.Height() == 200);
+	CHECK(framebuffer.Pitch() >= 320);
+
+	for (uint32 i = 0; i < 8; ++i)
+		Frame(window, framebuffer, i);
+
+	// the same size again keeps the buffers
+	uint32* pixels = framebuffer.Pixels();
+	CHECK(framebuffer.Resize(320, 200));
+	CHECK(framebuffer.Pixels() == pixels);
+
+	printf("MIT-SHM: %s\n", framebuffer.Shared() ? "yes" : "no, XPutImage");
+
+	if (Test::Bench(argc, argv))
+	{
+		const uint32 sizes[][2] = { { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 } };
+		const uint32 count = 120;
+
+		for (const auto& size : sizes)
+		{
+			CHECK(framebuffer.Resize(size[0], size[1]));
+
+			double seconds = Test::Seconds([&] {
+				for (uint32 i = 0; i < count; ++i)
+					Frame(window, framebuffer, i);
+				framebuffer.Pixels();
+			});
+
+			printf("%ux%u frame: %.3f ms, %.0f frames/s\n", size[0], size[1], seconds / count * 1000.0, count / seconds);
+		}
+	}
+
+	return Test::Result("Framebuffer");
+}
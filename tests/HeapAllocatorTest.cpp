@@ -0,0 +1,206 @@
+#include "HeapAllocator.h"
+#include "Check.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+using namespace WXE;
+
+struct Live
+{
+	uint32 block;
+	uint64 offset;
+	uint64 size;
+	uint64 alignment;
+};
+
+// every live range is aligned, inside the heap and apart from the others
+static bool Valid(const HeapAllocator& heap, std::vector<Live> live)
+{
+	std::sort(live.begin(), live.end(), [](const Live& a, const Live& b) { return a.offset < b.offset; });
+
+	uint64 end {};
+
+	for (const Live& l : live)
+	{
+		if (heap.Offset(l.block) != l.offset || l.offset % l.alignment != 0)
+			return false;
+
+		if (l.offset < end || l.offset + l.size > heap.Size())
+			return false;
+
+		end = l.offset + l.size;
+	}
+
+	return true;
+}
+
+// random sizes and alignments, about half of the heap kept in use
+static void Churn(HeapAllocator& heap, std::vector<Live>& live, std::mt19937& random, const uint32 steps, bool& valid)
+{
+	const uint64 alignments[] { 256, 4096, 65536 };
+
+	for (uint32 i = 0; i < steps; ++i)
+	{
+		if (!live.empty() && (random() % 2 || heap.Used() > heap.Size() / 2))
+		{
+			uint32 pick = random() % live.size();
+			heap.Free(live[pick].block);
+			live[pick] = live.back();
+			live.pop_back();
+		}
+		else
+		{
+			uint64 size = 256 + random() % (256 << 10);
+			uint64 alignment = alignments[random() % 3];
+			uint32 block = heap.Allocate(size, alignment);
+
+			if (block != HeapAllocator::NONE)
+				live.push_back({ block, heap.Offset(block), size, alignment });
+		}
+
+		if (i % 64 == 0)
+			valid = valid && Valid(heap, live);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	// sizes are rounded to the granularity and a free merges back
+	{
+		HeapAllocator heap(1 << 20);
+
+		uint32 a = heap.Allocate(100);
+		uint32 b = heap.Allocate(300);
+		uint32 c = heap.Allocate(65536, 65536);
+
+		CHECK(a != HeapAllocator::NONE && b != HeapAllocator::NONE && c != HeapAllocator::NONE);
+		CHECK(heap.Offset(c) % 65536 == 0);
+		CHECK(heap.Allocations() == 3);
+		CHECK(heap.Used() == 256 + 512 + 65536);
+
+		heap.Free(b);
+		heap.Free(a);
+		heap.Free(c);
+
+		CHECK(heap.Allocations() == 0);
+		CHECK(heap.Used() == 0);
+		CHECK(heap.LargestFree() == heap.Size());
+		CHECK(heap.Fragmentation() == 0.0);
+	}
+
+	// a full heap says so instead of overlapping
+	{
+		HeapAllocator heap(1 << 20);
+
+		CHECK(heap.Allocate(1 << 20) != HeapAllocator::NONE);
+		CHECK(heap.Allocate(256) == HeapAllocator::NONE);
+	}
+
+	// random churn never overlaps or misaligns, and freeing
+	// everything leaves one range again
+	{
+		HeapAllocator heap(64 << 20);
+		std::vector<Live> live;
+		std::mt19937 random(1);
+		bool valid = true;
+
+		Churn(heap, live, random, 20000, valid);
+		CHECK(valid);
+		CHECK(heap.Allocations() == live.size());
+
+		for (const Live& l : live)
+			heap.Free(l.block);
+
+		CHECK(heap.Used() == 0);
+		CHECK(heap.LargestFree() == heap.Size());
+	}
+
+	// compaction slides blocks down into the holes before them
+	{
+		HeapAllocator heap(64 << 20);
+		std::vector<Live> live;
+		std::mt19937 random(2);
+		bool valid = true;
+
+		Churn(heap, live, random, 5000, valid);
+		double before = heap.Fragmentation();
+
+		uint32 moved = heap.Compact([&](uint32 block, uint64 from, uint64 to, uint64 size)
+		{
+			for (Live& l : live)
+			{
+				if (l.block == block)
+				{
+					valid = valid && (l.offset == from) && (size >= l.size);
+					l.offset = to;
+				}
+			}
+
+			return true;
+		});
+
+		CHECK(valid);
+		CHECK(moved > 0);
+		CHECK(Valid(heap, live));
+		CHECK(heap.Fragmentation() < before);
+		printf("compaction: %u moves, fragmentation %.2f -> %.2f\n", moved, before, heap.Fragmentation());
+	}
+
+	// the pool reserves heaps on demand and gives a dedicated one
+	// to a request too large for them, released with it
+	{
+		uint32 created {};
+		uint32 destroyed {};
+		HeapPool pool;
+
+		pool.Initialize([&](uint64) { return reinterpret_cast<void*>(uintptr_t(++created)); },
+			[&](void*) { destroyed++; }, 1 << 20);
+
+		HeapRange a {}, b {}, big {};
+
+		CHECK(pool.Allocate(768 << 10, 256, &a));
+		CHECK(pool.Allocate(512 << 10, 256, &b));
+		CHECK(created == 2 && a.heap != b.heap);
+
+		CHECK(pool.Allocate(3 << 20, 65536, &big));
+		CHECK(created == 3 && pool.Reserved() == (2 << 20) + (3 << 20));
+
+		pool.Free(big);
+		CHECK(destroyed == 1 && pool.Reserved() == (2 << 20));
+
+		pool.Free(a);
+		pool.Free(b);
+		CHECK(pool.Allocations() == 0);
+
+		pool.Release();
+		CHECK(destroyed == 3);
+	}
+
+	if (Test::Bench(argc, argv))
+	{
+		// allocate + free with more and more blocks live: flat for TLSF
+		for (uint32 liveCount : { 100u, 1000u, 10000u })
+		{
+			HeapAllocator heap(4ull << 30);
+			std::mt19937 random(3);
+			std::vector<uint32> live;
+
+			for (uint32 i = 0; i < liveCount; ++i)
+				live.push_back(heap.Allocate(256 + random() % (64 << 10)));
+
+			const uint32 count = 1000000;
+			double seconds = Test::Seconds([&] {
+				for (uint32 i = 0; i < count; ++i)
+				{
+					uint32 pick = random() % liveCount;
+					heap.Free(live[pick]);
+					live[pick] = heap.Allocate(256 + random() % (64 << 10), (i % 8) ? 256 : 65536);
+				}
+			});
+
+			printf("free + allocate with %5u live: %.1f ns\n", liveCount, seconds / count * 1e9);
+		}
+	}
+
+	return Test::Result("HeapAllocator");
+}
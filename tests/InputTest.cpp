@@ -0,0 +1,390 @@
+#include "Input.h"
+#include "KeyCodes.h"
+#include "Check.h"
+#include <random>
+#include <thread>
+
+#if __has_include(<X11/extensions/XTest.h>)
+	#include <X11/Xlib.h>
+	#include <X11/keysym.h>
+	#include <X11/extensions/XTest.h>
+	#define WXE_XTEST
+
+	// Xlib's event type and grab constant hide the Keyboard methods
+	#undef KeyPress
+	#undef AnyKey
+#endif
+
+using namespace WXE;
+using namespace WXE::Inputs;
+
+static InputEvent Event(const uint8 type, const uint8 key = 0, const int32 x = 0)
+{
+	InputEvent event {};
+	event.time = Clock::now();
+	event.type = type;
+	event.key = key;
+	event.x = x;
+	return event;
+}
+
+// what Edges() works out, one key at a time
+struct Model
+{
+	bool keys[MAX_KEYS];
+	bool prev[MAX_KEYS];
+	bool down[MAX_KEYS];
+	bool up[MAX_KEYS];
+
+	bool Pressed(const uint32 k) const { return (keys[k] && !prev[k]) || (down[k] && up[k]); }
+	bool Released(const uint32 k) const { return (prev[k] && !keys[k]) || (down[k] && up[k]); }
+};
+
+#ifdef WXE_XTEST
+
+// ---------------------------------------------------
+// With --xtest the events are made by the X server:
+// XTest injects them as if from the devices, and one
+// Input takes the XInput2 raw path while another, with
+// raw off, takes the core events of the window. Both
+// must agree on the keys and the pointer.
+// ---------------------------------------------------
+
+struct Receivers
+{
+	Input* core;
+	Input* raw;
+	bool mapped;
+};
+
+static void Dispatch(void* context, _XEvent* event)
+{
+	Receivers* inputs = static_cast<Receivers*>(context);
+
+	if (event->type == MapNotify)
+		inputs->mapped = true;
+
+	inputs->core->InputProc(event);
+	inputs->raw->InputProc(event);
+}
+
+// the server gets the events out in one round trip, the pump
+// keeps reading until nothing more comes for a while
+static void Settle(Linux::Window& window, Receivers& inputs)
+{
+	XSync(window.XDisplay(), False);
+
+	for (uint32 idle = 0; idle < 4; )
+	{
+		idle = XPending(window.XDisplay()) ? 0 : idle + 1;
+		window.Pump(25, Dispatch, &inputs);
+	}
+}
+
+static void Key(_XDisplay* display, const KeySym sym, const bool down)
+{
+	XTestFakeKeyEvent(display, XKeysymToKeycode(display, sym), down, CurrentTime);
+}
+
+static int XTest()
+{
+	Linux::Window window;
+	_XDisplay* display = window.XDisplay();
+	int32 event, error, major, minor;
+
+	if (display == nullptr || !XTestQueryExtension(display, &event, &error, &major, &minor))
+	{
+		printf("Input XTest: skipped, no display with XTest\n");
+		return 77;
+	}
+
+	window.Size(200, 200);
+	CHECK(window.Create());
+
+	Input core(&window, false);
+	Input raw(&window);
+	Receivers inputs { &core, &raw, false };
+
+	for (uint32 i = 0; i < 40 && !inputs.mapped; ++i)
+		window.Pump(50, Dispatch, &inputs);
+
+	CHECK(inputs.mapped);
+
+	// core key events only go to the window with the focus,
+	// core button events to the one under the pointer
+	XSetInputFocus(display, window.Id(), RevertToParent, CurrentTime);
+
+	int32 left, top;
+	::Window child;
+	XTranslateCoordinates(display, window.Id(), DefaultRootWindow(display), 0, 0, &left, &top, &child);
+	XTestFakeMotionEvent(display, DefaultScreen(display), left + 50, top + 60, CurrentTime);
+	Settle(window, inputs);
+	core.Poll();
+	raw.Poll();
+
+	const KeySym syms[] { XK_a, XK_z, XK_5, XK_F1, XK_Left, XK_Shift_L, XK_space, XK_Return, XK_Escape };
+	const uint8 keys[] { VK_A, 'Z', '5', VK_F1, VK_LEFT, VK_SHIFT, VK_SPACE, VK_RETURN, VK_ESCAPE };
+
+	for (KeySym sym : syms)
+		Key(display, sym, true);
+
+	XTestFakeButtonEvent(display, Button1, True, CurrentTime);
+	XTestFakeButtonEvent(display, Button3, True, CurrentTime);
+	XTestFakeButtonEvent(display, Button4, True, CurrentTime);
+	XTestFakeButtonEvent(display, Button4, False, CurrentTime);
+	XTestFakeMotionEvent(display, DefaultScreen(display), left + 70, top + 30, CurrentTime);
+	Settle(window, inputs);
+
+	for (Input* input : { &core, &raw })
+	{
+		input->Poll();
+
+		uint32 held {};
+		for (uint8 key : keys)
+			held += input->KeyDown(key) && input->KeyPress(key);
+
+		CHECK(held == sizeof(keys));
+		CHECK(input->KeyDown(VK_LBUTTON) && input->KeyDown(VK_RBUTTON));
+		CHECK(input->MouseWheel() == 120);
+		CHECK(input->MouseX() == 70 && input->MouseY() == 30);
+	}
+
+	for (KeySym sym : syms)
+		Key(display, sym, false);
+
+	XTestFakeButtonEvent(display, Button1, False, CurrentTime);
+	XTestFakeButtonEvent(display, Button3, False, CurrentTime);
+	Settle(window, inputs);
+
+	for (Input* input : { &core, &raw })
+	{
+		input->Poll();
+
+		uint32 released {};
+		for (uint8 key : keys)
+			released += input->KeyReleased(key) && !input->KeyDown(key);
+
+		CHECK(released == sizeof(keys));
+		CHECK(input->KeyReleased(VK_LBUTTON) && input->KeyReleased(VK_RBUTTON));
+		CHECK(!input->AnyKey());
+	}
+
+#if __has_include(<X11/extensions/XInput2.h>)
+	printf("raw path: XInput2\n");
+#else
+	printf("raw path: built without XInput2, both inputs use core events\n");
+#endif
+
+	return Test::Result("Input XTest");
+}
+
+#endif
+
+int main(int argc, char** argv)
+{
+	// the events from a live X server are a ctest of their own
+	if (argc > 1 && strcmp(argv[1], "--xtest") == 0)
+	{
+	#ifdef WXE_XTEST
+		return XTest();
+	#else
+		printf("Input XTest: skipped, built without XTest\n");
+		return 77;
+	#endif
+	}
+
+	// the ring keeps order and refuses events once full, counting them
+	{
+		InputQueue queue;
+		InputEvent event {};
+
+		for (uint32 i = 0; i < InputQueue::CAPACITY; ++i)
+			CHECK(queue.Push(Event(MOUSE_MOVE, 0, int32(i))));
+
+		CHECK(!queue.Push(Event(MOUSE_MOVE)));
+		CHECK(queue.Dropped() == 1);
+
+		bool ordered = true;
+		for (uint32 i = 0; i < InputQueue::CAPACITY; ++i)
+			ordered = ordered && queue.Pop(event) && event.x == int32(i);
+
+		CHECK(ordered);
+		CHECK(!queue.Pop(event));
+	}
+
+	// one thread pushing, another popping: nothing lost, nothing reordered
+	{
+		InputQueue queue;
+		const int32 count = 1 << 20;
+
+		std::thread producer([&] {
+			for (int32 i = 0; i < count; ++i)
+				while (!queue.Push(Event(MOUSE_MOVE, 0, i)))
+					std::this_thread::yield();
+		});
+
+		int32 expected {};
+		uint32 wrong {};
+		InputEvent event {};
+
+		while (expected < count)
+		{
+			if (queue.Pop(event))
+				wrong += (event.x != expected++);
+			else
+				std::this_thread::yield();
+		}
+
+		producer.join();
+		CHECK(wrong == 0);
+	}
+
+	// Poll drains the frame in arrival order, keeps the timestamps
+	// and sums the wheel
+	{
+		Input input;
+		input.Push(Event(KEY_DOWN, 'W'));
+		input.Push(Event(MOUSE_MOVE, 0, 10));
+
+		for (uint32 i = 0; i < 2; ++i)
+		{
+			InputEvent wheel = Event(MOUSE_WHEEL);
+			wheel.wheel = 120;
+			input.Push(wheel);
+		}
+
+		input.Poll();
+
+		uint32 count {};
+		const InputEvent* events = input.Events(count);
+
+		CHECK(count == 4);
+		CHECK(events[0].type == KEY_DOWN && events[1].type == MOUSE_MOVE);
+		CHECK(events[0].time <= events[1].time && events[1].time <= events[3].time);
+		CHECK(input.KeyDown('W') && input.MouseX() == 10 && input.MouseWheel() == 240);
+
+		input.Poll();
+		input.Events(count);
+		CHECK(count == 0 && input.MouseWheel() == 0);
+	}
+
+	// the SIMD edge masks match the per key rule on every key, the
+	// ones at the ends of the 64-bit words included
+	{
+		Input input;
+		Model model {};
+		std::mt19937 random(1);
+		const uint8 edges[] { 0, 1, 62, 63, 64, 65, 127, 128, 191, 192, 254, 255 };
+		uint32 wrong {};
+
+		for (uint32 frame = 0; frame < 2000; ++frame)
+		{
+			for (uint32 k = 0; k < MAX_KEYS; ++k)
+			{
+				model.prev[k] = model.keys[k];
+				model.down[k] = model.up[k] = false;
+			}
+
+			for (uint32 n = random() % 12; n > 0; --n)
+			{
+				uint8 key = (random() % 2) ? edges[random() % sizeof(edges)] : uint8(random());
+				uint8 type = (random() % 2) ? KEY_DOWN : KEY_UP;
+
+				input.Push(Event(type, key));
+				model.keys[key] = (type == KEY_DOWN);
+				(type == KEY_DOWN ? model.down : model.up)[key] = true;
+			}
+
+			input.Poll();
+
+			for (uint32 k = 0; k < MAX_KEYS; ++k)
+			{
+				wrong += input.KeyDown(uint8(k)) != model.keys[k];
+				wrong += input.KeyPress(uint8(k)) != model.Pressed(k);
+				wrong += input.KeyReleased(uint8(k)) != model.Released(k);
+			}
+		}
+
+		CHECK(wrong == 0);
+	}
+
+	if (Test::Bench(argc, argv))
+	{
+	#if defined(__SSE2__) || defined(_M_X64)
+		const char* path = "SSE2";
+	#else
+		const char* path = "scalar";
+	#endif
+
+		// a poll with nothing queued is the edge pass and the snapshot copies
+		Input input;
+		const uint32 polls = 10000000;
+		double poll = Test::Seconds([&] {
+			for (uint32 i = 0; i < polls; ++i)
+				input.Poll();
+		});
+
+		// the same masks from bool arrays, as before the key sets
+		Model model {};
+		std::mt19937 random(2);
+		for (uint32 k = 0; k < MAX_KEYS; ++k)
+		{
+			model.keys[k] = random() % 2;
+			model.prev[k] = random() % 2;
+		}
+
+		bool pressed[MAX_KEYS];
+		bool released[MAX_KEYS];
+		double bools = Test::Seconds([&] {
+			for (uint32 i = 0; i < polls / 100; ++i)
+			{
+				for (uint32 k = 0; k < MAX_KEYS; ++k)
+				{
+					pressed[k] = model.Pressed(k);
+					released[k] = model.Released(k);
+				}
+
+				// keeps the loop from being hoisted out
+				asm volatile("" : : "r"(pressed), "r"(released), "r"(&model) : "memory");
+			}
+		});
+
+		printf("empty Poll with %s edges: %.1f ns; edges from bool arrays: %.1f ns\n",
+			path, poll / polls * 1e9, bools / (polls / 100) * 1e9);
+
+		InputQueue queue;
+		InputEvent event = Event(MOUSE_MOVE);
+		const uint32 count = 10000000;
+
+		double same = Test::Seconds([&] {
+			for (uint32 i = 0; i < count; ++i)
+			{
+				queue.Push(event);
+				queue.Pop(event);
+			}
+		});
+
+		double crossed = Test::Seconds([&] {
+			std::thread producer([&] {
+				for (uint32 i = 0; i < count; ++i)
+					while (!queue.Push(event))
+						std::this_thread::yield();
+			});
+
+			for (uint32 i = 0; i < count; )
+			{
+				if (queue.Pop(event))
+					i++;
+				else
+					std::this_thread::yield();
+			}
+
+			producer.join();
+		});
+
+		printf("push + pop, one thread: %.1f ns; producer and consumer threads: %.1f ns per event\n",
+			same / count * 1e9, crossed / count * 1e9);
+	}
+
+	return Test::Result("Input");
+}
@@ -0,0 +1,166 @@
+#include "JobSystem.h"
+#include "Check.h"
+#include <algorithm>
+#include <ctime>
+#include <numeric>
+#include <vector>
+using namespace WXE;
+
+static uint64 Sum(JobSystem& jobs, const std::vector<uint32>& values, const uint32 grain)
+{
+	std::atomic<uint64> total{};
+
+	jobs.ParallelFor(static_cast<uint32>(values.size()), grain, [&](uint32 begin, uint32 end)
+	{
+		uint64 part{};
+		for (uint32 i = begin; i < end; ++i)
+			part += values[i];
+		total += part;
+	});
+
+	return total;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32> values(1 << 20);
+	std::iota(values.begin(), values.end(), 0u);
+	const uint64 expected = std::accumulate(values.begin(), values.end(), uint64{});
+
+	// ParallelFor covers every index once, whatever the grain
+	{
+		JobSystem jobs(3);
+
+		for (uint32 grain : { 1u, 7u, 4096u, 1u << 20 })
+			CHECK(Sum(jobs, values, grain) == expected);
+	}
+
+	// workers of one system calling into a smaller one use
+	// that system's queue 0, not their own index
+	{
+		JobSystem outer(4);
+		JobSystem inner(1);
+		JobCounter counter{};
+		std::atomic<uint32> wrong{};
+
+		for (uint32 i = 0; i < 64; ++i)
+		{
+			outer.Schedule([&] {
+				if (Sum(inner, values, 1 << 14) != expected)
+					wrong++;
+			}, &counter);
+		}
+
+		outer.Wait(counter);
+		CHECK(wrong == 0);
+	}
+
+	// a dependent job runs after every job of its dependency
+	{
+		JobSystem jobs(2);
+		JobCounter producers{};
+		JobCounter consumer{};
+		std::atomic<uint32> produced{};
+		uint32 seen{};
+
+		for (uint32 i = 0; i < 100; ++i)
+			jobs.Schedule([&] { std::this_thread::sleep_for(std::chrono::microseconds(100)); produced++; }, &producers);
+
+		jobs.Schedule([&] { seen = produced; }, &consumer, &producers);
+		jobs.Wait(consumer);
+
+		CHECK(seen == 100);
+	}
+
+	// a dependency already done does not hold the job back
+	{
+		JobSystem jobs(1);
+		JobCounter done{};
+		JobCounter counter{};
+		bool ran{};
+
+		jobs.Schedule([&] { ran = true; }, &counter, &done);
+		jobs.Wait(counter);
+
+		CHECK(ran);
+	}
+
+	// a parked job costs no CPU while its dependency runs
+	{
+		JobSystem jobs(2);
+		JobCounter slow{};
+		JobCounter after{};
+		std::atomic<bool> ran{};
+
+		jobs.Schedule([] { std::this_thread::sleep_for(std::chrono::milliseconds(100)); }, &slow);
+		jobs.Schedule([&] { ran = true; }, &after, &slow);
+
+		std::clock_t start = std::clock();
+		std::this_thread::sleep_for(std::chrono::milliseconds(80));
+		double cpu = double(std::clock() - start) / CLOCKS_PER_SEC;
+
+		jobs.Wait(after);
+
+		CHECK(ran);
+		CHECK(cpu < 0.02);
+		printf("cpu while parked: %.1f ms over 80 ms\n", cpu * 1000.0);
+	}
+
+	// the waiter may free a counter as soon as it reads zero, while
+	// jobs are parked: finishing the last job must not touch it after
+	{
+		JobSystem jobs(2);
+		JobCounter other{};
+		std::atomic<uint32> ran{};
+
+		jobs.Schedule([] { std::this_thread::sleep_for(std::chrono::milliseconds(20)); }, &other);
+		jobs.Schedule([&] { ran++; }, nullptr, &other);
+
+		for (uint32 i = 0; i < 20000; ++i)
+		{
+			JobCounter* counter = new JobCounter{};
+			jobs.Schedule([] {}, counter);
+			jobs.Schedule([] {}, counter);
+			jobs.Wait(*counter);
+			delete counter;
+		}
+
+		jobs.Wait(other);
+		while (ran == 0)
+			std::this_thread::yield();
+
+		CHECK(ran == 1);
+	}
+
+	if (Test::Bench(argc, argv))
+	{
+		JobSystem jobs;
+		printf("workers: %u\n", jobs.Workers());
+
+		const uint32 count = 200000;
+		double schedule = Test::Seconds([&] {
+			JobCounter counter{};
+			for (uint32 i = 0; i < count; ++i)
+				jobs.Schedule([] {}, &counter);
+			jobs.Wait(counter);
+		});
+		printf("schedule + run empty job: %.0f ns\n", schedule / count * 1e9);
+
+		volatile uint64 sink{};
+		double serial = Test::Seconds([&] { sink = std::accumulate(values.begin(), values.end(), uint64{}); });
+		printf("sum of 1M: serial %.3f ms\n", serial * 1000.0);
+
+		// n workers besides the calling thread, which helps while it waits
+		uint32 cores = std::max(std::thread::hardware_concurrency(), 1u);
+
+		for (uint32 n = 1; n <= cores; ++n)
+		{
+			JobSystem scaled(n);
+			double parallel = Test::Seconds([&] { sink = Sum(scaled, values, 1 << 14); });
+			printf("sum of 1M: ParallelFor with %2u workers %.3f ms, %.2fx serial\n",
+				n, parallel * 1000.0, serial / parallel);
+		}
+	}
+
+	return Test::Result("JobSystem");
+}
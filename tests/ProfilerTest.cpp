@@ -0,0 +1,263 @@
+#include "Profiler.h"
+#include "Check.h"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+using namespace WXE;
+
+// ---------------------------------------------------
+// Just enough of a JSON reader to take the trace apart:
+// anything the format does not allow fails the parse.
+// ---------------------------------------------------
+
+struct Json
+{
+	std::map<std::string, Json> members;
+	std::vector<Json> items;
+	std::string text;
+	double number {};
+};
+
+class Reader
+{
+private:
+	const std::string& in;
+	size_t at;
+
+	void Space() { while (at < in.size() && strchr(" \t\r\n", in[at])) ++at; }
+	bool Take(const char c) { Space(); if (at < in.size() && in[at] == c) { ++at; return true; } return false; }
+
+	bool String(std::string& out)
+	{
+		if (!Take('"'))
+			return false;
+
+		while (at < in.size() && in[at] != '"')
+		{
+			char c = in[at++];
+
+			if (uint8(c) < 0x20)
+				return false;
+
+			if (c == '\\')
+			{
+				if (at >= in.size())
+					return false;
+
+				switch (c = in[at++])
+				{
+				case '"': case '\\': case '/': out += c; break;
+				case 'n': out += '\n'; break;
+				case 't': out += '\t'; break;
+				case 'r': out += '\r'; break;
+				case 'b': out += '\b'; break;
+				case 'f': out += '\f'; break;
+				case 'u':
+					if (at + 4 > in.size())
+						return false;
+					out += char(std::stoi(in.substr(at, 4), nullptr, 16));
+					at += 4;
+					break;
+				default: return false;
+				}
+			}
+			else
+			{
+				out += c;
+			}
+		}
+
+		return Take('"');
+	}
+
+public:
+	Reader(const std::string& in) : in{ in }, at{} {}
+
+	bool Value(Json& out)
+	{
+		Space();
+
+		if (Take('{'))
+		{
+			if (Take('}'))
+				return true;
+
+			do
+			{
+				std::string key;
+				if (!String(key) || !Take(':') || !Value(out.members[key]))
+					return false;
+			}
+			while (Take(','));
+
+			return Take('}');
+		}
+
+		if (Take('['))
+		{
+			if (Take(']'))
+				return true;
+
+			do
+			{
+				out.items.emplace_back();
+				if (!Value(out.items.back()))
+					return false;
+			}
+			while (Take(','));
+
+			return Take(']');
+		}
+
+		if (at < in.size() && in[at] == '"')
+			return String(out.text);
+
+		size_t used {};
+		try { out.number = std::stod(in.substr(at, 32), &used); } catch (...) { return false; }
+		at += used;
+		return used > 0;
+	}
+
+	bool End() { Space(); return at == in.size(); }
+};
+
+static bool Parse(const char* fileName, Json& trace)
+{
+	std::ifstream file(fileName);
+	std::stringstream text;
+	text << file.rdbuf();
+
+	std::string json = text.str();
+	Reader reader(json);
+	return reader.Value(trace) && reader.End();
+}
+
+// an outer zone with inner ones, the way frames nest their stages
+static void Frame(const uint32 inner)
+{
+	PROFILE_ZONE("Frame \"outer\" \\ zone");
+
+	for (uint32 i = 0; i < inner; ++i)
+	{
+		PROFILE_ZONE("Inner");
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* fileName = "ProfilerTest.json";
+
+	// nested zones on several threads come out as one valid trace,
+	// with the names as written and the inner zones inside the outer
+	{
+		const uint32 threads = 4;
+		const uint32 frames = 20;
+		const uint32 inner = 3;
+
+		// recorded before the capture: left out
+		Frame(1);
+
+		Profiler::Start();
+
+		std::vector<std::thread> workers;
+		for (uint32 t = 0; t < threads; ++t)
+			workers.emplace_back([] { for (uint32 f = 0; f < frames; ++f) Frame(inner); });
+
+		for (std::thread& worker : workers)
+			worker.join();
+
+		CHECK(Profiler::Stop(fileName));
+
+		Json trace;
+		bool parsed = Parse(fileName, trace);
+		CHECK(parsed);
+
+		if (!parsed)
+			return Test::Result("Profiler");
+
+		const std::vector<Json>& events = trace.members["traceEvents"].items;
+		CHECK(events.size() == threads * frames * (inner + 1));
+		CHECK(trace.members["displayTimeUnit"].text == "ms");
+
+		std::map<double, std::vector<const Json*>> outer;
+		uint32 named {};
+
+		for (const Json& event : events)
+		{
+			const Json& name = event.members.at("name");
+			named += name.text == "Frame \"outer\" \\ zone" || name.text == "Inner";
+
+			if (name.text != "Inner")
+				outer[event.members.at("tid").number].push_back(&event);
+		}
+
+		CHECK(named == events.size());
+		CHECK(outer.size() == threads);
+
+		// every inner zone lies inside an outer zone of its thread
+		uint32 nested {};
+		for (const Json& event : events)
+		{
+			if (event.members.at("name").text != "Inner")
+				continue;
+
+			double ts = event.members.at("ts").number;
+			double end = ts + event.members.at("dur").number;
+
+			for (const Json* frame : outer[event.members.at("tid").number])
+			{
+				double begin = frame->members.at("ts").number;
+				if (begin <= ts && end <= begin + frame->members.at("dur").number + 0.001)
+				{
+					nested++;
+					break;
+				}
+			}
+		}
+
+		CHECK(nested == threads * frames * inner);
+	}
+
+	// a capture stopped while threads keep recording is still whole
+	{
+		std::atomic<bool> stop {};
+		std::vector<std::thread> workers;
+
+		Profiler::Start();
+
+		for (uint32 t = 0; t < 2; ++t)
+			workers.emplace_back([&] { while (!stop) { PROFILE_ZONE("Busy"); } });
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		CHECK(Profiler::Stop(fileName));
+
+		stop = true;
+		for (std::thread& worker : workers)
+			worker.join();
+
+		Json trace;
+		CHECK(Parse(fileName, trace));
+		CHECK(!trace.members["traceEvents"].items.empty());
+	}
+
+	if (Test::Bench(argc, argv))
+	{
+		const uint32 count = 10000000;
+
+		double off = Test::Seconds([] { for (uint32 i = 0; i < count; ++i) { PROFILE_ZONE("Off"); } });
+
+		Profiler::Start();
+		double on = Test::Seconds([] { for (uint32 i = 0; i < count; ++i) { PROFILE_ZONE("On"); } });
+		double write = Test::Seconds([&] { Profiler::Stop(fileName); });
+
+		printf("zone: %.1f ns captured, %.1f ns not; Stop writes %u zones per thread in %.1f ms\n",
+			on / count * 1e9, off / count * 1e9, uint32(Profiler::RING_SIZE), write * 1000.0);
+	}
+
+	remove(fileName);
+	return Test::Result("Profiler");
+}
@@ -0,0 +1,237 @@
+#include "Graphics.h"
+#include "Rasterizer.h"
+#include "Check.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+using namespace WXE;
+
+using Vertex = Rasterizer::Vertex;
+
+static const uint32 background = 0x007ACC;
+
+// one draw through the buffer path the Triangle sample uses
+static void Draw(Soft::Graphics& graphics, const Vertex* vertices, const uint32 count)
+{
+	Soft::Buffer* buffer { nullptr };
+	graphics.Allocate(count * sizeof(Vertex), &buffer);
+	graphics.Copy(vertices, count * sizeof(Vertex), buffer);
+	graphics.Draw(buffer, sizeof(Vertex), count);
+	buffer->Release();
+}
+
+static uint32 Pixel(const Soft::Graphics& graphics, const uint32 x, const uint32 y)
+{
+	return graphics.Pixels()[y * graphics.Pitch() + x];
+}
+
+static uint8 Red(const uint32 pixel) { return uint8(pixel >> 16); }
+static uint8 Green(const uint32 pixel) { return uint8(pixel >> 8); }
+static uint8 Blue(const uint32 pixel) { return uint8(pixel); }
+
+// a clockwise square of two triangles at depth z
+static void Square(std::vector<Vertex>& out, const float x0, const float y0, const float x1, const float y1,
+	const float z, const float r, const float g, const float b)
+{
+	Vertex corners[4] =
+	{
+		{ x0, y1, z, r, g, b, 1.0f }, { x1, y1, z, r, g, b, 1.0f },
+		{ x1, y0, z, r, g, b, 1.0f }, { x0, y0, z, r, g, b, 1.0f }
+	};
+
+	for (uint32 i : { 0, 1, 2, 0, 2, 3 })
+		out.push_back(corners[i]);
+}
+
+// count small triangles scattered over the screen, at random depths
+static std::vector<Vertex> Scene(const uint32 count, const float size)
+{
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<Vertex> vertices;
+	vertices.reserve(count * 3);
+
+	for (uint32 i = 0; i < count; ++i)
+	{
+		float x = unit(random) * 2.0f - 1.0f;
+		float y = unit(random) * 2.0f - 1.0f;
+		float z = unit(random);
+		float r = unit(random), g = unit(random), b = unit(random);
+
+		vertices.push_back({ x, y + size, z, r, g, b, 1.0f });
+		vertices.push_back({ x + size, y - size, z, r, g, b, 1.0f });
+		vertices.push_back({ x - size, y - size, z, r, g, b, 1.0f });
+	}
+
+	return vertices;
+}
+
+int main(int argc, char** argv)
+{
+	// without a display the backend renders offscreen
+	Linux::Window window;
+	window.Size(128, 128);
+	window.Color(0, 122, 204);
+
+	JobSystem jobs(2);
+	Soft::Graphics graphics;
+	graphics.Initialize(&window, &jobs);
+
+	// the Triangle sample: red on top, orange right, yellow left
+	{
+		const Vertex vertices[] =
+		{
+			{ 0.0f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f },
+			{ 0.5f, -0.5f, 0.0f, 1.0f, 0.647f, 0.0f, 1.0f },
+			{ -0.5f, -0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f }
+		};
+
+		graphics.Clear();
+		Draw(graphics, vertices, 3);
+		graphics.Present();
+
+		CHECK(graphics.Pixels() != nullptr && graphics.Pitch() >= 128);
+
+		// outside, then near each corner and in the middle
+		CHECK(Pixel(graphics, 2, 2) == background && Pixel(graphics, 125, 125) == background);
+		CHECK(Pixel(graphics, 64, 20) == background && Pixel(graphics, 64, 100) == background);
+
+		uint32 top = Pixel(graphics, 64, 34);
+		uint32 right = Pixel(graphics, 92, 94);
+		uint32 left = Pixel(graphics, 36, 94);
+		uint32 middle = Pixel(graphics, 64, 72);
+
+		CHECK(Red(top) == 255 && Green(top) < 16 && Blue(top) == 0);
+		CHECK(Red(right) == 255 && Green(right) > 140 && Green(right) < 175 && Blue(right) == 0);
+		CHECK(Red(left) == 255 && Green(left) > 235 && Blue(left) == 0);
+		CHECK(Red(middle) == 255 && Green(middle) > Green(top) && Green(middle) < Green(left));
+	}
+
+	// the nearer square wins whatever the order, and on equal depth
+	// the first one drawn stays (LESS)
+	{
+		std::vector<Vertex> farFirst, nearFirst, equal;
+		Square(farFirst, -0.5f, -0.5f, 0.5f, 0.5f, 0.8f, 0.0f, 0.0f, 1.0f);
+		Square(farFirst, -0.25f, -0.25f, 0.75f, 0.75f, 0.2f, 0.0f, 1.0f, 0.0f);
+		Square(nearFirst, -0.25f, -0.25f, 0.75f, 0.75f, 0.2f, 0.0f, 1.0f, 0.0f);
+		Square(nearFirst, -0.5f, -0.5f, 0.5f, 0.5f, 0.8f, 0.0f, 0.0f, 1.0f);
+		Square(equal, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 1.0f);
+		Square(equal, -0.25f, -0.25f, 0.75f, 0.75f, 0.5f, 0.0f, 1.0f, 0.0f);
+
+		for (const std::vector<Vertex>* scene : { &farFirst, &nearFirst })
+		{
+			graphics.Clear();
+			Draw(graphics, scene->data(), uint32(scene->size()));
+			graphics.Present();
+
+			// overlap at the center, the far square alone at the bottom left
+			CHECK(Pixel(graphics, 64, 64) == 0x00FF00);
+			CHECK(Pixel(graphics, 40, 88) == 0x0000FF);
+			CHECK(Pixel(graphics, 100, 28) == 0x00FF00);
+		}
+
+		graphics.Clear();
+		Draw(graphics, equal.data(), uint32(equal.size()));
+		graphics.Present();
+		CHECK(Pixel(graphics, 64, 64) == 0x0000FF);
+
+		// outside [0, 1] nothing is written
+		std::vector<Vertex> clipped;
+		Square(clipped, -0.5f, -0.5f, 0.5f, 0.5f, 1.5f, 1.0f, 0.0f, 0.0f);
+		graphics.Clear();
+		Draw(graphics, clipped.data(), uint32(clipped.size()));
+		graphics.Present();
+		CHECK(Pixel(graphics, 64, 64) == background);
+	}
+
+	// back faces are culled unless culling is off
+	{
+		const Vertex counter[] =
+		{
+			{ 0.0f, 0.5f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f },
+			{ -0.5f, -0.5f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f },
+			{ 0.5f, -0.5f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f }
+		};
+
+		graphics.Clear();
+		Draw(graphics, counter, 3);
+		graphics.Present();
+		CHECK(Pixel(graphics, 64, 72) == background);
+
+		graphics.Culling(false);
+		graphics.Clear();
+		Draw(graphics, counter, 3);
+		graphics.Present();
+		CHECK(Pixel(graphics, 64, 72) == 0xFFFFFF);
+		graphics.Culling(true);
+	}
+
+	// a scene across many tiles comes out the same from the job
+	// system as from one thread, at a size that is no tile multiple
+	{
+		window.Size(300, 200);
+		std::vector<Vertex> scene = Scene(2000, 0.05f);
+		std::vector<uint32> single;
+
+		Soft::Graphics serial;
+		serial.Initialize(&window, nullptr);
+		serial.Clear();
+		Draw(serial, scene.data(), uint32(scene.size()));
+		serial.Present();
+
+		for (uint32 y = 0; y < 200; ++y)
+			single.insert(single.end(), serial.Pixels() + y * serial.Pitch(), serial.Pixels() + y * serial.Pitch() + 300);
+
+		graphics.Clear();
+		Draw(graphics, scene.data(), uint32(scene.size()));
+		graphics.Present();
+
+		bool same = graphics.Pitch() >= 300;
+		for (uint32 y = 0; same && y < 200; ++y)
+			same = std::equal(single.begin() + y * 300, single.begin() + (y + 1) * 300, graphics.Pixels() + y * graphics.Pitch());
+
+		CHECK(same);
+		CHECK(std::count(single.begin(), single.end(), background) < int64(single.size()) / 2);
+	}
+
+	if (Test::Bench(argc, argv))
+	{
+		// small triangles of a stress scene, and larger ones that overlap
+		// more, at 720p against the number of workers rendering tiles
+		window.Size(1280, 720);
+		uint32 cores = std::max(std::thread::hardware_concurrency(), 1u);
+
+		for (uint32 count : { 1000u, 10000u, 100000u })
+		{
+			std::vector<Vertex> scene = Scene(count, count >= 100000 ? 0.01f : 0.04f);
+
+			Soft::Buffer* buffer { nullptr };
+			graphics.Allocate(uint32(scene.size() * sizeof(Vertex)), &buffer);
+			graphics.Copy(scene.data(), uint32(scene.size() * sizeof(Vertex)), buffer);
+
+			for (uint32 workers = 0; workers <= cores; ++workers)
+			{
+				JobSystem pool(workers ? workers : 1);
+				Soft::Graphics renderer;
+				renderer.Initialize(&window, workers ? &pool : nullptr);
+
+				const uint32 frames = count >= 100000 ? 10 : 50;
+				double seconds = Test::Seconds([&] {
+					for (uint32 i = 0; i < frames; ++i)
+					{
+						renderer.Clear();
+						renderer.Draw(buffer, sizeof(Vertex), uint32(scene.size()));
+						renderer.Present();
+					}
+				});
+
+				printf("%6u triangles, %u workers%s: %.2f ms/frame, %.1f Mtris/s\n", count, workers,
+					workers ? "" : " (no job system)", seconds / frames * 1000.0, count * frames / seconds / 1e6);
+			}
+
+			buffer->Release();
+		}
+	}
+
+	return Test::Result("Rasterizer");
+}
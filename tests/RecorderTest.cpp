@@ -0,0 +1,84 @@
+#include "Recorder.h"
+#include "Check.h"
+#include <cstdio>
+#include <vector>
+using namespace WXE;
+using namespace WXE::Inputs;
+
+static InputEvent Key(const uint8 type, const uint8 key)
+{
+	InputEvent event {};
+	event.time = Clock::now();
+	event.type = type;
+	event.key = key;
+	return event;
+}
+
+int main()
+{
+	const char* fileName = "RecorderTest.rec";
+
+	// record: a tap inside one frame, a held key, then a quiet frame
+	{
+		Input input;
+		Recorder recorder;
+		CHECK(recorder.Record(fileName));
+
+		input.Push(Key(KEY_DOWN, 'A'));
+		input.Push(Key(KEY_UP, 'A'));
+		input.Push(Key(KEY_DOWN, 'B'));
+		input.Poll();
+		recorder.Write(&input, 0.016);
+
+		input.Poll();
+		recorder.Write(&input, 0.017);
+
+		CHECK(recorder.Frames() == 2);
+	}
+
+	// replay: the tap still shows up as pressed and released
+	{
+		Input input;
+		Recorder recorder;
+		double frameTime {};
+		CHECK(recorder.Replay(fileName));
+
+		CHECK(recorder.Read(&input, frameTime));
+		CHECK(frameTime == 0.016);
+		CHECK(input.KeyPress('A') && input.KeyReleased('A'));
+		CHECK(input.KeyUp('A'));
+		CHECK(input.KeyPress('B') && input.KeyDown('B'));
+
+		CHECK(recorder.Read(&input, frameTime));
+		CHECK(frameTime == 0.017);
+		CHECK(!input.KeyPress('A') && !input.KeyReleased('A'));
+		CHECK(!input.KeyPress('B') && input.KeyDown('B'));
+
+		CHECK(!recorder.Read(&input, frameTime));
+	}
+
+	// a frame cut short ends the replay instead of reaching the input
+	{
+		std::vector<char> bytes(4096);
+		FILE* file = fopen(fileName, "rb");
+		bytes.resize(fread(bytes.data(), 1, bytes.size(), file));
+		fclose(file);
+
+		file = fopen(fileName, "wb");
+		fwrite(bytes.data(), 1, bytes.size() - 3, file);
+		fclose(file);
+
+		Input input;
+		Recorder recorder;
+		double frameTime {};
+		CHECK(recorder.Replay(fileName));
+
+		CHECK(recorder.Read(&input, frameTime));
+		CHECK(!recorder.Read(&input, frameTime));
+		CHECK(recorder.Mode() == IDLE);
+		CHECK(input.KeyPress('A'));
+	}
+
+	remove(fileName);
+	return Test::Result("Recorder");
+}
@@ -0,0 +1,206 @@
+#include "ResourceStates.h"
+#include "Check.h"
+#include <vector>
+using namespace WXE;
+
+// the D3D12_RESOURCE_STATES values the tracker is used with
+enum : uint32
+{
+	COMMON = 0x0,
+	VERTEX_AND_CONSTANT_BUFFER = 0x1,
+	INDEX_BUFFER = 0x2,
+	RENDER_TARGET = 0x4,
+	NON_PIXEL_SHADER_RESOURCE = 0x40,
+	PIXEL_SHADER_RESOURCE = 0x80,
+	INDIRECT_ARGUMENT = 0x200,
+	COPY_DEST = 0x400,
+	COPY_SOURCE = 0x800,
+	GENERIC_READ = 0xAC3
+};
+
+static bool Is(const Transition& t, void* resource, const uint32 subresource, const uint32 before, const uint32 after)
+{
+	return t.resource == resource && t.subresource == subresource && t.before == before && t.after == after;
+}
+
+int main(int argc, char** argv)
+{
+	int a, b, c;
+	const uint32 ALL = StateTracker::ALL_SUBRESOURCES;
+
+	// a transition to the state held is dropped, as are requests
+	// for resources not tracked or subresources out of range
+	{
+		StateTracker states;
+		states.Track(&a, COPY_DEST);
+
+		CHECK(states.Require(&a, COPY_DEST));
+		CHECK(states.Pending() == 0 && states.Elided() == 1);
+
+		CHECK(!states.Require(&b, COPY_DEST));
+		CHECK(states.Require(&a, COPY_SOURCE));
+		CHECK(states.Pending() == 1);
+	}
+
+	// reading from a read state that includes the one asked for is
+	// no transition, but only the states declared read-only merge
+	{
+		StateTracker states(GENERIC_READ);
+		states.Track(&a, GENERIC_READ);
+		states.Track(&b, RENDER_TARGET | PIXEL_SHADER_RESOURCE);
+
+		CHECK(states.Require(&a, VERTEX_AND_CONSTANT_BUFFER));
+		CHECK(states.Require(&a, INDEX_BUFFER | COPY_SOURCE));
+		CHECK(states.Pending() == 0 && states.Elided() == 2);
+		CHECK(states.State(&a) == GENERIC_READ);
+
+		CHECK(states.Require(&b, PIXEL_SHADER_RESOURCE));
+		CHECK(states.Pending() == 1 && states.State(&b) == PIXEL_SHADER_RESOURCE);
+
+		StateTracker strict;
+		strict.Track(&a, GENERIC_READ);
+		CHECK(strict.Require(&a, VERTEX_AND_CONSTANT_BUFFER));
+		CHECK(strict.Pending() == 1 && strict.Elided() == 0);
+	}
+
+	// there and back cancels, a second move redirects the first, and
+	// only the last pending transition of a resource is changed
+	{
+		StateTracker states;
+		RecordingList list;
+		states.Track(&a, RENDER_TARGET);
+		states.Track(&b, COMMON);
+
+		states.Require(&a, COPY_SOURCE);
+		states.Require(&a, RENDER_TARGET);
+		CHECK(states.Pending() == 0 && states.Elided() == 2);
+
+		states.Require(&a, COPY_SOURCE);
+		states.Require(&b, COPY_DEST);
+		states.Require(&a, PIXEL_SHADER_RESOURCE);
+		CHECK(states.Pending() == 2 && states.Elided() == 3);
+
+		states.Flush(&list);
+		CHECK(list.Recorded().size() == 2);
+		CHECK(Is(list.Recorded()[0], &a, ALL, RENDER_TARGET, PIXEL_SHADER_RESOURCE));
+		CHECK(Is(list.Recorded()[1], &b, ALL, COMMON, COPY_DEST));
+	}
+
+	// subresources moved on their own split the state, and it is one
+	// state again once they all agree
+	{
+		StateTracker states;
+		RecordingList list;
+		states.Track(&a, COPY_DEST, 4);
+
+		CHECK(states.Require(&a, PIXEL_SHADER_RESOURCE, 1));
+		CHECK(!states.Require(&a, PIXEL_SHADER_RESOURCE, 4));
+		CHECK(states.State(&a, 1) == PIXEL_SHADER_RESOURCE && states.State(&a, 0) == COPY_DEST);
+
+		states.Flush(&list);
+		CHECK(list.Recorded().size() == 1 && Is(list.Recorded()[0], &a, 1, COPY_DEST, PIXEL_SHADER_RESOURCE));
+
+		// the whole resource: the subresource already there is skipped
+		list.Reset();
+		CHECK(states.Require(&a, PIXEL_SHADER_RESOURCE));
+		states.Flush(&list);
+
+		bool each = list.Recorded().size() == 3;
+		for (uint32 i = 0; each && i < 3; ++i)
+			each = list.Recorded()[i].subresource != 1 && list.Recorded()[i].before == COPY_DEST;
+
+		CHECK(each);
+
+		bool merged = true;
+		for (uint32 i = 0; i < 4; ++i)
+			merged = merged && states.State(&a, i) == PIXEL_SHADER_RESOURCE;
+
+		CHECK(merged);
+
+		// merged back, a whole resource move is one transition again
+		list.Reset();
+		states.Require(&a, RENDER_TARGET);
+		states.Flush(&list);
+		CHECK(list.Recorded().size() == 1 && Is(list.Recorded()[0], &a, ALL, PIXEL_SHADER_RESOURCE, RENDER_TARGET));
+	}
+
+	// Flush hands everything pending to the list in one call, and
+	// the counters add up to what was asked for
+	{
+		StateTracker states(GENERIC_READ);
+		RecordingList list;
+		states.Track(&a, COPY_DEST);
+		states.Track(&b, RENDER_TARGET);
+		states.Track(&c, COMMON);
+
+		states.Require(&a, GENERIC_READ);
+		states.Require(&b, PIXEL_SHADER_RESOURCE);
+		states.Require(&c, COPY_DEST);
+		states.Require(&a, VERTEX_AND_CONSTANT_BUFFER);
+		states.Require(&c, COMMON);
+		states.Flush(&list);
+
+		CHECK(list.Calls() == 1 && list.Recorded().size() == 2);
+		CHECK(states.Issued() == 2 && states.Elided() == 3 && states.Batches() == 1);
+		CHECK(states.Pending() == 0);
+
+		// nothing pending: no call, no batch
+		states.Flush(&list);
+		CHECK(list.Calls() == 1 && states.Batches() == 1);
+
+		// a resource going away takes its pending transitions with it
+		states.Require(&b, RENDER_TARGET);
+		states.Require(&a, COPY_DEST);
+		states.Untrack(&b);
+		CHECK(states.Pending() == 1 && !states.Require(&b, COMMON));
+
+		states.Flush(&list);
+		CHECK(list.Calls() == 2 && states.Issued() == 3 && states.Batches() == 2);
+	}
+
+	if (Test::Bench(argc, argv))
+	{
+		// a frame of a small renderer: targets rendered to and then
+		// sampled, buffers read with some states asked again
+		const uint32 resources = 64;
+		const uint32 frames = 10000;
+		std::vector<int> objects(resources);
+		StateTracker states(GENERIC_READ);
+		RecordingList list;
+
+		for (int& object : objects)
+			states.Track(&object, COMMON);
+
+		uint64 requests {};
+		double seconds = Test::Seconds([&] {
+			for (uint32 frame = 0; frame < frames; ++frame)
+			{
+				for (uint32 i = 0; i < resources / 2; ++i)
+				{
+					states.Require(&objects[i], RENDER_TARGET);
+					states.Require(&objects[i], RENDER_TARGET);
+				}
+				states.Flush(&list);
+
+				for (uint32 i = 0; i < resources / 2; ++i)
+					states.Require(&objects[i], PIXEL_SHADER_RESOURCE);
+				for (uint32 i = resources / 2; i < resources; ++i)
+				{
+					states.Require(&objects[i], GENERIC_READ);
+					states.Require(&objects[i], VERTEX_AND_CONSTANT_BUFFER);
+					states.Require(&objects[i], INDEX_BUFFER);
+				}
+				states.Flush(&list);
+				list.Reset();
+
+				requests += resources * 3;
+			}
+		});
+
+		printf("Require: %.1f ns; %llu requests, %llu barriers issued in %llu batches, %llu elided\n",
+			seconds / requests * 1e9, (unsigned long long)requests, (unsigned long long)states.Issued(),
+			(unsigned long long)states.Batches(), (unsigned long long)states.Elided());
+	}
+
+	return Test::Result("ResourceStates");
+}
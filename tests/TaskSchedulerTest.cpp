@@ -0,0 +1,132 @@
+#include "TaskScheduler.h"
+#include "Check.h"
+#include <stdexcept>
+using namespace WXE;
+
+static Task Frames(uint32& count, const uint32 frames)
+{
+	for (uint32 i = 0; i < frames; ++i)
+	{
+		count++;
+		co_await NextFrame{};
+	}
+}
+
+static Task Throws(uint32& count)
+{
+	count++;
+	co_await NextFrame{};
+	count++;
+	throw std::runtime_error("task");
+}
+
+static Task Sleeps(bool& woken, const double secs)
+{
+	co_await Seconds{ secs };
+	woken = true;
+}
+
+int main(int argc, char** argv)
+{
+	// a task awaiting NextFrame() runs once per frame
+	{
+		TaskScheduler scheduler;
+		uint32 count{};
+
+		scheduler.Start(Frames(count, 3));
+		CHECK(count == 1);
+
+		scheduler.Update(0.016);
+		CHECK(count == 2);
+		scheduler.Update(0.016);
+		scheduler.Update(0.016);
+
+		CHECK(count == 3);
+		CHECK(scheduler.Count() == 0);
+	}
+
+	// a task that throws is destroyed and its exception kept,
+	// the tasks resumed after it in the same frame still run
+	{
+		TaskScheduler scheduler;
+		uint32 thrown{};
+		uint32 count{};
+
+		scheduler.Start(Throws(thrown));
+		scheduler.Start(Frames(count, 5));
+		CHECK(!scheduler.Failure());
+
+		scheduler.Update(0.016);
+		CHECK(thrown == 2);
+		CHECK(count == 2);
+		CHECK(scheduler.Count() == 1);
+
+		std::exception_ptr failure = scheduler.Failure();
+		CHECK(failure);
+		CHECK(!scheduler.Failure());
+
+		try { std::rethrow_exception(failure); }
+		catch (std::runtime_error& e) { CHECK(strcmp(e.what(), "task") == 0); }
+
+		// nothing of the failed task is resumed again
+		scheduler.Update(0.016);
+		CHECK(thrown == 2);
+		CHECK(count == 3);
+	}
+
+	// sleepers wake on the frame their time is up
+	{
+		TaskScheduler scheduler;
+		bool woken{};
+
+		scheduler.Start(Sleeps(woken, 0.05));
+		scheduler.Update(0.03);
+		CHECK(!woken);
+		scheduler.Update(0.03);
+		CHECK(woken);
+	}
+
+	// a job runs on a worker and its task resumes on a later frame
+	{
+		JobSystem jobs(2);
+		TaskScheduler scheduler(&jobs);
+		bool done{};
+
+		auto task = [](bool& done) -> Task
+		{
+			uint32 value{};
+			co_await RunJob{ [&value] { value = 42; } };
+			done = (value == 42);
+		};
+
+		scheduler.Start(task(done));
+
+		for (uint32 i = 0; i < 1000 && !done; ++i)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			scheduler.Update(0.001);
+		}
+
+		CHECK(done);
+	}
+
+	if (Test::Bench(argc, argv))
+	{
+		TaskScheduler scheduler;
+		const uint32 tasks = 10000;
+		const uint32 frames = 100;
+		uint32 count{};
+
+		for (uint32 i = 0; i < tasks; ++i)
+			scheduler.Start(Frames(count, frames + 1));
+
+		double seconds = Test::Seconds([&] {
+			for (uint32 i = 0; i < frames; ++i)
+				scheduler.Update(0.016);
+		});
+
+		printf("resume per task per frame: %.1f ns\n", seconds / (double(tasks) * frames) * 1e9);
+	}
+
+	return Test::Result("TaskScheduler");
+}
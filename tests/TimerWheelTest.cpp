@@ -0,0 +1,153 @@
+#include "TimerWheel.h"
+#include "Check.h"
+#include <random>
+#include <vector>
+using namespace WXE;
+
+int main(int argc, char** argv)
+{
+	// a power of two tick keeps frame times exact in the checks
+	const double tick = 1.0 / 1024;
+
+	// a timer fires on the tick it expires, once
+	{
+		TimerWheel wheel(tick);
+		uint32 fired {};
+		bool flag {};
+
+		wheel.Schedule(5 * tick, [&] { fired++; });
+		wheel.Schedule(3 * tick, &flag);
+		CHECK(wheel.Count() == 2);
+
+		wheel.Advance(2 * tick);
+		CHECK(!flag && fired == 0);
+
+		wheel.Advance(tick);
+		CHECK(flag && fired == 0);
+
+		wheel.Advance(tick);
+		CHECK(fired == 0);
+
+		wheel.Advance(tick);
+		CHECK(fired == 1);
+
+		wheel.Advance(1.0);
+		CHECK(fired == 1);
+		CHECK(wheel.Count() == 0);
+	}
+
+	// a cancelled timer never fires, and an id goes stale once its timer is gone
+	{
+		TimerWheel wheel(tick);
+		uint32 fired {};
+
+		TimerId a = wheel.Schedule(10 * tick, [&] { fired++; });
+		TimerId b = wheel.Schedule(10 * tick, [&] { fired++; });
+
+		CHECK(wheel.Active(a));
+		CHECK(wheel.Cancel(a));
+		CHECK(!wheel.Cancel(a));
+		CHECK(!wheel.Active(a));
+
+		wheel.Advance(10 * tick);
+		CHECK(fired == 1);
+		CHECK(!wheel.Active(b));
+		CHECK(!wheel.Cancel(b));
+
+		// the slot of a is reused, its old id still says no
+		TimerId c = wheel.Schedule(tick, [] {});
+		CHECK(static_cast<uint32>(c) == static_cast<uint32>(a) || static_cast<uint32>(c) == static_cast<uint32>(b));
+		CHECK(!wheel.Active(a) && !wheel.Active(b) && wheel.Active(c));
+	}
+
+	// callbacks may cancel and schedule timers, one due on the same tick too
+	{
+		TimerWheel wheel(tick);
+		uint32 fired {};
+		TimerId later {};
+
+		wheel.Schedule(tick, [&] {
+			fired++;
+			wheel.Cancel(later);
+			wheel.Schedule(tick, [&] { fired += 10; });
+			wheel.Schedule(0.0, [&] { fired += 1000; });
+		});
+		later = wheel.Schedule(2 * tick, [&] { fired += 100; });
+
+		wheel.Advance(tick);
+		CHECK(fired == 1);
+
+		wheel.Advance(tick);
+		CHECK(fired == 1011);
+		CHECK(wheel.Count() == 0);
+	}
+
+	// timers on every level, up to 100 s, fire on the frame their
+	// tick falls in, whatever the frame times
+	{
+		TimerWheel wheel(tick);
+		std::mt19937 random(1);
+		const uint32 count = 5000;
+
+		std::vector<uint64> expires(count);
+		std::vector<uint64> firedAt(count);
+		uint64 now {};
+
+		for (uint32 i = 0; i < count; ++i)
+		{
+			expires[i] = 1 + random() % (100 * 1024);
+			wheel.Schedule(expires[i] * tick, [&, i] { firedAt[i] = now; });
+		}
+
+		while (wheel.Count() > 0)
+		{
+			uint64 frame = 1 + random() % 40;
+			now += frame;
+			wheel.Advance(frame * tick);
+		}
+
+		uint32 wrong {};
+		for (uint32 i = 0; i < count; ++i)
+		{
+			// fired in the frame that reached its tick, not before, not later
+			if (firedAt[i] < expires[i] || firedAt[i] >= expires[i] + 40)
+				wrong++;
+		}
+
+		CHECK(wrong == 0);
+	}
+
+	if (Test::Bench(argc, argv))
+	{
+		const uint32 count = 1000000;
+		TimerWheel wheel;
+		std::mt19937 random(2);
+		std::vector<TimerId> ids(count);
+		uint32 fired {};
+
+		double schedule = Test::Seconds([&] {
+			for (uint32 i = 0; i < count; ++i)
+				ids[i] = wheel.Schedule(0.001 * (1 + random() % 60000), [&fired] { fired++; });
+		});
+
+		double cancel = Test::Seconds([&] {
+			for (uint32 i = 0; i < count; i += 2)
+				wheel.Cancel(ids[i]);
+		});
+
+		// 60 s of 16 ms frames with half a million timers running out
+		uint32 frames {};
+		double advance = Test::Seconds([&] {
+			while (wheel.Count() > 0)
+			{
+				wheel.Advance(0.016);
+				frames++;
+			}
+		});
+
+		printf("schedule %.1f ns, cancel %.1f ns, per frame %.1f us firing %u timers over %u frames\n",
+			schedule / count * 1e9, cancel / (count / 2) * 1e9, advance / frames * 1e6, fired, frames);
+	}
+
+	return Test::Result("TimerWheel");
+}
@@ -0,0 +1,101 @@
+#include "VulkanGraphics.h"
+#include "Error.h"
+#include "Check.h"
+using namespace WXE;
+
+// B8G8R8A8 read back as one word: alpha, red, green, blue from the top byte
+static uint32 Pixel(const uint32* pixels, const uint32 pitch, const uint32 x, const uint32 y)
+{
+	return pixels[y * pitch + x];
+}
+
+static void Frame(Vulkan::Graphics& graphics, Vulkan::Buffer* vertices)
+{
+	graphics.Clear();
+	graphics.Draw(vertices, sizeof(Rasterizer::Vertex), 3);
+	graphics.Present();
+}
+
+int main(int argc, char** argv)
+{
+	// without DISPLAY the window is never created and the
+	// backend renders offscreen, as on CI with lavapipe
+	Linux::Window window;
+	window.Size(64, 64);
+	window.Color(0, 122, 204);
+
+	const uint32 background = 0xFF007ACC;
+
+	// the sample's triangle, clockwise as D3D expects
+	Rasterizer::Vertex vertices[] =
+	{
+		{ 0.0f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f },
+		{ 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f },
+		{ -0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f }
+	};
+
+	try
+	{
+		Vulkan::Graphics graphics;
+		graphics.Initialize(&window);
+
+		// the vertices reach the device local buffer through the staging ring
+		Vulkan::Buffer* gpu { nullptr };
+		graphics.Allocate(GPU, sizeof(vertices), &gpu);
+		graphics.Upload(vertices, sizeof(vertices), gpu);
+
+		// more frames than are in flight, so both frames are reused
+		for (uint32 i = 0; i < 4; ++i)
+			Frame(graphics, gpu);
+
+		const uint32* pixels = graphics.Pixels();
+		const uint32 pitch = graphics.Pitch();
+		CHECK(pixels != nullptr);
+
+		if (pixels)
+		{
+			// red inside, cleared outside; +Y is up as in D3D
+			CHECK(Pixel(pixels, pitch, 32, 32) == 0xFFFF0000);
+			CHECK(Pixel(pixels, pitch, 32, 20) == 0xFFFF0000);
+			CHECK(Pixel(pixels, pitch, 32, 50) == background);
+			CHECK(Pixel(pixels, pitch, 2, 2) == background);
+			CHECK(Pixel(pixels, pitch, 61, 61) == background);
+		}
+
+		// at half scale the triangle fills the top left quarter
+		graphics.Scale(0.5f);
+		Frame(graphics, gpu);
+
+		pixels = graphics.Pixels();
+		CHECK(graphics.RenderWidth() == 32 && graphics.RenderHeight() == 32);
+
+		if (pixels)
+		{
+			CHECK(Pixel(pixels, pitch, 16, 16) == 0xFFFF0000);
+			CHECK(Pixel(pixels, pitch, 1, 1) == background);
+		}
+
+		if (Test::Bench(argc, argv))
+		{
+			graphics.Scale(1.0f);
+			const uint32 count = 200;
+
+			double seconds = Test::Seconds([&] {
+				for (uint32 i = 0; i < count; ++i)
+					Frame(graphics, gpu);
+				graphics.Pixels();
+			});
+
+			printf("64x64 frame: %.3f ms\n", seconds / count * 1000.0);
+		}
+
+		gpu->Release();
+	}
+	catch (Error& e)
+	{
+		printf("%s\n", e.ToString().data());
+		Test::failures++;
+	}
+
+	return Test::Result("Vulkan");
+}